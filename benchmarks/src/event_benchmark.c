@@ -0,0 +1,148 @@
+// Compares the cost of event_fire in the compact dispatch table against the
+// previous layout, which kept a heap-allocated darray of listeners per code.
+
+#include <containers/darray.h>
+#include <core/event.h>
+#include <core/smemory.h>
+#include <defines.h>
+
+#include <platform/platform.h>
+
+#include <stdio.h>
+
+#define ITERATIONS 10000000
+#define COLD_ITERATIONS 1000
+#define COLD_EVICT_SIZE MEBIBYTES(16)
+#define LISTENERS_PER_CODE 3
+#define LEGACY_MESSAGE_CODES 16386
+
+typedef struct legacy_registered_event {
+	void *listener;
+	PFN_on_event callback;
+} legacy_registered_event;
+
+typedef struct legacy_event_code_entry {
+	legacy_registered_event *events;
+} legacy_event_code_entry;
+
+typedef struct legacy_event_system_state {
+	legacy_event_code_entry registered[LEGACY_MESSAGE_CODES];
+} legacy_event_system_state;
+
+static legacy_event_system_state legacy_state;
+
+static void legacy_register(u16 code, void *listener, PFN_on_event on_event) {
+	if (legacy_state.registered[code].events == 0) {
+		legacy_state.registered[code].events = darray_create(legacy_registered_event);
+	}
+
+	legacy_registered_event event = {.listener = listener, .callback = on_event};
+	darray_push(legacy_state.registered[code].events, event);
+}
+
+static SNOINLINE b8 legacy_fire(u16 code, void *sender, event_context context) {
+	if (legacy_state.registered[code].events == 0) { return false; }
+
+	u64 registered_count = darray_length(legacy_state.registered[code].events);
+	for (u64 i = 0; i < registered_count; ++i) {
+		legacy_registered_event e = legacy_state.registered[code].events[i];
+		if (e.callback(code, sender, e.listener, context)) { return true; }
+	}
+
+	return false;
+}
+
+static void legacy_shutdown() {
+	for (u16 i = 0; i < LEGACY_MESSAGE_CODES; ++i) {
+		if (legacy_state.registered[i].events != 0) {
+			darray_destroy(legacy_state.registered[i].events);
+			legacy_state.registered[i].events = 0;
+		}
+	}
+}
+
+static volatile u64 calls;
+
+static b8 on_event(u16 code, void *sender, void *listener_instance, event_context context) {
+	(void)code;
+	(void)sender;
+	(void)listener_instance;
+	(void)context;
+
+	calls++;
+	return false;
+}
+
+// Cheap xorshift so both layouts see the same, cache-unfriendly code sequence.
+static u32 next_code(u32 *seed) {
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 17;
+	*seed ^= *seed << 5;
+	return 1 + (*seed % (MAX_EVENT_CODE - 1));
+}
+
+// Touches enough memory to push the event tables out of the caches, like a frame of rendering would.
+static void evict_caches(u8 *buffer) {
+	for (u64 i = 0; i < COLD_EVICT_SIZE; i += 64) { buffer[i]++; }
+}
+
+int main(void) {
+	u64 memory_requirement = 0;
+	event_system_initialize(&memory_requirement, 0);
+	void *event_state = sallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+	event_system_initialize(&memory_requirement, event_state);
+
+	// Interleave registrations the way subsystems do at startup.
+	for (u64 l = 0; l < LISTENERS_PER_CODE; ++l) {
+		for (u16 code = 1; code < MAX_EVENT_CODE; ++code) {
+			event_register(code, (void *)(l + 1), on_event);
+			legacy_register(code, (void *)(l + 1), on_event);
+		}
+	}
+
+	event_context context = {};
+
+	u32 seed        = 0x9E3779B9;
+	f64 legacy_time = platform_get_absolute_time();
+	for (u32 i = 0; i < ITERATIONS; ++i) { legacy_fire((u16)next_code(&seed), 0, context); }
+	legacy_time = platform_get_absolute_time() - legacy_time;
+
+	seed             = 0x9E3779B9;
+	f64 compact_time = platform_get_absolute_time();
+	for (u32 i = 0; i < ITERATIONS; ++i) { event_fire((u16)next_code(&seed), 0, context); }
+	compact_time = platform_get_absolute_time() - compact_time;
+
+	// Cold: a single fire after the caches were trashed.
+	u8 *evict_buffer      = sallocate(COLD_EVICT_SIZE, MEMORY_TAG_APPLICATION);
+	f64 legacy_cold_time  = 0;
+	f64 compact_cold_time = 0;
+	seed                  = 0x9E3779B9;
+	for (u32 i = 0; i < COLD_ITERATIONS; ++i) {
+		u16 code = (u16)next_code(&seed);
+
+		evict_caches(evict_buffer);
+		f64 start = platform_get_absolute_time();
+		legacy_fire(code, 0, context);
+		legacy_cold_time += platform_get_absolute_time() - start;
+
+		evict_caches(evict_buffer);
+		start = platform_get_absolute_time();
+		event_fire(code, 0, context);
+		compact_cold_time += platform_get_absolute_time() - start;
+	}
+	sfree(evict_buffer, COLD_EVICT_SIZE, MEMORY_TAG_APPLICATION);
+
+	printf("event_fire, %d listeners per code, %llu callbacks\n", LISTENERS_PER_CODE, (u64)calls);
+	printf("  hot  (%d fires):\n", ITERATIONS);
+	printf("    darray per code : %.2f ns/fire\n", legacy_time * 1e9 / ITERATIONS);
+	printf("    compact table   : %.2f ns/fire\n", compact_time * 1e9 / ITERATIONS);
+	printf("  cold (%d fires):\n", COLD_ITERATIONS);
+	printf("    darray per code : %.2f ns/fire\n", legacy_cold_time * 1e9 / COLD_ITERATIONS);
+	printf("    compact table   : %.2f ns/fire\n", compact_cold_time * 1e9 / COLD_ITERATIONS);
+
+	legacy_shutdown();
+	event_system_shutdown(event_state);
+	sfree(event_state, memory_requirement, MEMORY_TAG_APPLICATION);
+
+	return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * Fixed capacity table of values keyed by name, copied in and out. Open addressing over the string_hash of the
+ * names, which are not stored themselves: two names with the same 64-bit hash share an entry.
+ * The memory is provided by the caller, see hashtable_memory_requirement.
+ */
+typedef struct hashtable {
+	u64 element_size;
+	u32 capacity;
+	u32 count;
+	u32 max_count;
+	// Name hashes, 0 for empty slots.
+	u64 *keys;
+	void *values;
+} hashtable;
+
+// Bytes of memory hashtable_create needs to hold up to element_count values of element_size.
+SAPI u64 hashtable_memory_requirement(u64 element_size, u32 element_count);
+SAPI void hashtable_create(u64 element_size, u32 element_count, void *memory, hashtable *out_table);
+SAPI void hashtable_destroy(hashtable *table);
+
+// Adds or replaces the value for name. @returns False if the table is full.
+SAPI b8 hashtable_set(hashtable *table, const char *name, const void *value);
+// @returns False if there is no value for name, out_value is then untouched.
+SAPI b8 hashtable_get(const hashtable *table, const char *name, void *out_value);
+// @returns False if there was no value for name.
+SAPI b8 hashtable_remove(hashtable *table, const char *name);
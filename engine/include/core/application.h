@@ -12,6 +12,13 @@ typedef struct application_config {
 	i16 start_height;
 
 	char *name;
+
+	// Optional, records all input and frame times to this file.
+	// Overridden by the SPACE_INPUT_RECORD environment variable.
+	const char *input_record_path;
+	// Optional, replays input and frame times from this file instead of using the keyboard and mouse.
+	// The application quits when the recording ends. Overridden by SPACE_INPUT_REPLAY.
+	const char *input_replay_path;
 } application_config;
 
 SAPI b8 application_create(struct game *game_instance);
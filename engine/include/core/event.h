@@ -29,12 +29,33 @@ typedef b8 (*PFN_on_event)(u16 code, void *sender, void *listener_instance, even
 void event_system_initialize(u64 *memory_requirement, void *state);
 void event_system_shutdown(void *state);
 
+// NOTE: Listeners are only ever invoked on the main thread. When called from any
+// other thread, register, unregister and post are deferred until the next
+// event_dispatch_queued and return whether the request could be queued.
+
 SAPI b8 event_register(u16 code, void *listener, PFN_on_event on_event);
 
 SAPI b8 event_unregister(u16 code, void *listener, PFN_on_event on_event);
 
+// Calls the listeners immediately. From other threads this behaves like event_post and returns false.
 SAPI b8 event_fire(u16 code, void *sender, event_context context);
 
+// Queues the event to be dispatched by event_dispatch_queued, once per frame.
+// Returns false if the event system is not initialized or the event could not be queued.
+SAPI b8 event_post(u16 code, void *sender, event_context context);
+
+// When enabled, posting an event of this code replaces any event of the same code
+// still waiting in the queue, so only the latest value is dispatched each frame.
+// Mouse move and resize events coalesce by default.
+SAPI void event_set_coalescing(u16 code, b8 coalesce);
+
+// Dispatches all posted events, in the order they were posted.
+void event_dispatch_queued();
+
+// Gives up the command ring the calling thread was using, for another thread to reuse. Threads started with
+// platform_thread_create call this when they exit. Call it from any other thread before it exits.
+void event_thread_release();
+
 typedef enum system_event_code {
 	EVENT_CODE_APPLICATION_QUIT = 0x01,
 
@@ -61,5 +82,10 @@ typedef enum system_event_code {
 	// u16 height = data.data.u16[1];
 	EVENT_CODE_RESIZED = 0x08,
 
+	// An asset file was rewritten, see file_watcher.h.
+	// u64 name_hash = data.data.u64[0];
+	EVENT_CODE_ASSET_CHANGED = 0x09,
+
+	// Highest code the event system accepts, including application-defined ones.
 	MAX_EVENT_CODE = 0xFF
 } system_event_code;
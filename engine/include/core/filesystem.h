@@ -2,11 +2,39 @@
 
 #include "defines.h"
 
+#include "core/sstring.h"
+
 typedef struct file_handle {
 	void *handle;
 	b8 is_valid;
 } file_handle;
 
+// A read-only view of a whole file, mapped into memory.
+typedef struct file_view {
+	const void *data;
+	u64 size;
+} file_view;
+
+/**
+ * Reads a file line by line through one reusable buffer, refilled a block at a time. Lines are views into that
+ * buffer without the line ending, valid until the next call. The buffer only grows for lines longer than itself.
+ */
+typedef struct file_line_reader {
+	file_handle *handle;
+	char *buffer;
+	u64 capacity;
+	// Unread data is buffer[start, end).
+	u64 start;
+	u64 end;
+	u64 line_number;
+	b8 eof;
+} file_line_reader;
+
+#define FILE_LINE_READER_DEFAULT_SIZE KIBIBYTES(64)
+
+// Return false to stop reading.
+typedef b8 (*PFN_on_line)(string_view line, u64 line_number, void *user_data);
+
 typedef enum file_modes {
 	FILE_MODE_READ  = 0x1,
 	FILE_MODE_WRITE = 0x2,
@@ -20,8 +48,50 @@ SAPI void filesystem_close(file_handle *handle);
 SAPI b8 filesystem_read_line(file_handle *handle, char **line_buf);
 SAPI b8 filesystem_write_line(file_handle *handle, const char *text);
 
+SAPI b8 filesystem_line_reader_create(file_handle *handle, u64 buffer_size, file_line_reader *out_reader);
+SAPI void filesystem_line_reader_destroy(file_line_reader *reader);
+// @returns False once the file is exhausted.
+SAPI b8 filesystem_line_reader_next(file_line_reader *reader, string_view *out_line);
+
+/**
+ * Calls callback for every line of the file at path. The file is mapped, so lines point straight into it.
+ * @returns False if the file couldn't be opened or the callback stopped early.
+ */
+SAPI b8 filesystem_for_each_line(const char *path, PFN_on_line callback, void *user_data);
+
 SAPI b8 filesystem_read(file_handle *handle, u64 data_size, void *out_data, u64 *out_bytes_read);
 
 SAPI b8 filesystem_read_all_bytes(file_handle *handle, u8 **out_bytes, u64 *out_bytes_read);
 
 SAPI b8 filesystem_write(file_handle *handle, u64 data_size, const void *data, u64 *out_bytes_written);
+
+/**
+ * Maps a file read-only, hinting the OS that it will be read sequentially and soon.
+ * The data stays valid until filesystem_unmap. Empty files succeed with a null data pointer.
+ */
+SAPI b8 filesystem_map(const char *path, file_view *out_view);
+SAPI void filesystem_unmap(file_view *view);
+
+/**
+ * Called on the main thread, from filesystem_async_update, once an async read finishes.
+ * @param success False if the file couldn't be opened, or ended before size bytes were read.
+ */
+typedef void (*PFN_on_file_read)(b8 success, void *dest, u64 bytes_read, void *user_data);
+
+b8 filesystem_async_initialize(u64 *memory_requirement, void *state);
+void filesystem_async_shutdown(void *state);
+// Delivers finished reads. Called once per frame by the application.
+void filesystem_async_update();
+
+/**
+ * Reads size bytes at offset of the file at path into dest without blocking. dest must stay valid until the
+ * callback. Uses io_uring on Linux where available, a small pool of worker threads otherwise.
+ * NOTE: Main thread only.
+ * @returns False if the read could not be queued, in which case the callback is never called.
+ */
+SAPI b8 filesystem_read_async(const char *path,
+							  u64 offset,
+							  u64 size,
+							  void *dest,
+							  PFN_on_file_read callback,
+							  void *user_data);
@@ -161,6 +161,34 @@ typedef enum keys {
 	KEYS_MAX_KEYS = 0xFF
 } keys;
 
+typedef enum input_event_type {
+	INPUT_EVENT_TYPE_KEY,
+	INPUT_EVENT_TYPE_BUTTON,
+	INPUT_EVENT_TYPE_MOUSE_MOVE,
+	INPUT_EVENT_TYPE_MOUSE_WHEEL,
+} input_event_type;
+
+// A single raw input event, as reported by the platform layer.
+typedef struct input_event {
+	// Platform timestamp in milliseconds (X server time on Linux, message time on Windows).
+	// Wraps around, only differences between events are meaningful.
+	u32 timestamp;
+	u8 type;
+	// Pressed state for keys and buttons.
+	b8 pressed;
+	// Key or button, depending on type.
+	u16 code;
+	// Position for mouse moves, x holds the delta for mouse wheels.
+	i16 x;
+	i16 y;
+} input_event;
+
+// Number of input events kept around, must be a power of two.
+#define INPUT_EVENT_RING_SIZE 1024
+
+#define MAX_INPUT_ACTIONS 64
+#define MAX_INPUT_ACTION_BINDINGS 4
+
 void input_system_initialize(u64 *memory_requirement, void *state);
 void input_system_shutdown(void *state);
 void input_update(f64 delta_time);
@@ -171,7 +199,7 @@ SAPI b8 input_is_key_up(keys key);
 SAPI b8 input_was_key_down(keys key);
 SAPI b8 input_was_key_up(keys key);
 
-void input_process_key(keys key, b8 pressed);
+void input_process_key(keys key, b8 pressed, u32 timestamp);
 
 // mouse input
 SAPI b8 input_is_button_down(buttons button);
@@ -180,7 +208,48 @@ SAPI b8 input_was_button_down(buttons button);
 SAPI b8 input_was_button_up(buttons button);
 SAPI void input_get_mouse_position(i32 *x, i32 *y);
 SAPI void input_get_previous_mouse_position(i32 *x, i32 *y);
-
-void input_process_button(buttons button, b8 pressed);
-void input_process_mouse_move(i16 x, i16 y);
-void input_process_mouse_wheel(i8 z_delta);
+// Relative mouse movement accumulated over this frame. Unaccelerated device units
+// where the platform supports raw input, otherwise derived from absolute positions.
+SAPI void input_get_mouse_delta(f32 *x, f32 *y);
+
+void input_process_button(buttons button, b8 pressed, u32 timestamp);
+void input_process_mouse_move(i16 x, i16 y, u32 timestamp);
+void input_process_mouse_wheel(i8 z_delta, u32 timestamp);
+// Raw relative motion, called once per raw device event.
+void input_process_mouse_raw_motion(f32 delta_x, f32 delta_y);
+// Once a platform reports raw motion, deltas are no longer derived from mouse moves.
+void input_set_raw_motion_available(b8 available);
+
+// input event ring
+// Gets the range of event indices received since the last input_update, end is exclusive.
+SAPI void input_get_frame_event_range(u64 *out_first, u64 *out_end);
+// Returns false if the event at index was never recorded or has already been overwritten.
+SAPI b8 input_get_event(u64 index, input_event *out_event);
+
+// recording and replay
+// Records all input and frame delta times from now on to a binary file at path.
+SAPI b8 input_record_start(const char *path);
+SAPI void input_record_stop();
+
+// Replays a recording made with input_record_start. Platform input is ignored while replaying.
+SAPI b8 input_replay_start(const char *path);
+SAPI void input_replay_stop();
+SAPI b8 input_is_replaying();
+// Feeds the next recorded frame's input and returns its delta time.
+// Returns false and stops the replay once the recording is exhausted.
+b8 input_replay_frame(f64 *out_delta_time);
+
+// actions
+// Binds a key or button to an action, an action can have up to MAX_INPUT_ACTION_BINDINGS bindings.
+SAPI b8 input_action_bind_key(u16 action, keys key);
+SAPI b8 input_action_bind_button(u16 action, buttons button);
+SAPI void input_action_clear(u16 action);
+
+// True if any bound key or button is currently down.
+SAPI b8 input_action_is_down(u16 action);
+// True if a bound key or button went down during this frame, even if it was released again.
+SAPI b8 input_action_was_pressed(u16 action);
+// True if a bound key or button was released during this frame.
+SAPI b8 input_action_was_released(u16 action);
+// Number of presses of any bound key or button during this frame.
+SAPI u32 input_action_press_count(u16 action);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "defines.h"
+
+// Largest params a job can carry, they are copied into the job when it is submitted.
+#define JOB_MAX_PARAMS_SIZE 128
+
+/**
+ * Runs on a worker thread. Must not touch main thread state, allocate through sallocate or log.
+ * @returns False if the job failed, which is passed on to its completion callback.
+ */
+typedef b8 (*PFN_job_start)(void *params);
+
+// Called on the main thread, from job_system_update, with the job's copy of its params.
+typedef void (*PFN_job_complete)(b8 success, void *params);
+
+b8 job_system_initialize(u64 *memory_requirement, void *state);
+// Waits for every submitted job and runs its completion first.
+void job_system_shutdown(void *state);
+// Runs the completions of finished jobs. Called once per frame by the application.
+void job_system_update();
+
+/**
+ * Queues entry_point to run on a worker thread with a copy of params_size bytes of params.
+ * NOTE: Main thread only.
+ * @param on_complete Optional.
+ * @returns False if the job could not be queued, in which case neither callback is called.
+ */
+SAPI b8 job_submit(PFN_job_start entry_point, PFN_job_complete on_complete, const void *params, u32 params_size);
@@ -9,7 +9,13 @@
 
 #if SPACE_RELEASE == 1
 	#define LOG_DEBUG_ENABLED 0
-	#define LOG_TRACE_ENABLED 0
+	// Trace messages stay on in release builds, but are deferred to the binary log.
+	#define LOG_TRACE_BINARY 1
+#endif
+
+#ifndef LOG_TRACE_BINARY
+	// When 1, STRACE writes to the binary log (console.slog) instead of formatting the message.
+	#define LOG_TRACE_BINARY 0
 #endif
 
 typedef enum log_level {
@@ -24,19 +30,87 @@ typedef enum log_level {
 b8 logging_system_initialize(u64 *memory_requirement, void *state);
 void logging_shutdown();
 
+// Blocks until every message logged so far has been written out by the writer thread.
+SAPI void logging_flush();
+
 SAPI void log_output(log_level level, const char *message, ...);
 
+/**
+ * Logs a message to the binary log without formatting it. Only the format string's address, a timestamp and the
+ * argument bytes are stored, the log_decoder tool turns console.slog back into text.
+ * NOTE: The format string must be a string literal, or otherwise outlive the logging system.
+ */
+SAPI void log_output_binary(log_level level, const char *format, ...);
+
+/**
+ * Formats arguments stored by log_output_binary into out.
+ * @returns The length of the formatted message, excluding the terminator.
+ */
+SAPI u32 log_format_binary(const char *format, const void *args, u32 args_size, char *out, u32 out_size);
+
+// Binary log (console.slog) layout. A header, followed by records starting with a log_binary_record_type.
+#define LOG_BINARY_MAGIC 0x474F4C53 // "SLOG"
+#define LOG_BINARY_VERSION 1
+
+typedef struct log_binary_header {
+	u32 magic;
+	u32 version;
+} log_binary_header;
+
+typedef enum log_binary_record_type {
+	// u64 format id, u16 length, then the format string without terminator. Written before its first message.
+	LOG_BINARY_RECORD_FORMAT = 1,
+	// u8 level, u64 format id, f64 timestamp, u16 argument size, then the arguments.
+	LOG_BINARY_RECORD_MESSAGE = 2,
+} log_binary_record_type;
+
+typedef enum log_category {
+	LOG_CATEGORY_GENERAL  = 0,
+	LOG_CATEGORY_RENDERER = 1,
+	LOG_CATEGORY_VULKAN   = 2, // Validation layer and driver messages.
+	LOG_CATEGORY_PLATFORM = 3,
+	LOG_CATEGORY_INPUT    = 4,
+	LOG_CATEGORY_GAME     = 5,
+	LOG_CATEGORY_MAX      = 6,
+} log_category;
+
+// Category used by the logging macros. Define it before any includes to put a whole file in a category.
+#ifndef LOG_CATEGORY
+	#define LOG_CATEGORY LOG_CATEGORY_GENERAL
+#endif
+
+// Most verbose level logged per category. Read directly by the logging macros, change it with log_set_category_level.
+SAPI extern u8 log_category_levels[LOG_CATEGORY_MAX];
+
+SAPI void log_set_category_level(log_category category, log_level level);
+SAPI log_level log_get_category_level(log_category category);
+
+/**
+ * Sets category levels from a comma separated list of category=level pairs, such as "vulkan=trace,input=debug".
+ * A bare level applies to every category.
+ * @returns false if any entry could not be parsed. The valid entries are still applied.
+ */
+SAPI b8 log_set_category_levels(const char *levels);
+
+// Nothing is formatted, nor are the arguments evaluated, unless the category is at least as verbose as level.
+#define SLOG_ENABLED(category, level) ((u8)(level) <= log_category_levels[category])
+
+#define SLOG(category, level, message, ...)                                                                            \
+	do {                                                                                                               \
+		if (SLOG_ENABLED(category, level)) { log_output(level, message, ##__VA_ARGS__); }                              \
+	} while (0)
+
 // Logs a fatal-level message.
 #define SFATAL(message, ...) log_output(LOG_LEVEL_FATAL, message, ##__VA_ARGS__)
 
 #ifndef SERROR
 	// Logs a error-level message.
-	#define SERROR(message, ...) log_output(LOG_LEVEL_ERROR, message, ##__VA_ARGS__)
+	#define SERROR(message, ...) SLOG(LOG_CATEGORY, LOG_LEVEL_ERROR, message, ##__VA_ARGS__)
 #endif
 
 #if LOG_WARN_ENABLED == 1
 	// Logs a warning-level message.
-	#define SWARN(message, ...) log_output(LOG_LEVEL_WARN, message, ##__VA_ARGS__)
+	#define SWARN(message, ...) SLOG(LOG_CATEGORY, LOG_LEVEL_WARN, message, ##__VA_ARGS__)
 #else
 	// Does nothing when LOG_WARN_ENABLED != 1
 	#define SWARN(message, ...)
@@ -44,7 +118,7 @@ SAPI void log_output(log_level level, const char *message, ...);
 
 #if LOG_INFO_ENABLED == 1
 	// Logs a info-level message.
-	#define SINFO(message, ...) log_output(LOG_LEVEL_INFO, message, ##__VA_ARGS__)
+	#define SINFO(message, ...) SLOG(LOG_CATEGORY, LOG_LEVEL_INFO, message, ##__VA_ARGS__)
 #else
 	// Does nothing when LOG_INFO_ENABLED != 1
 	#define SINFO(message, ...)
@@ -52,15 +126,23 @@ SAPI void log_output(log_level level, const char *message, ...);
 
 #if LOG_DEBUG_ENABLED == 1
 	// Logs a debug-level message.
-	#define SDEBUG(message, ...) log_output(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__)
+	#define SDEBUG(message, ...) SLOG(LOG_CATEGORY, LOG_LEVEL_DEBUG, message, ##__VA_ARGS__)
 #else
 	// Does nothing when LOG_DEBUG_ENABLED != 1
 	#define SDEBUG(message, ...)
 #endif
 
-#if LOG_TRACE_ENABLED == 1
+#if LOG_TRACE_ENABLED == 1 && LOG_TRACE_BINARY == 1
+	// Logs a trace-level message to the binary log.
+	#define STRACE(message, ...)                                                                                       \
+		do {                                                                                                           \
+			if (SLOG_ENABLED(LOG_CATEGORY, LOG_LEVEL_TRACE)) {                                                         \
+				log_output_binary(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);                                            \
+			}                                                                                                          \
+		} while (0)
+#elif LOG_TRACE_ENABLED == 1
 	// Logs a trace-level message.
-	#define STRACE(message, ...) log_output(LOG_LEVEL_TRACE, message, ##__VA_ARGS__)
+	#define STRACE(message, ...) SLOG(LOG_CATEGORY, LOG_LEVEL_TRACE, message, ##__VA_ARGS__)
 #else
 	// Does nothing when LOG_TRACE_ENABLED != 1
 	#define STRACE(message, ...)
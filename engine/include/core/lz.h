@@ -0,0 +1,37 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * LZ4-compatible block compression, tuned for fast decoding of cooked assets.
+ *
+ * Streams split the data into LZ_BLOCK_SIZE blocks that are compressed independently, so they can be decoded
+ * one at a time as they arrive. Each block is a u32 header holding its stored size, with LZ_BLOCK_UNCOMPRESSED
+ * set if the block is stored as is, followed by the block data.
+ */
+#define LZ_BLOCK_SIZE KIBIBYTES(64)
+#define LZ_BLOCK_UNCOMPRESSED 0x80000000U
+
+// Largest output of lz_compress_block for size bytes of input.
+#define LZ_BLOCK_BOUND(size) ((size) + (size) / 255 + 16)
+
+// Largest output of lz_compress for size bytes of input.
+SAPI u64 lz_compress_bound(u64 size);
+
+/**
+ * Compresses size bytes of src into a stream in dst.
+ * @returns The stream size, or 0 if it didn't fit into dst_capacity.
+ */
+SAPI u64 lz_compress(const void *src, u64 size, void *dst, u64 dst_capacity);
+
+/**
+ * Decompresses a whole stream. dst_size must be the exact uncompressed size.
+ * @returns False if the stream is corrupt or doesn't decode to dst_size bytes.
+ */
+SAPI b8 lz_decompress(const void *src, u64 src_size, void *dst, u64 dst_size);
+
+// A single block, without the stream's block header. @returns The compressed size, 0 if it didn't fit.
+SAPI u64 lz_compress_block(const void *src, u64 size, void *dst, u64 dst_capacity);
+
+// Every read and write is bounds-checked, corrupt input fails instead of overrunning either buffer.
+SAPI b8 lz_decompress_block(const void *src, u64 src_size, void *dst, u64 dst_size);
@@ -2,11 +2,107 @@
 
 #include "defines.h"
 
+struct linear_allocator;
+
+// A non-owning, not necessarily terminated, view into a string.
+typedef struct string_view {
+	const char *data;
+	u64 length;
+} string_view;
+
+// Use with SV_ARG to print a string_view: printf("name: " SV_FMT, SV_ARG(view));
+#define SV_FMT "%.*s"
+#define SV_ARG(view) (i32)(view).length, (view).data
+
+/**
+ * Builds a string inside a linear allocator. While the builder's string is the allocator's most recent
+ * allocation, appends extend it in place and formatted appends are written straight into the free space,
+ * so nothing is copied twice. The string is always terminated and lives until the allocator is freed.
+ */
+typedef struct string_builder {
+	struct linear_allocator *allocator;
+	char *data;
+	u64 length;
+	// Set if an append didn't fit into the allocator. The string holds everything appended before that.
+	b8 overflowed;
+} string_builder;
+
 SAPI u64 string_length(const char *str);
 
 SAPI char *string_duplicate(const char *str);
 
 SAPI b8 string_equal(const char *str0, const char *str1);
 
+SAPI b8 string_starts_with(const char *str, const char *prefix);
+
+/**
+ * Fast non-cryptographic 64-bit hash. Consumes 8 bytes per step, little-endian.
+ * STRING_HASH_LITERAL gives the same value for string literals and folds to a constant when optimizing.
+ */
+SAPI u64 string_hash_n(const void *data, u64 length);
+SAPI u64 string_hash(const char *str);
+
+// NOTE: dest must be large enough for the result, prefer string_format_n.
 i32 string_format(char *dest, const char *format, ...);
 i32 string_format_v(char *dest, const char *format, void *va_listp);
+
+/**
+ * Formats into dest, writing at most dest_size bytes including the terminator.
+ * @returns The length of the full result, which is >= dest_size if it was truncated. -1 on error.
+ */
+SAPI i32 string_format_n(char *dest, u64 dest_size, const char *format, ...);
+SAPI i32 string_format_n_v(char *dest, u64 dest_size, const char *format, void *va_listp);
+
+SAPI string_view string_view_create(const char *str);
+SAPI string_view string_view_substring(string_view view, u64 start, u64 length);
+SAPI b8 string_view_equal(string_view view0, string_view view1);
+// Parses a number taking up the whole view. @returns False if the view holds anything else.
+SAPI b8 string_view_to_f64(string_view view, f64 *out_value);
+
+SAPI void string_builder_begin(struct linear_allocator *allocator, string_builder *out_builder);
+SAPI b8 string_builder_append(string_builder *builder, string_view text);
+SAPI b8 string_builder_append_cstr(string_builder *builder, const char *text);
+SAPI b8 string_builder_append_format(string_builder *builder, const char *format, ...);
+SAPI string_view string_builder_view(const string_builder *builder);
+
+#define STRING_HASH_SEED 0xA0761D6478BD642FULL
+#define STRING_HASH_MULTIPLIER 0xE7037ED1A0B428DBULL
+#define STRING_HASH_FINISH_MULTIPLIER 0x8EBC6AF09C88C6E3ULL
+
+// Longest literal STRING_HASH_LITERAL accepts.
+#define STRING_HASH_LITERAL_MAX 64
+
+// The pieces below are plain constant expressions so the hash can be used in static initializers. Each step
+// only mentions the previous hash once, otherwise the expansion would double in size per word.
+#define STRING_HASH_LITERAL_LENGTH(s) (sizeof(s) - 1)
+// Out of range indices read the terminator, so the last word is zero padded.
+#define STRING_HASH_LITERAL_BYTE(s, i) ((u64)(u8)(s)[(i) < sizeof(s) ? (i) : sizeof(s) - 1] << (((i) % 8) * 8))
+#define STRING_HASH_LITERAL_WORD(s, w)                                                                                 \
+	(STRING_HASH_LITERAL_BYTE(s, (w) * 8 + 0) | STRING_HASH_LITERAL_BYTE(s, (w) * 8 + 1)                               \
+	 | STRING_HASH_LITERAL_BYTE(s, (w) * 8 + 2) | STRING_HASH_LITERAL_BYTE(s, (w) * 8 + 3)                             \
+	 | STRING_HASH_LITERAL_BYTE(s, (w) * 8 + 4) | STRING_HASH_LITERAL_BYTE(s, (w) * 8 + 5)                             \
+	 | STRING_HASH_LITERAL_BYTE(s, (w) * 8 + 6) | STRING_HASH_LITERAL_BYTE(s, (w) * 8 + 7))
+#define STRING_HASH_LITERAL_ACTIVE(s, w) ((w) * 8 < STRING_HASH_LITERAL_LENGTH(s))
+// Words past the end leave the hash unchanged: hash ^ 0 * 1.
+#define STRING_HASH_LITERAL_STEP(hash, s, w)                                                                           \
+	(((hash) ^ (STRING_HASH_LITERAL_ACTIVE(s, w)                                                                       \
+					? STRING_HASH_LITERAL_WORD(s, w) ^ (STRING_HASH_LITERAL_WORD(s, w) >> 32)                          \
+					: 0))                                                                                              \
+	 * (STRING_HASH_LITERAL_ACTIVE(s, w) ? STRING_HASH_MULTIPLIER : 1))
+
+#define STRING_HASH_LITERAL_H0(s) (STRING_HASH_SEED ^ (STRING_HASH_LITERAL_LENGTH(s) * STRING_HASH_MULTIPLIER))
+#define STRING_HASH_LITERAL_H1(s) STRING_HASH_LITERAL_STEP(STRING_HASH_LITERAL_H0(s), s, 0)
+#define STRING_HASH_LITERAL_H2(s) STRING_HASH_LITERAL_STEP(STRING_HASH_LITERAL_H1(s), s, 1)
+#define STRING_HASH_LITERAL_H3(s) STRING_HASH_LITERAL_STEP(STRING_HASH_LITERAL_H2(s), s, 2)
+#define STRING_HASH_LITERAL_H4(s) STRING_HASH_LITERAL_STEP(STRING_HASH_LITERAL_H3(s), s, 3)
+#define STRING_HASH_LITERAL_H5(s) STRING_HASH_LITERAL_STEP(STRING_HASH_LITERAL_H4(s), s, 4)
+#define STRING_HASH_LITERAL_H6(s) STRING_HASH_LITERAL_STEP(STRING_HASH_LITERAL_H5(s), s, 5)
+#define STRING_HASH_LITERAL_H7(s) STRING_HASH_LITERAL_STEP(STRING_HASH_LITERAL_H6(s), s, 6)
+#define STRING_HASH_LITERAL_H8(s) STRING_HASH_LITERAL_STEP(STRING_HASH_LITERAL_H7(s), s, 7)
+#define STRING_HASH_LITERAL_FOLD(hash) (((hash) ^ ((hash) >> 32)) * STRING_HASH_FINISH_MULTIPLIER)
+#define STRING_HASH_LITERAL_AVALANCHE(hash) ((hash) ^ ((hash) >> 29))
+
+// Hash of a string literal, equal to string_hash(s). Fails to compile for literals over STRING_HASH_LITERAL_MAX.
+#define STRING_HASH_LITERAL(s)                                                                                         \
+	(STRING_HASH_LITERAL_AVALANCHE(STRING_HASH_LITERAL_FOLD(STRING_HASH_LITERAL_H8(s)))                                \
+	 + 0 * sizeof(char[STRING_HASH_LITERAL_LENGTH(s) <= STRING_HASH_LITERAL_MAX ? 1 : -1]))
@@ -0,0 +1,86 @@
+#include "containers/hashtable.h"
+
+#include "core/smemory.h"
+#include "core/sstring.h"
+
+// Tables are sized so probes stay short, at most this fraction of the slots is in use.
+#define HASHTABLE_LOAD_NUMERATOR 3
+#define HASHTABLE_LOAD_DENOMINATOR 4
+
+static u32 table_capacity(u32 element_count) {
+	u64 needed   = (u64)element_count * HASHTABLE_LOAD_DENOMINATOR / HASHTABLE_LOAD_NUMERATOR + 1;
+	u32 capacity = 8;
+	while (capacity < needed) { capacity <<= 1; }
+	return capacity;
+}
+
+// 0 marks an empty slot, so names hashing to it take the next key.
+static u64 name_key(const char *name) {
+	u64 key = string_hash(name);
+	return key ? key : 1;
+}
+
+// Slot holding key, or the empty slot it would go into.
+static u32 find_slot(const hashtable *table, u64 key) {
+	u32 mask = table->capacity - 1;
+	u32 slot = (u32)key & mask;
+	while (table->keys[slot] != 0 && table->keys[slot] != key) { slot = (slot + 1) & mask; }
+	return slot;
+}
+
+static void *value_at(const hashtable *table, u32 slot) { return (u8 *)table->values + table->element_size * slot; }
+
+u64 hashtable_memory_requirement(u64 element_size, u32 element_count) {
+	u32 capacity = table_capacity(element_count);
+	return (sizeof(u64) + element_size) * capacity;
+}
+
+void hashtable_create(u64 element_size, u32 element_count, void *memory, hashtable *out_table) {
+	out_table->element_size = element_size;
+	out_table->capacity     = table_capacity(element_count);
+	out_table->count        = 0;
+	out_table->max_count    = element_count;
+	out_table->keys         = memory;
+	out_table->values       = out_table->keys + out_table->capacity;
+	szero_memory(out_table->keys, sizeof(u64) * out_table->capacity);
+}
+
+void hashtable_destroy(hashtable *table) { szero_memory(table, sizeof(hashtable)); }
+
+b8 hashtable_set(hashtable *table, const char *name, const void *value) {
+	u64 key  = name_key(name);
+	u32 slot = find_slot(table, key);
+	if (table->keys[slot] == 0) {
+		if (table->count == table->max_count) { return false; }
+		table->keys[slot] = key;
+		table->count++;
+	}
+	scopy_memory(value_at(table, slot), value, table->element_size);
+	return true;
+}
+
+b8 hashtable_get(const hashtable *table, const char *name, void *out_value) {
+	u32 slot = find_slot(table, name_key(name));
+	if (table->keys[slot] == 0) { return false; }
+	scopy_memory(out_value, value_at(table, slot), table->element_size);
+	return true;
+}
+
+b8 hashtable_remove(hashtable *table, const char *name) {
+	u32 slot = find_slot(table, name_key(name));
+	if (table->keys[slot] == 0) { return false; }
+
+	// Shift later entries of the probe run back into the gap, so lookups never need tombstones.
+	u32 mask = table->capacity - 1;
+	for (u32 next = (slot + 1) & mask; table->keys[next] != 0; next = (next + 1) & mask) {
+		u32 home = (u32)table->keys[next] & mask;
+		if (((next - home) & mask) < ((next - slot) & mask)) { continue; }
+
+		table->keys[slot] = table->keys[next];
+		scopy_memory(value_at(table, slot), value_at(table, next), table->element_size);
+		slot = next;
+	}
+	table->keys[slot] = 0;
+	table->count--;
+	return true;
+}
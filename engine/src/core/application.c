@@ -2,16 +2,25 @@
 
 #include "core/clock.h"
 #include "core/event.h"
+#include "core/filesystem.h"
 #include "core/input.h"
+#include "core/job_system.h"
 #include "core/logger.h"
 #include "core/smemory.h"
 
 #include "defines.h"
 #include "game_types.h"
+#include "platform/file_watcher.h"
 #include "platform/platform.h"
 
 #include "memory/linear_allocator.h"
 #include "renderer/renderer_frontend.h"
+#include "resources/pack.h"
+#include "systems/geometry_system.h"
+#include "systems/texture_system.h"
+
+// getenv
+#include <stdlib.h>
 
 typedef struct application_state {
 	game *game_instance;
@@ -38,8 +47,26 @@ typedef struct application_state {
 	u64 platform_system_memory_requirement;
 	void *platform_system_state;
 
+	u64 filesystem_async_memory_requirement;
+	void *filesystem_async_state;
+
+	u64 pack_system_memory_requirement;
+	void *pack_system_state;
+
+	u64 file_watcher_memory_requirement;
+	void *file_watcher_state;
+
+	u64 job_system_memory_requirement;
+	void *job_system_state;
+
 	u64 renderer_system_memory_requirement;
 	void *renderer_system_state;
+
+	u64 texture_system_memory_requirement;
+	void *texture_system_state;
+
+	u64 geometry_system_memory_requirement;
+	void *geometry_system_state;
 } application_state;
 
 static application_state *app_state;
@@ -81,11 +108,14 @@ b8 application_create(game *game_instance) {
 	// Logging
 	logging_system_initialize(&app_state->logging_system_memory_requirement, 0);
 	app_state->logging_system_state =
-		linear_allocator_allocate(&app_state->systems_allocator, app_state->memory_system_memory_requirement);
+		linear_allocator_allocate(&app_state->systems_allocator, app_state->logging_system_memory_requirement);
 	if (!logging_system_initialize(&app_state->logging_system_memory_requirement, app_state->logging_system_state)) {
 		SERROR("Failed to initialize logging system; shutting down.");
 		return false;
 	}
+	// For example SPACE_LOG_LEVELS=info,vulkan=trace
+	const char *log_levels = getenv("SPACE_LOG_LEVELS");
+	if (log_levels && !log_set_category_levels(log_levels)) { SWARN("Ignored invalid entries in SPACE_LOG_LEVELS."); }
 
 	// Input
 	input_system_initialize(&app_state->input_system_memory_requirement, 0);
@@ -114,6 +144,42 @@ b8 application_create(game *game_instance) {
 		return false;
 	}
 
+	// Async file reads
+	filesystem_async_initialize(&app_state->filesystem_async_memory_requirement, 0);
+	app_state->filesystem_async_state =
+		linear_allocator_allocate(&app_state->systems_allocator, app_state->filesystem_async_memory_requirement);
+	if (!filesystem_async_initialize(&app_state->filesystem_async_memory_requirement,
+									 app_state->filesystem_async_state)) {
+		SERROR("Could not start async file reads");
+		return false;
+	}
+
+	// Asset pack, opened once so assets don't each need their own open.
+	pack_system_initialize(&app_state->pack_system_memory_requirement, 0, 0);
+	app_state->pack_system_state =
+		linear_allocator_allocate(&app_state->systems_allocator, app_state->pack_system_memory_requirement);
+	if (!pack_system_initialize(&app_state->pack_system_memory_requirement,
+								app_state->pack_system_state,
+								PACK_DEFAULT_PATH)) {
+		SERROR("Could not open the asset pack");
+		return false;
+	}
+
+	// Hot reload of the loose asset files.
+	file_watcher_initialize(&app_state->file_watcher_memory_requirement, 0, 0);
+	app_state->file_watcher_state =
+		linear_allocator_allocate(&app_state->systems_allocator, app_state->file_watcher_memory_requirement);
+	file_watcher_initialize(&app_state->file_watcher_memory_requirement, app_state->file_watcher_state, "assets");
+
+	// Worker threads, for work like decoding assets off the main thread.
+	job_system_initialize(&app_state->job_system_memory_requirement, 0);
+	app_state->job_system_state =
+		linear_allocator_allocate(&app_state->systems_allocator, app_state->job_system_memory_requirement);
+	if (!job_system_initialize(&app_state->job_system_memory_requirement, app_state->job_system_state)) {
+		SERROR("Could not start the job system");
+		return false;
+	}
+
 	// Renderer startup
 	render_system_initialize(&app_state->renderer_system_memory_requirement, 0, 0);
 	app_state->renderer_system_state =
@@ -125,6 +191,33 @@ b8 application_create(game *game_instance) {
 		return false;
 	}
 
+	// Texture system
+	texture_system_config texture_sys_config;
+	texture_sys_config.max_texture_count = 1024;
+	texture_sys_config.streaming_budget  = MEBIBYTES(256);
+	texture_system_initialize(&app_state->texture_system_memory_requirement, 0, texture_sys_config);
+	app_state->texture_system_state =
+		linear_allocator_allocate(&app_state->systems_allocator, app_state->texture_system_memory_requirement);
+	if (!texture_system_initialize(&app_state->texture_system_memory_requirement,
+								   app_state->texture_system_state,
+								   texture_sys_config)) {
+		SFATAL("Failed to initialize texture system. Application cannot continue.");
+		return false;
+	}
+
+	// Geometry system
+	geometry_system_config geometry_sys_config;
+	geometry_sys_config.max_geometry_count = 4096;
+	geometry_system_initialize(&app_state->geometry_system_memory_requirement, 0, geometry_sys_config);
+	app_state->geometry_system_state =
+		linear_allocator_allocate(&app_state->systems_allocator, app_state->geometry_system_memory_requirement);
+	if (!geometry_system_initialize(&app_state->geometry_system_memory_requirement,
+									app_state->geometry_system_state,
+									geometry_sys_config)) {
+		SFATAL("Failed to initialize geometry system. Application cannot continue.");
+		return false;
+	}
+
 	// Initialize the game
 	if (!app_state->game_instance->initialize(app_state->game_instance)) {
 		SFATAL("Game failed to initialize.");
@@ -133,6 +226,18 @@ b8 application_create(game *game_instance) {
 
 	app_state->game_instance->on_resize(app_state->game_instance, app_state->width, app_state->height);
 
+	// Input recording/replay, the environment can override the game's configuration so any build can be benchmarked.
+	application_config *config = &app_state->game_instance->app_config;
+	const char *replay_path    = getenv("SPACE_INPUT_REPLAY");
+	const char *record_path    = getenv("SPACE_INPUT_RECORD");
+	if (!replay_path) { replay_path = config->input_replay_path; }
+	if (!record_path) { record_path = config->input_record_path; }
+	if (replay_path) {
+		if (!input_replay_start(replay_path)) { return false; }
+	} else if (record_path) {
+		if (!input_record_start(record_path)) { return false; }
+	}
+
 	return true;
 }
 
@@ -144,6 +249,7 @@ b8 application_run() {
 
 	f64 running_time         = 0;
 	u16 frame_count          = 0;
+	u64 total_frames         = 0;
 	f64 target_frame_seconds = 1.0f / 165;
 
 	SINFO(get_memory_usage_string());
@@ -151,10 +257,27 @@ b8 application_run() {
 	while (app_state->is_running) {
 		if (!platform_pump_messages()) { app_state->is_running = false; }
 
+		// Replayed input takes the place of whatever was just pumped.
+		f64 replay_delta = 0;
+		b8 replaying     = input_is_replaying();
+		if (replaying && !input_replay_frame(&replay_delta)) {
+			SINFO("Input replay finished.");
+			app_state->is_running = false;
+			break;
+		}
+
+		// Deliver everything posted while pumping messages in one go.
+		event_dispatch_queued();
+
+		// Async read callbacks run here, before the frame that may want their data.
+		filesystem_async_update();
+		job_system_update();
+		file_watcher_update();
+
 		if (!app_state->is_suspended) {
 			clock_update(&app_state->clock);
 			f64 current_time     = app_state->clock.elapsed;
-			f64 delta            = (current_time - app_state->last_time);
+			f64 delta            = replaying ? replay_delta : (current_time - app_state->last_time);
 			f64 frame_start_time = platform_get_absolute_time();
 
 			if (!app_state->game_instance->update(app_state->game_instance, (f32)delta)) {
@@ -173,10 +296,12 @@ b8 application_run() {
 			render_packet packet;
 			packet.delta_time = (f32)delta;
 			renderer_draw_frame(&packet);
+			texture_system_update();
 
 			f64 frame_end_time     = platform_get_absolute_time();
 			f64 frame_elapsed_time = frame_end_time - frame_start_time;
 			running_time += frame_elapsed_time;
+			total_frames++;
 			f64 remaining_seconds = target_frame_seconds - frame_elapsed_time;
 
 			if (remaining_seconds > 0) {
@@ -206,8 +331,19 @@ b8 application_run() {
 
 	input_system_shutdown(app_state->input_system_state);
 
+	// Jobs still running may create renderer resources when they complete.
+	job_system_shutdown(app_state->job_system_state);
+	geometry_system_shutdown(app_state->geometry_system_state);
+	texture_system_shutdown(app_state->texture_system_state);
+
 	renderer_system_shutdown(app_state->renderer_system_state);
 
+	file_watcher_shutdown(app_state->file_watcher_state);
+
+	pack_system_shutdown(app_state->pack_system_state);
+
+	filesystem_async_shutdown(app_state->filesystem_async_state);
+
 	platform_system_shutdown(app_state->platform_system_state);
 
 	memory_system_shutdown(app_state->memory_system_state);
@@ -215,8 +351,14 @@ b8 application_run() {
 	event_system_shutdown(app_state->event_system_state);
 
 	SINFO("Ran for %d frames (%f seconds)", frame_count, running_time);
+	if (total_frames > 0) {
+		SINFO("Average frame time: %f ms over %llu frames", running_time * 1000.0 / (f64)total_frames, total_frames);
+	}
 	SINFO("Shut down successfully");
 
+	// Last, so everything above still makes it to the log.
+	logging_shutdown();
+
 	return true;
 }
 
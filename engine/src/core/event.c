@@ -1,110 +1,476 @@
 #include "core/event.h"
 
-#include "containers/darray.h"
+#include "core/logger.h"
 #include "core/smemory.h"
 
-// This should be more than enough
-#define MAX_MESSAGE_CODES 16386
+#include <stdatomic.h>
+
+#define MAX_MESSAGE_CODES (MAX_EVENT_CODE + 1)
+
+// Total number of listeners across all codes.
+#define MAX_REGISTERED_LISTENERS 1024
+
+// Registration changes made by listeners while events are being dispatched are
+// applied once dispatching is done.
+#define MAX_DEFERRED_REGISTRATIONS 64
+
+// Maximum number of events that can be posted in a single frame before they are
+// dispatched synchronously instead.
+#define MAX_QUEUED_EVENTS 4096
+
+// Maximum number of threads, other than the main thread, that can talk to the event system at once. The engine
+// itself runs at most 13: the job and async IO workers and the log writer.
+#define MAX_EVENT_THREADS 16
+
+// Number of commands each thread can have in flight between two dispatches. Must be a power of two. Worker threads
+// post a handful of events per frame, not hundreds.
+#define THREAD_COMMAND_RING_SIZE 128
 
 typedef struct registered_event {
 	void *listener;
+	// Cleared when unregistered during a dispatch, so the listener isn't called again before it's removed.
 	PFN_on_event callback;
 } registered_event;
 
-typedef struct event_code_entry {
-	registered_event *events;
-} event_code_entry;
+// Where the listeners of a code live in the listener pool. Kept to 4 bytes so a
+// fire only touches this and the listeners themselves.
+typedef struct event_code_range {
+	u16 offset;
+	u16 count;
+} event_code_range;
+
+typedef struct queued_event {
+	u16 code;
+	// Set when superseded by a later event of the same coalescing code.
+	b8 dropped;
+	void *sender;
+	event_context context;
+} queued_event;
+
+typedef enum thread_command_type {
+	THREAD_COMMAND_POST,
+	THREAD_COMMAND_REGISTER,
+	THREAD_COMMAND_UNREGISTER,
+} thread_command_type;
+
+// A request made from a thread other than the main thread, applied by the main thread in event_dispatch_queued.
+typedef struct thread_command {
+	thread_command_type type;
+	u16 code;
+	// Sender for posts, listener for (un)registrations.
+	void *instance;
+	PFN_on_event callback;
+	event_context context;
+} thread_command;
+
+typedef enum thread_ring_state {
+	THREAD_RING_FREE,
+	THREAD_RING_OWNED,
+	// The owning thread exited, the ring is freed once the main thread has applied what's left in it.
+	THREAD_RING_RELEASED,
+} thread_ring_state;
+
+// Single producer, single consumer ring. Each thread owns one, so pushing needs no locks.
+typedef struct thread_command_ring {
+	// Written by the owning thread only.
+	_Atomic u32 head;
+	u8 head_padding[60];
+	// Written by the main thread only.
+	_Atomic u32 tail;
+	// A thread_ring_state. Claimed and released by threads, freed by the main thread.
+	_Atomic u32 state;
+	u8 tail_padding[56];
+
+	thread_command commands[THREAD_COMMAND_RING_SIZE];
+} thread_command_ring;
 
 typedef struct event_system_state {
-	event_code_entry registered[MAX_MESSAGE_CODES];
+	// Listeners of all codes in one contiguous block, sorted by code.
+	registered_event listeners[MAX_REGISTERED_LISTENERS];
+	u16 listener_count;
+	event_code_range ranges[MAX_MESSAGE_CODES];
+
+	// If set, only the latest posted event of a code is kept per frame.
+	b8 coalesce[MAX_MESSAGE_CODES];
+	// Index of the pending queued event for a coalescing code, INVALID_ID if none.
+	u32 queued_index[MAX_MESSAGE_CODES];
+
+	// Non-zero while listeners are being called.
+	u32 dispatch_depth;
+	u32 deferred_count;
+	thread_command deferred[MAX_DEFERRED_REGISTRATIONS];
+
+	u32 queued_count;
+	queued_event queued[MAX_QUEUED_EVENTS];
+
+	thread_command_ring thread_rings[MAX_EVENT_THREADS];
 } event_system_state;
 
 // Event system internal state
 static event_system_state *state_ptr;
 
+// NOTE: initial-exec avoids a __tls_get_addr call on every fire. Fine as long as the
+// engine library is linked in and not dlopen'ed late.
+#if defined(__clang__) || defined(__GNUC__)
+	#define EVENT_THREAD_LOCAL _Thread_local __attribute__((tls_model("initial-exec")))
+#else
+	#define EVENT_THREAD_LOCAL _Thread_local
+#endif
+
+// Set on the thread which initialized the event system.
+static EVENT_THREAD_LOCAL b8 is_main_thread = false;
+// Ring owned by the current thread, INVALID_ID until the thread first talks to the event system or after
+// event_thread_release.
+static EVENT_THREAD_LOCAL u32 thread_ring_index = INVALID_ID;
+
+static b8 deferred_push(thread_command command);
+static void deferred_apply();
+static b8 thread_command_push(thread_command command);
+static void thread_commands_apply();
+
 void event_system_initialize(u64 *memory_requirement, void *state) {
 	*memory_requirement = sizeof(event_system_state);
 	if (state == 0) { return; }
 
 	state_ptr = state;
 	szero_memory(state_ptr, sizeof(event_system_state));
+	is_main_thread = true;
+
+	for (u32 i = 0; i < MAX_MESSAGE_CODES; ++i) { state_ptr->queued_index[i] = INVALID_ID; }
+
+	// High-frequency engine events, only the latest value is of interest.
+	event_set_coalescing(EVENT_CODE_MOUSE_MOVED, true);
+	event_set_coalescing(EVENT_CODE_RESIZED, true);
 }
 
 void event_system_shutdown(void *state) {
 	(void)state;
 	if (!state_ptr) { return; }
 
-	// Free the events arrays. And objects pointed to should be destroyed on their own.
-	for (u16 i = 0; i < MAX_MESSAGE_CODES; ++i) {
-		if (state_ptr->registered[i].events != 0) {
-			darray_destroy(state_ptr->registered[i].events);
-			state_ptr->registered[i].events = 0;
-		}
-	}
+	// Objects pointed to by listeners should be destroyed on their own.
+	state_ptr->listener_count = 0;
+	szero_memory(state_ptr->ranges, sizeof(state_ptr->ranges));
 }
 
 b8 event_register(u16 code, void *listener, PFN_on_event on_event) {
 	if (!state_ptr) { return false; }
 
-	if (state_ptr->registered[code].events == 0) {
-		state_ptr->registered[code].events = darray_create(registered_event);
+	if (!is_main_thread || state_ptr->dispatch_depth > 0) {
+		return deferred_push((thread_command){
+			.type     = THREAD_COMMAND_REGISTER,
+			.code     = code,
+			.instance = listener,
+			.callback = on_event,
+		});
 	}
 
-	u64 registered_count = darray_length(state_ptr->registered[code].events);
-	for (u64 i = 0; i < registered_count; ++i) {
-		if (state_ptr->registered[code].events[i].listener == listener) {
+	if (code >= MAX_MESSAGE_CODES) {
+		SWARN("event_register - code 0x%x is above MAX_EVENT_CODE.", code);
+		return false;
+	}
+
+	event_code_range *range = &state_ptr->ranges[code];
+	for (u16 i = range->offset; i < range->offset + range->count; ++i) {
+		if (state_ptr->listeners[i].listener == listener) {
 			// TODO: warn
 			return false;
 		}
 	}
 
+	if (state_ptr->listener_count >= MAX_REGISTERED_LISTENERS) {
+		SERROR("event_register - listener pool is full (%u listeners).", MAX_REGISTERED_LISTENERS);
+		return false;
+	}
+
 	// If at this point, no duplicate was found. Proceed with registration.
-	registered_event event;
-	event.listener = listener;
-	event.callback = on_event;
-	darray_push(state_ptr->registered[code].events, event);
+	// Make room at the end of this code's range by moving the listeners of all higher codes up one slot.
+	u16 insert_at = range->offset + range->count;
+	for (u16 i = state_ptr->listener_count; i > insert_at; --i) {
+		state_ptr->listeners[i] = state_ptr->listeners[i - 1];
+	}
+	state_ptr->listeners[insert_at].listener = listener;
+	state_ptr->listeners[insert_at].callback = on_event;
+	state_ptr->listener_count++;
+
+	range->count++;
+	for (u32 c = code + 1u; c < MAX_MESSAGE_CODES; ++c) { state_ptr->ranges[c].offset++; }
 
 	return true;
 }
 
+// @returns The listener registered for code with on_event, 0 if there is none. One being unregistered matches too.
+static registered_event *find_listener(u16 code, void *listener, PFN_on_event on_event) {
+	if (code >= MAX_MESSAGE_CODES) { return 0; }
+
+	// A listener is only registered once per code, so a cleared callback can only be this one.
+	event_code_range range = state_ptr->ranges[code];
+	for (u16 i = range.offset; i < range.offset + range.count; ++i) {
+		registered_event *e = &state_ptr->listeners[i];
+		if (e->listener == listener && (e->callback == on_event || e->callback == 0)) { return e; }
+	}
+	return 0;
+}
+
 b8 event_unregister(u16 code, void *listener, PFN_on_event on_event) {
 	if (!state_ptr) { return false; }
 
-	if (state_ptr->registered[code].events == 0) {
+	if (!is_main_thread || state_ptr->dispatch_depth > 0) {
+		b8 deferred = deferred_push((thread_command){
+			.type     = THREAD_COMMAND_UNREGISTER,
+			.code     = code,
+			.instance = listener,
+			.callback = on_event,
+		});
+		// Not called for the rest of the dispatch either.
+		registered_event *e = is_main_thread && deferred ? find_listener(code, listener, on_event) : 0;
+		if (e) { e->callback = 0; }
+		return deferred;
+	}
+
+	registered_event *e = find_listener(code, listener, on_event);
+	if (!e) {
 		// TODO: warn
 		return false;
 	}
 
-	u64 registered_count = darray_length(state_ptr->registered[code].events);
-	for (u64 i = 0; i < registered_count; ++i) {
-		registered_event e = state_ptr->registered[code].events[i];
-		if (e.listener == listener && e.callback == on_event) {
-			// Found one, remove it
-			registered_event popped_event;
-			darray_pop_at(state_ptr->registered[code].events, i, &popped_event);
-			return true;
-		}
-	}
+	// Remove it and move the listeners of all higher codes down one slot.
+	u16 i = (u16)(e - state_ptr->listeners);
+	state_ptr->listener_count--;
+	for (u16 j = i; j < state_ptr->listener_count; ++j) { state_ptr->listeners[j] = state_ptr->listeners[j + 1]; }
 
-	// Not found;
-	return false;
+	state_ptr->ranges[code].count--;
+	for (u32 c = code + 1u; c < MAX_MESSAGE_CODES; ++c) { state_ptr->ranges[c].offset--; }
+	return true;
 }
 
 b8 event_fire(u16 code, void *sender, event_context context) {
 	if (!state_ptr) { return false; }
 
+	// Listeners are only ever called on the main thread, defer to the next dispatch.
+	if (!is_main_thread) {
+		event_post(code, sender, context);
+		return false;
+	}
+
 	// If nothing is registered for the code, boot out.
-	if (state_ptr->registered[code].events == 0) { return false; }
+	if (code >= MAX_MESSAGE_CODES || state_ptr->ranges[code].count == 0) { return false; }
 
-	u64 registered_count = darray_length(state_ptr->registered[code].events);
-	for (u64 i = 0; i < registered_count; ++i) {
-		registered_event e = state_ptr->registered[code].events[i];
-		if (e.callback(code, sender, e.listener, context)) {
+	b8 handled = false;
+	state_ptr->dispatch_depth++;
+
+	event_code_range range  = state_ptr->ranges[code];
+	registered_event *first = &state_ptr->listeners[range.offset];
+	for (u16 i = 0; i < range.count; ++i) {
+		// Unregistered by an earlier listener.
+		if (!first[i].callback) { continue; }
+		if (first[i].callback(code, sender, first[i].listener, context)) {
 			// Message has been handled, do not send to other listeners.
+			handled = true;
+			break;
+		}
+	}
+
+	// Back at the outermost dispatch, apply what listeners changed in the meantime.
+	if (--state_ptr->dispatch_depth == 0 && state_ptr->deferred_count > 0) { deferred_apply(); }
+	return handled;
+}
+
+b8 event_post(u16 code, void *sender, event_context context) {
+	if (!state_ptr) { return false; }
+
+	if (!is_main_thread) {
+		return thread_command_push((thread_command){
+			.type     = THREAD_COMMAND_POST,
+			.code     = code,
+			.instance = sender,
+			.context  = context,
+		});
+	}
+
+	if (code >= MAX_MESSAGE_CODES) {
+		SWARN("event_post - code 0x%x is above MAX_EVENT_CODE.", code);
+		return false;
+	}
+
+	u32 *queued_index = &state_ptr->queued_index[code];
+	if (state_ptr->coalesce[code] && *queued_index != INVALID_ID) {
+		queued_event *pending = &state_ptr->queued[*queued_index];
+		if (*queued_index == state_ptr->queued_count - 1) {
+			// Nothing was posted after it, just replace the value in place.
+			pending->sender  = sender;
+			pending->context = context;
 			return true;
 		}
+
+		// Other events were posted since, drop the old one and append this one to
+		// keep the ordering relative to those events.
+		pending->dropped = true;
+		*queued_index    = INVALID_ID;
+	}
+
+	if (state_ptr->queued_count >= MAX_QUEUED_EVENTS) {
+		// Queue is full, don't drop the event but deliver it right away.
+		SWARN("Event queue full (%u events), firing event 0x%x immediately.", MAX_QUEUED_EVENTS, code);
+		event_fire(code, sender, context);
+		return true;
+	}
+
+	if (state_ptr->coalesce[code]) { *queued_index = state_ptr->queued_count; }
+
+	queued_event *e = &state_ptr->queued[state_ptr->queued_count++];
+	e->code         = code;
+	e->dropped      = false;
+	e->sender       = sender;
+	e->context      = context;
+
+	return true;
+}
+
+void event_set_coalescing(u16 code, b8 coalesce) {
+	if (!state_ptr || !is_main_thread || code >= MAX_MESSAGE_CODES) { return; }
+
+	state_ptr->coalesce[code] = coalesce;
+}
+
+void event_dispatch_queued() {
+	if (!state_ptr) { return; }
+
+	// Merge in everything other threads have sent since the last dispatch.
+	thread_commands_apply();
+
+	state_ptr->dispatch_depth++;
+
+	// NOTE: queued_count is re-read every iteration, listeners may post new events
+	// while the queue is being drained. Those are dispatched in the same pass.
+	u32 i = 0;
+	while (i < state_ptr->queued_count) {
+		u16 code = state_ptr->queued[i].code;
+
+		// Find the run of consecutive events sharing this code. Only consecutive
+		// events are batched so the relative order of different codes is kept.
+		u32 run_end = i + 1;
+		while (run_end < state_ptr->queued_count && state_ptr->queued[run_end].code == code) { run_end++; }
+
+		// Registration changes are deferred while dispatching, so the range stays valid for the whole run.
+		event_code_range range  = state_ptr->ranges[code];
+		registered_event *first = &state_ptr->listeners[range.offset];
+		for (u32 q = i; q < run_end; ++q) {
+			queued_event *e = &state_ptr->queued[q];
+			if (e->dropped) { continue; }
+
+			// The pending event is being dispatched, anything posted from here on
+			// gets a slot of its own.
+			if (state_ptr->queued_index[code] == q) { state_ptr->queued_index[code] = INVALID_ID; }
+
+			for (u16 l = 0; l < range.count; ++l) {
+				// Unregistered by an earlier listener.
+				if (!first[l].callback) { continue; }
+				// Message has been handled, do not send to other listeners.
+				if (first[l].callback(code, e->sender, first[l].listener, e->context)) { break; }
+			}
+		}
+
+		i = run_end;
+	}
+
+	state_ptr->queued_count = 0;
+	// Back at the outermost dispatch, apply what listeners changed in the meantime.
+	if (--state_ptr->dispatch_depth == 0 && state_ptr->deferred_count > 0) { deferred_apply(); }
+}
+
+static b8 deferred_push(thread_command command) {
+	if (!is_main_thread) { return thread_command_push(command); }
+
+	if (state_ptr->deferred_count >= MAX_DEFERRED_REGISTRATIONS) {
+		SERROR("Too many event registration changes while dispatching, dropping change for code 0x%x.",
+			   command.code);
+		return false;
+	}
+
+	state_ptr->deferred[state_ptr->deferred_count++] = command;
+	return true;
+}
+
+static void deferred_apply() {
+	for (u32 i = 0; i < state_ptr->deferred_count; ++i) {
+		thread_command *command = &state_ptr->deferred[i];
+		if (command->type == THREAD_COMMAND_REGISTER) {
+			event_register(command->code, command->instance, command->callback);
+		} else if (command->type == THREAD_COMMAND_UNREGISTER) {
+			event_unregister(command->code, command->instance, command->callback);
+		}
+	}
+	state_ptr->deferred_count = 0;
+}
+
+void event_thread_release() {
+	if (!state_ptr || thread_ring_index == INVALID_ID) { return; }
+
+	// Commands still in the ring are applied by the next dispatch before the ring is handed to another thread.
+	thread_command_ring *ring = &state_ptr->thread_rings[thread_ring_index];
+	atomic_store_explicit(&ring->state, THREAD_RING_RELEASED, memory_order_release);
+	thread_ring_index = INVALID_ID;
+}
+
+static b8 thread_command_push(thread_command command) {
+	if (thread_ring_index == INVALID_ID) {
+		for (u32 i = 0; i < MAX_EVENT_THREADS; ++i) {
+			u32 expected = THREAD_RING_FREE;
+			if (atomic_compare_exchange_strong_explicit(&state_ptr->thread_rings[i].state,
+														&expected,
+														THREAD_RING_OWNED,
+														memory_order_acquire,
+														memory_order_relaxed)) {
+				thread_ring_index = i;
+				break;
+			}
+		}
+		// NOTE: the logger can't be used from here, not all of it is thread-safe.
+		if (thread_ring_index == INVALID_ID) { return false; }
+	}
+
+	thread_command_ring *ring = &state_ptr->thread_rings[thread_ring_index];
+	u32 head                  = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	u32 tail                  = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	if (head - tail >= THREAD_COMMAND_RING_SIZE) {
+		// Full, the main thread hasn't caught up yet.
+		return false;
 	}
 
-	// Not found.
-	return false;
+	ring->commands[head & (THREAD_COMMAND_RING_SIZE - 1)] = command;
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+	return true;
+}
+
+static void thread_commands_apply() {
+	for (u32 r = 0; r < MAX_EVENT_THREADS; ++r) {
+		thread_command_ring *ring = &state_ptr->thread_rings[r];
+		// Read before head, a released ring can't receive anything after the head read below.
+		u32 ring_state = atomic_load_explicit(&ring->state, memory_order_acquire);
+		if (ring_state == THREAD_RING_FREE) { continue; }
+
+		u32 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+		u32 head                  = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+		for (; tail != head; ++tail) {
+			thread_command *command = &ring->commands[tail & (THREAD_COMMAND_RING_SIZE - 1)];
+			switch (command->type) {
+				case THREAD_COMMAND_POST:
+					event_post(command->code, command->instance, command->context);
+					break;
+				case THREAD_COMMAND_REGISTER:
+					event_register(command->code, command->instance, command->callback);
+					break;
+				case THREAD_COMMAND_UNREGISTER:
+					event_unregister(command->code, command->instance, command->callback);
+					break;
+			}
+		}
+
+		atomic_store_explicit(&ring->tail, tail, memory_order_release);
+		if (ring_state == THREAD_RING_RELEASED) {
+			atomic_store_explicit(&ring->state, THREAD_RING_FREE, memory_order_release);
+		}
+	}
 }
@@ -1,8 +1,34 @@
+#define LOG_CATEGORY LOG_CATEGORY_INPUT
+
 #include "core/input.h"
 #include "core/event.h"
+#include "core/filesystem.h"
 #include "core/logger.h"
 #include "core/smemory.h"
 
+// Input recording file layout:
+//   input_recording_header
+//   per frame: any number of [u8 tag][payload] records, terminated by an INPUT_RECORD_FRAME_END record.
+#define INPUT_RECORDING_MAGIC 0x504E4953U // "SINP"
+#define INPUT_RECORDING_VERSION 1
+#define INPUT_RECORD_BUFFER_SIZE KIBIBYTES(16)
+
+typedef enum input_record_tag {
+	// payload: input_event
+	INPUT_RECORD_EVENT = 1,
+	// payload: f32 delta_x, f32 delta_y, accumulated over the frame.
+	INPUT_RECORD_RAW_MOTION = 2,
+	// payload: f64 frame delta time.
+	INPUT_RECORD_FRAME_END = 3,
+} input_record_tag;
+
+typedef struct input_recording_header {
+	u32 magic;
+	u32 version;
+	b8 raw_motion_available;
+	u8 reserved[7];
+} input_recording_header;
+
 typedef struct keyboard_state {
 	b8 keys[KEYS_MAX_KEYS];
 } keyboard_state;
@@ -13,16 +39,59 @@ typedef struct mouse_state {
 	u8 buttons[BUTTON_MAX_BUTTONS];
 } mouse_state;
 
+typedef struct input_binding {
+	input_event_type type;
+	u16 code;
+} input_binding;
+
+typedef struct input_action {
+	u8 binding_count;
+	input_binding bindings[MAX_INPUT_ACTION_BINDINGS];
+} input_action;
+
 typedef struct input_state {
 	keyboard_state keyboard_current;
 	keyboard_state keyboard_previous;
 	mouse_state mouse_current;
 	mouse_state mouse_previous;
+
+	// Relative motion over the current frame.
+	f32 mouse_delta_x;
+	f32 mouse_delta_y;
+	b8 raw_motion_available;
+
+	// Total number of events recorded, the ring holds the last INPUT_EVENT_RING_SIZE of them.
+	u64 event_count;
+	// Value of event_count at the start of the current frame.
+	u64 frame_first_event;
+	input_event events[INPUT_EVENT_RING_SIZE];
+
+	input_action actions[MAX_INPUT_ACTIONS];
+
+	b8 recording;
+	file_handle record_file;
+	u64 record_buffer_used;
+	u8 record_buffer[INPUT_RECORD_BUFFER_SIZE];
+
+	// The whole recording is read up front, replay walks through it frame by frame.
+	b8 replaying;
+	u8 *replay_data;
+	u64 replay_size;
+	u64 replay_offset;
 } input_state;
 
 // Internal input state
 static input_state *state_ptr;
 
+static void record_event(input_event_type type, u16 code, b8 pressed, i16 x, i16 y, u32 timestamp);
+static void apply_key(keys key, b8 pressed, u32 timestamp);
+static void apply_button(buttons button, b8 pressed, u32 timestamp);
+static void apply_mouse_move(i16 x, i16 y, u32 timestamp);
+static void apply_mouse_wheel(i8 z_delta, u32 timestamp);
+static void recording_write(input_record_tag tag, const void *payload, u64 size);
+static void recording_flush();
+static u32 count_action_events(u16 action, b8 pressed);
+
 void input_system_initialize(u64 *memory_requirement, void *state) {
 	*memory_requirement = sizeof(input_state);
 	if (state == 0) { return; }
@@ -35,62 +104,121 @@ void input_system_initialize(u64 *memory_requirement, void *state) {
 void input_system_shutdown(void *state) {
 	(void)state;
 
-	// TODO: Add shutdown routines when needed.
+	input_record_stop();
+	input_replay_stop();
 	state_ptr = 0;
 }
 
 void input_update(f64 delta_time) {
-	(void)delta_time;
-
 	if (!state_ptr) { return; }
 
+	if (state_ptr->recording) {
+		if (state_ptr->raw_motion_available && (state_ptr->mouse_delta_x != 0 || state_ptr->mouse_delta_y != 0)) {
+			f32 delta[2] = {state_ptr->mouse_delta_x, state_ptr->mouse_delta_y};
+			recording_write(INPUT_RECORD_RAW_MOTION, delta, sizeof(delta));
+		}
+		recording_write(INPUT_RECORD_FRAME_END, &delta_time, sizeof(delta_time));
+	}
+
 	// Copy current states to previous states.
 	scopy_memory(&state_ptr->keyboard_previous, &state_ptr->keyboard_current, sizeof(keyboard_state));
 	scopy_memory(&state_ptr->mouse_previous, &state_ptr->mouse_current, sizeof(mouse_state));
+
+	state_ptr->mouse_delta_x = 0;
+	state_ptr->mouse_delta_y = 0;
+
+	// Start a new frame window in the event ring.
+	state_ptr->frame_first_event = state_ptr->event_count;
 }
 
-void input_process_key(keys key, b8 pressed) {
+// NOTE: While replaying, platform input is ignored. The replay feeds the apply_* functions directly.
+
+void input_process_key(keys key, b8 pressed, u32 timestamp) {
+	if (state_ptr && !state_ptr->replaying) { apply_key(key, pressed, timestamp); }
+}
+
+void input_process_button(buttons button, b8 pressed, u32 timestamp) {
+	if (state_ptr && !state_ptr->replaying) { apply_button(button, pressed, timestamp); }
+}
+
+void input_process_mouse_move(i16 x, i16 y, u32 timestamp) {
+	if (state_ptr && !state_ptr->replaying) { apply_mouse_move(x, y, timestamp); }
+}
+
+void input_process_mouse_wheel(i8 z_delta, u32 timestamp) {
+	if (state_ptr && !state_ptr->replaying) { apply_mouse_wheel(z_delta, timestamp); }
+}
+
+static void apply_key(keys key, b8 pressed, u32 timestamp) {
+	record_event(INPUT_EVENT_TYPE_KEY, (u16)key, pressed, 0, 0, timestamp);
+
 	// Only handle this if the state actually changed.
 	if (state_ptr->keyboard_current.keys[key] != pressed) {
 		// Update internal state
 		state_ptr->keyboard_current.keys[key] = pressed;
 
-		// Fire off an event for immediate processing.
+		// Post an event, dispatched after all platform messages have been pumped.
 		event_context context;
 		context.data.u16[0] = (u16)key;
-		event_fire(pressed ? EVENT_CODE_KEY_PRESSED : EVENT_CODE_KEY_RELEASED, 0, context);
+		event_post(pressed ? EVENT_CODE_KEY_PRESSED : EVENT_CODE_KEY_RELEASED, 0, context);
 	}
 }
 
-void input_process_button(buttons button, b8 pressed) {
+static void apply_button(buttons button, b8 pressed, u32 timestamp) {
+	record_event(INPUT_EVENT_TYPE_BUTTON, (u16)button, pressed, 0, 0, timestamp);
+
 	// If the state changed, fire an event.
 	if (state_ptr->mouse_current.buttons[button] != pressed) {
 		state_ptr->mouse_current.buttons[button] = pressed;
 
-		// Fire the event.
+		// Post the event.
 		event_context context;
 		context.data.u16[0] = (u16)button;
-		event_fire(pressed ? EVENT_CODE_BUTTON_PRESSED : EVENT_CODE_BUTTON_RELEASED, 0, context);
+		event_post(pressed ? EVENT_CODE_BUTTON_PRESSED : EVENT_CODE_BUTTON_RELEASED, 0, context);
 	}
 }
 
-void input_process_mouse_move(i16 x, i16 y) {
+static void apply_mouse_move(i16 x, i16 y, u32 timestamp) {
+	record_event(INPUT_EVENT_TYPE_MOUSE_MOVE, 0, false, x, y, timestamp);
+
 	if (state_ptr->mouse_current.x != x || state_ptr->mouse_current.y != y) {
+		if (!state_ptr->raw_motion_available) {
+			state_ptr->mouse_delta_x += (f32)(x - state_ptr->mouse_current.x);
+			state_ptr->mouse_delta_y += (f32)(y - state_ptr->mouse_current.y);
+		}
+
 		state_ptr->mouse_current.x = x;
 		state_ptr->mouse_current.y = y;
 
 		event_context context;
 		context.data.u16[0] = (u16)x;
 		context.data.u16[1] = (u16)y;
-		event_fire(EVENT_CODE_MOUSE_MOVED, 0, context);
+		event_post(EVENT_CODE_MOUSE_MOVED, 0, context);
 	}
 }
 
-void input_process_mouse_wheel(i8 z_delta) {
-	// NOTE: No internal state
+static void apply_mouse_wheel(i8 z_delta, u32 timestamp) {
+	record_event(INPUT_EVENT_TYPE_MOUSE_WHEEL, 0, false, z_delta, 0, timestamp);
+
+	// NOTE: No internal state besides the event ring
 	event_context context;
 	context.data.i8[0] = z_delta;
-	event_fire(EVENT_CODE_MOUSE_WHEEL, 0, context);
+	event_post(EVENT_CODE_MOUSE_WHEEL, 0, context);
+}
+
+void input_process_mouse_raw_motion(f32 delta_x, f32 delta_y) {
+	if (!state_ptr || state_ptr->replaying) { return; }
+
+	// NOTE: No event, raw motion can arrive at the device rate. Just accumulate.
+	state_ptr->mouse_delta_x += delta_x;
+	state_ptr->mouse_delta_y += delta_y;
+}
+
+void input_set_raw_motion_available(b8 available) {
+	// The replay decides, based on what was available while recording.
+	if (!state_ptr || state_ptr->replaying) { return; }
+
+	state_ptr->raw_motion_available = available;
 }
 
 b8 input_is_key_down(keys key) {
@@ -144,6 +272,17 @@ void input_get_mouse_position(i32 *x, i32 *y) {
 	*y = state_ptr->mouse_current.y;
 }
 
+void input_get_mouse_delta(f32 *x, f32 *y) {
+	if (!state_ptr) {
+		*x = 0;
+		*y = 0;
+		return;
+	}
+
+	*x = state_ptr->mouse_delta_x;
+	*y = state_ptr->mouse_delta_y;
+}
+
 void input_get_previous_mouse_position(i32 *x, i32 *y) {
 	if (!state_ptr) {
 		*x = 0;
@@ -154,3 +293,297 @@ void input_get_previous_mouse_position(i32 *x, i32 *y) {
 	*x = state_ptr->mouse_previous.x;
 	*y = state_ptr->mouse_previous.y;
 }
+
+void input_get_frame_event_range(u64 *out_first, u64 *out_end) {
+	if (!state_ptr) {
+		*out_first = 0;
+		*out_end   = 0;
+		return;
+	}
+
+	// Events older than the ring size are gone, even if they belong to this frame.
+	u64 oldest = state_ptr->event_count > INPUT_EVENT_RING_SIZE ? state_ptr->event_count - INPUT_EVENT_RING_SIZE : 0;
+	*out_first = SMAX(state_ptr->frame_first_event, oldest);
+	*out_end   = state_ptr->event_count;
+}
+
+b8 input_get_event(u64 index, input_event *out_event) {
+	if (!state_ptr || index >= state_ptr->event_count || state_ptr->event_count - index > INPUT_EVENT_RING_SIZE) {
+		return false;
+	}
+
+	*out_event = state_ptr->events[index & (INPUT_EVENT_RING_SIZE - 1)];
+	return true;
+}
+
+static b8 action_bind(u16 action, input_event_type type, u16 code) {
+	if (!state_ptr || action >= MAX_INPUT_ACTIONS) { return false; }
+
+	input_action *a = &state_ptr->actions[action];
+	if (a->binding_count >= MAX_INPUT_ACTION_BINDINGS) {
+		SWARN("Input action %u already has the maximum of %u bindings.", action, MAX_INPUT_ACTION_BINDINGS);
+		return false;
+	}
+
+	a->bindings[a->binding_count].type = type;
+	a->bindings[a->binding_count].code = code;
+	a->binding_count++;
+	return true;
+}
+
+b8 input_action_bind_key(u16 action, keys key) { return action_bind(action, INPUT_EVENT_TYPE_KEY, (u16)key); }
+
+b8 input_action_bind_button(u16 action, buttons button) {
+	return action_bind(action, INPUT_EVENT_TYPE_BUTTON, (u16)button);
+}
+
+void input_action_clear(u16 action) {
+	if (!state_ptr || action >= MAX_INPUT_ACTIONS) { return; }
+
+	state_ptr->actions[action].binding_count = 0;
+}
+
+b8 input_action_is_down(u16 action) {
+	if (!state_ptr || action >= MAX_INPUT_ACTIONS) { return false; }
+
+	input_action *a = &state_ptr->actions[action];
+	for (u8 i = 0; i < a->binding_count; ++i) {
+		if (a->bindings[i].type == INPUT_EVENT_TYPE_KEY && input_is_key_down(a->bindings[i].code)) { return true; }
+		if (a->bindings[i].type == INPUT_EVENT_TYPE_BUTTON && input_is_button_down(a->bindings[i].code)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+b8 input_action_was_pressed(u16 action) { return count_action_events(action, true) > 0; }
+
+b8 input_action_was_released(u16 action) { return count_action_events(action, false) > 0; }
+
+u32 input_action_press_count(u16 action) { return count_action_events(action, true); }
+
+static void record_event(input_event_type type, u16 code, b8 pressed, i16 x, i16 y, u32 timestamp) {
+	if (!state_ptr) { return; }
+
+	input_event *e = &state_ptr->events[state_ptr->event_count & (INPUT_EVENT_RING_SIZE - 1)];
+	e->timestamp   = timestamp;
+	e->type        = (u8)type;
+	e->pressed     = pressed;
+	e->code        = code;
+	e->x           = x;
+	e->y           = y;
+
+	state_ptr->event_count++;
+
+	if (state_ptr->recording) { recording_write(INPUT_RECORD_EVENT, e, sizeof(input_event)); }
+}
+
+static u32 count_action_events(u16 action, b8 pressed) {
+	if (!state_ptr || action >= MAX_INPUT_ACTIONS) { return 0; }
+
+	input_action *a = &state_ptr->actions[action];
+	if (a->binding_count == 0) { return 0; }
+
+	u64 first = 0;
+	u64 end   = 0;
+	input_get_frame_event_range(&first, &end);
+
+	u32 count = 0;
+	for (u64 i = first; i < end; ++i) {
+		input_event *e = &state_ptr->events[i & (INPUT_EVENT_RING_SIZE - 1)];
+		if (e->pressed != pressed) { continue; }
+
+		for (u8 b = 0; b < a->binding_count; ++b) {
+			if (a->bindings[b].type == e->type && a->bindings[b].code == e->code) {
+				count++;
+				break;
+			}
+		}
+	}
+
+	return count;
+}
+
+b8 input_record_start(const char *path) {
+	if (!state_ptr || state_ptr->recording || state_ptr->replaying) {
+		SERROR("input_record_start - input system not initialized or already recording/replaying.");
+		return false;
+	}
+
+	if (!filesystem_open(path, FILE_MODE_WRITE, true, &state_ptr->record_file)) {
+		SERROR("input_record_start - unable to open '%s' for writing.", path);
+		return false;
+	}
+
+	input_recording_header header = {
+		.magic                = INPUT_RECORDING_MAGIC,
+		.version              = INPUT_RECORDING_VERSION,
+		.raw_motion_available = state_ptr->raw_motion_available,
+	};
+	u64 written = 0;
+	if (!filesystem_write(&state_ptr->record_file, sizeof(header), &header, &written)) {
+		SERROR("input_record_start - failed to write header to '%s'.", path);
+		filesystem_close(&state_ptr->record_file);
+		return false;
+	}
+
+	state_ptr->record_buffer_used = 0;
+	state_ptr->recording          = true;
+	SINFO("Recording input to '%s'.", path);
+	return true;
+}
+
+void input_record_stop() {
+	if (!state_ptr || !state_ptr->recording) { return; }
+
+	recording_flush();
+	filesystem_close(&state_ptr->record_file);
+	state_ptr->recording = false;
+}
+
+b8 input_replay_start(const char *path) {
+	if (!state_ptr || state_ptr->recording || state_ptr->replaying) {
+		SERROR("input_replay_start - input system not initialized or already recording/replaying.");
+		return false;
+	}
+
+	file_handle file;
+	if (!filesystem_open(path, FILE_MODE_READ, true, &file)) {
+		SERROR("input_replay_start - unable to open '%s'.", path);
+		return false;
+	}
+
+	u8 *data  = 0;
+	u64 size  = 0;
+	b8 result = filesystem_read_all_bytes(&file, &data, &size);
+	filesystem_close(&file);
+	if (!result || size < sizeof(input_recording_header)) {
+		SERROR("input_replay_start - failed to read '%s'.", path);
+		if (data) { sfree(data, size, MEMORY_TAG_STRING); }
+		return false;
+	}
+
+	input_recording_header header;
+	scopy_memory(&header, data, sizeof(header));
+	if (header.magic != INPUT_RECORDING_MAGIC || header.version != INPUT_RECORDING_VERSION) {
+		SERROR("input_replay_start - '%s' is not a version %u input recording.", path, INPUT_RECORDING_VERSION);
+		sfree(data, size, MEMORY_TAG_STRING);
+		return false;
+	}
+
+	// Start from a clean slate, nothing held down, as the recording did.
+	szero_memory(&state_ptr->keyboard_current, sizeof(keyboard_state));
+	szero_memory(&state_ptr->keyboard_previous, sizeof(keyboard_state));
+	szero_memory(&state_ptr->mouse_current, sizeof(mouse_state));
+	szero_memory(&state_ptr->mouse_previous, sizeof(mouse_state));
+	state_ptr->mouse_delta_x = 0;
+	state_ptr->mouse_delta_y = 0;
+
+	state_ptr->replay_data          = data;
+	state_ptr->replay_size          = size;
+	state_ptr->replay_offset        = sizeof(header);
+	state_ptr->raw_motion_available = header.raw_motion_available;
+	state_ptr->replaying            = true;
+	SINFO("Replaying input from '%s'.", path);
+	return true;
+}
+
+void input_replay_stop() {
+	if (!state_ptr || !state_ptr->replaying) { return; }
+
+	sfree(state_ptr->replay_data, state_ptr->replay_size, MEMORY_TAG_STRING);
+	state_ptr->replay_data = 0;
+	state_ptr->replay_size = 0;
+	state_ptr->replaying   = false;
+}
+
+b8 input_is_replaying() { return state_ptr && state_ptr->replaying; }
+
+b8 input_replay_frame(f64 *out_delta_time) {
+	if (!state_ptr || !state_ptr->replaying) { return false; }
+
+	const u8 *data = state_ptr->replay_data;
+	u64 offset     = state_ptr->replay_offset;
+	while (offset < state_ptr->replay_size) {
+		input_record_tag tag = data[offset++];
+		switch (tag) {
+			case INPUT_RECORD_EVENT: {
+				if (offset + sizeof(input_event) > state_ptr->replay_size) { break; }
+				input_event e;
+				scopy_memory(&e, data + offset, sizeof(e));
+				offset += sizeof(e);
+
+				// Codes index the key and button arrays.
+				b8 code_valid = (e.type != INPUT_EVENT_TYPE_KEY || e.code < KEYS_MAX_KEYS)
+							 && (e.type != INPUT_EVENT_TYPE_BUTTON || e.code < BUTTON_MAX_BUTTONS);
+				if (!code_valid) { break; }
+
+				switch (e.type) {
+					case INPUT_EVENT_TYPE_KEY:
+						apply_key(e.code, e.pressed, e.timestamp);
+						break;
+					case INPUT_EVENT_TYPE_BUTTON:
+						apply_button(e.code, e.pressed, e.timestamp);
+						break;
+					case INPUT_EVENT_TYPE_MOUSE_MOVE:
+						apply_mouse_move(e.x, e.y, e.timestamp);
+						break;
+					case INPUT_EVENT_TYPE_MOUSE_WHEEL:
+						apply_mouse_wheel((i8)e.x, e.timestamp);
+						break;
+				}
+			} continue;
+
+			case INPUT_RECORD_RAW_MOTION: {
+				if (offset + sizeof(f32) * 2 > state_ptr->replay_size) { break; }
+				f32 delta[2];
+				scopy_memory(delta, data + offset, sizeof(delta));
+				offset += sizeof(delta);
+
+				state_ptr->mouse_delta_x += delta[0];
+				state_ptr->mouse_delta_y += delta[1];
+			} continue;
+
+			case INPUT_RECORD_FRAME_END: {
+				if (offset + sizeof(f64) > state_ptr->replay_size) { break; }
+				scopy_memory(out_delta_time, data + offset, sizeof(f64));
+				offset += sizeof(f64);
+
+				state_ptr->replay_offset = offset;
+				return true;
+			}
+		}
+
+		// Unknown tag or truncated record.
+		SERROR("input_replay_frame - corrupt input recording at offset %llu.", offset - 1);
+		break;
+	}
+
+	// Out of frames.
+	input_replay_stop();
+	return false;
+}
+
+static void recording_write(input_record_tag tag, const void *payload, u64 size) {
+	if (state_ptr->record_buffer_used + 1 + size > INPUT_RECORD_BUFFER_SIZE) { recording_flush(); }
+
+	state_ptr->record_buffer[state_ptr->record_buffer_used++] = (u8)tag;
+	scopy_memory(state_ptr->record_buffer + state_ptr->record_buffer_used, payload, size);
+	state_ptr->record_buffer_used += size;
+}
+
+static void recording_flush() {
+	if (state_ptr->record_buffer_used == 0) { return; }
+
+	u64 written = 0;
+	if (!filesystem_write(&state_ptr->record_file,
+						  state_ptr->record_buffer_used,
+						  state_ptr->record_buffer,
+						  &written)) {
+		SERROR("Failed to write input recording, stopping.");
+		filesystem_close(&state_ptr->record_file);
+		state_ptr->recording = false;
+	}
+	state_ptr->record_buffer_used = 0;
+}
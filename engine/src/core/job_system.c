@@ -0,0 +1,152 @@
+#include "core/job_system.h"
+
+#include "core/logger.h"
+#include "core/smemory.h"
+#include "platform/platform.h"
+
+#include <stdatomic.h>
+
+// Jobs queued or running at once. job_submit fails when all are in use.
+#define MAX_JOBS 256
+#define MAX_JOB_WORKERS 8
+
+typedef enum job_status {
+	JOB_FREE,
+	JOB_PENDING,
+	JOB_COMPLETE,
+} job_status;
+
+typedef struct job {
+	_Atomic u32 status;
+	b8 success;
+	PFN_job_start entry_point;
+	PFN_job_complete on_complete;
+	// Kept as u64s so params holding pointers are aligned.
+	u64 params[JOB_MAX_PARAMS_SIZE / sizeof(u64)];
+} job;
+
+typedef struct job_system_state {
+	job jobs[MAX_JOBS];
+	u32 pending_count;
+
+	// Only the main thread submits, workers claim jobs in order.
+	u32 worker_count;
+	platform_thread workers[MAX_JOB_WORKERS];
+	platform_semaphore work_available;
+	_Atomic b8 workers_running;
+	u32 queue_head;
+	_Atomic u32 queue_claimed;
+	u32 queue[MAX_JOBS];
+} job_system_state;
+
+static job_system_state *state_ptr;
+
+static u32 worker_run(void *params) {
+	(void)params;
+
+	while (true) {
+		platform_semaphore_wait(&state_ptr->work_available);
+		if (!atomic_load(&state_ptr->workers_running)) { break; }
+
+		u32 claimed          = atomic_fetch_add(&state_ptr->queue_claimed, 1);
+		job *claimed_job     = &state_ptr->jobs[state_ptr->queue[claimed % MAX_JOBS]];
+		claimed_job->success = claimed_job->entry_point(claimed_job->params);
+		atomic_store_explicit(&claimed_job->status, JOB_COMPLETE, memory_order_release);
+	}
+
+	return 0;
+}
+
+b8 job_system_initialize(u64 *memory_requirement, void *state) {
+	*memory_requirement = sizeof(job_system_state);
+	if (state == 0) { return true; }
+
+	szero_memory(state, sizeof(job_system_state));
+	state_ptr = state;
+
+	if (!platform_semaphore_create(0, &state_ptr->work_available)) { return false; }
+	atomic_store(&state_ptr->workers_running, true);
+
+	// Leave a core to the main thread.
+	u32 processors          = platform_get_processor_count();
+	state_ptr->worker_count = SMAX(1, SMIN(processors > 1 ? processors - 1 : 1, MAX_JOB_WORKERS));
+	for (u32 i = 0; i < state_ptr->worker_count; ++i) {
+		if (!platform_thread_create(worker_run, 0, &state_ptr->workers[i])) {
+			SERROR("Failed to start job worker.");
+			state_ptr->worker_count = i;
+			break;
+		}
+	}
+
+	SDEBUG("Job system started %u workers.", state_ptr->worker_count);
+	return state_ptr->worker_count > 0;
+}
+
+void job_system_shutdown(void *state) {
+	(void)state;
+	if (!state_ptr) { return; }
+
+	while (state_ptr->pending_count > 0) {
+		job_system_update();
+		if (state_ptr->pending_count > 0) { platform_sleep(1); }
+	}
+
+	atomic_store(&state_ptr->workers_running, false);
+	for (u32 i = 0; i < state_ptr->worker_count; ++i) { platform_semaphore_signal(&state_ptr->work_available); }
+	for (u32 i = 0; i < state_ptr->worker_count; ++i) { platform_thread_join(&state_ptr->workers[i]); }
+	platform_semaphore_destroy(&state_ptr->work_available);
+	state_ptr = 0;
+}
+
+void job_system_update() {
+	if (!state_ptr) { return; }
+
+	for (u32 i = 0; i < MAX_JOBS && state_ptr->pending_count > 0; ++i) {
+		job *finished = &state_ptr->jobs[i];
+		if (atomic_load_explicit(&finished->status, memory_order_acquire) != JOB_COMPLETE) { continue; }
+
+		// The completion may submit follow-up jobs, so it gets its own copy of the params and the slot is freed first.
+		u64 params[JOB_MAX_PARAMS_SIZE / sizeof(u64)];
+		scopy_memory(params, finished->params, sizeof(params));
+		PFN_job_complete on_complete = finished->on_complete;
+		b8 success                   = finished->success;
+		atomic_store_explicit(&finished->status, JOB_FREE, memory_order_relaxed);
+		state_ptr->pending_count--;
+
+		if (on_complete) { on_complete(success, params); }
+	}
+}
+
+b8 job_submit(PFN_job_start entry_point, PFN_job_complete on_complete, const void *params, u32 params_size) {
+	if (!state_ptr || !entry_point) { return false; }
+	if (params_size > JOB_MAX_PARAMS_SIZE) {
+		SERROR("job_submit - Params of %u bytes exceed JOB_MAX_PARAMS_SIZE.", params_size);
+		return false;
+	}
+
+	u32 index = MAX_JOBS;
+	for (u32 i = 0; i < MAX_JOBS; ++i) {
+		if (atomic_load_explicit(&state_ptr->jobs[i].status, memory_order_relaxed) == JOB_FREE) {
+			index = i;
+			break;
+		}
+	}
+	if (index == MAX_JOBS) {
+		SWARN("job_submit - Too many jobs in flight.");
+		return false;
+	}
+
+	job *queued         = &state_ptr->jobs[index];
+	queued->entry_point = entry_point;
+	queued->on_complete = on_complete;
+	queued->success     = false;
+	if (params_size > 0) { scopy_memory(queued->params, params, params_size); }
+	atomic_store_explicit(&queued->status, JOB_PENDING, memory_order_relaxed);
+	state_ptr->pending_count++;
+
+	state_ptr->queue[state_ptr->queue_head % MAX_JOBS] = index;
+	state_ptr->queue_head++;
+	// Posting the semaphore publishes the job to the worker that takes it.
+	platform_semaphore_signal(&state_ptr->work_available);
+	return true;
+}
@@ -0,0 +1,315 @@
+#include "log_format.h"
+
+#include "core/logger.h"
+#include "core/smemory.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define MAX_CONVERSION_LENGTH 64
+// Stored in place of a string length for null strings.
+#define NULL_STRING_LENGTH 0xFFFF
+
+typedef enum log_arg_type {
+	LOG_ARG_NONE,
+	LOG_ARG_INTEGER,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_POINTER,
+	LOG_ARG_STRING,
+	LOG_ARG_UNSUPPORTED,
+} log_arg_type;
+
+// One '%' conversion of a format string.
+typedef struct log_conversion {
+	const char *start;
+	const char *end;
+	log_arg_type type;
+	// 0, 'h' (h and hh), 'l', 'q' (ll), 'j', 'z', 't' or 'L'.
+	char length;
+	u8 star_count;
+} log_conversion;
+
+// Parses the conversion starting at the '%' at format.
+static const char *parse_conversion(const char *format, log_conversion *out) {
+	const char *p   = format + 1;
+	out->start      = format;
+	out->length     = 0;
+	out->star_count = 0;
+
+	while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') { p++; }
+	if (*p == '*') {
+		out->star_count++;
+		p++;
+	}
+	while (*p >= '0' && *p <= '9') { p++; }
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			out->star_count++;
+			p++;
+		}
+		while (*p >= '0' && *p <= '9') { p++; }
+	}
+
+	switch (*p) {
+		case 'h':
+			out->length = 'h';
+			p += p[1] == 'h' ? 2 : 1;
+			break;
+		case 'l':
+			out->length = p[1] == 'l' ? 'q' : 'l';
+			p += p[1] == 'l' ? 2 : 1;
+			break;
+		case 'j':
+		case 'z':
+		case 't':
+		case 'L':
+			out->length = *p++;
+			break;
+		default:
+			break;
+	}
+
+	switch (*p) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			out->type = out->length == 'L' ? LOG_ARG_UNSUPPORTED : LOG_ARG_INTEGER;
+			break;
+		case 'c':
+			out->type = out->length == 0 ? LOG_ARG_INTEGER : LOG_ARG_UNSUPPORTED;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			out->type = out->length == 0 || out->length == 'l' ? LOG_ARG_DOUBLE : LOG_ARG_UNSUPPORTED;
+			break;
+		case 'p':
+			out->type = LOG_ARG_POINTER;
+			break;
+		case 's':
+			out->type = out->length == 0 ? LOG_ARG_STRING : LOG_ARG_UNSUPPORTED;
+			break;
+		case '%':
+			out->type = LOG_ARG_NONE;
+			break;
+		default:
+			// Includes %n and a format ending in the middle of a conversion.
+			out->type = LOG_ARG_UNSUPPORTED;
+			return p;
+	}
+
+	out->end = p + 1;
+	return out->end;
+}
+
+// Integers without a length modifier are promoted to int, the rest are stored as 8 bytes.
+static u32 integer_size(char length) { return length == 0 || length == 'h' ? sizeof(i32) : sizeof(i64); }
+
+b8 log_encode_args(const char *format, va_list args, void *out_args, u32 capacity, u32 *out_size) {
+	u8 *out  = out_args;
+	u32 size = 0;
+
+	for (const char *p = format; *p;) {
+		if (*p != '%') {
+			p++;
+			continue;
+		}
+
+		log_conversion conversion;
+		p = parse_conversion(p, &conversion);
+		if (conversion.type == LOG_ARG_UNSUPPORTED) { return false; }
+
+		for (u8 i = 0; i < conversion.star_count; ++i) {
+			if (size + sizeof(i32) > capacity) { return false; }
+			i32 value = va_arg(args, i32);
+			scopy_memory(out + size, &value, sizeof(i32));
+			size += sizeof(i32);
+		}
+
+		switch (conversion.type) {
+			case LOG_ARG_INTEGER: {
+				u32 value_size = integer_size(conversion.length);
+				i64 value;
+				switch (conversion.length) {
+					case 'l':
+						value = va_arg(args, long);
+						break;
+					case 'q':
+						value = va_arg(args, long long);
+						break;
+					case 'j':
+						value = va_arg(args, intmax_t);
+						break;
+					case 'z':
+						value = (i64)va_arg(args, size_t);
+						break;
+					case 't':
+						value = va_arg(args, ptrdiff_t);
+						break;
+					default:
+						value = va_arg(args, i32);
+						break;
+				}
+				if (size + value_size > capacity) { return false; }
+				if (value_size == sizeof(i32)) {
+					i32 narrow = (i32)value;
+					scopy_memory(out + size, &narrow, sizeof(i32));
+				} else {
+					scopy_memory(out + size, &value, sizeof(i64));
+				}
+				size += value_size;
+			} break;
+			case LOG_ARG_DOUBLE: {
+				if (size + sizeof(f64) > capacity) { return false; }
+				f64 value = va_arg(args, f64);
+				scopy_memory(out + size, &value, sizeof(f64));
+				size += sizeof(f64);
+			} break;
+			case LOG_ARG_POINTER: {
+				if (size + sizeof(u64) > capacity) { return false; }
+				u64 value = (u64)(uintptr_t)va_arg(args, void *);
+				scopy_memory(out + size, &value, sizeof(u64));
+				size += sizeof(u64);
+			} break;
+			case LOG_ARG_STRING: {
+				if (size + sizeof(u16) > capacity) { return false; }
+				const char *value = va_arg(args, const char *);
+				u16 length        = NULL_STRING_LENGTH;
+				if (value) {
+					u32 available = capacity - size - (u32)sizeof(u16);
+					u32 n         = 0;
+					while (value[n] && n < available && n < NULL_STRING_LENGTH - 1) { n++; }
+					length = (u16)n;
+				}
+				scopy_memory(out + size, &length, sizeof(u16));
+				size += sizeof(u16);
+				if (value) {
+					scopy_memory(out + size, value, length);
+					size += length;
+				}
+			} break;
+			default:
+				break;
+		}
+	}
+
+	*out_size = size;
+	return true;
+}
+
+u32 log_format_binary(const char *format, const void *args, u32 args_size, char *out, u32 out_size) {
+	const u8 *in = args;
+	u32 read     = 0;
+	u32 written  = 0;
+	if (out_size == 0) { return 0; }
+
+	// Keeps written pointing at the terminator when output is truncated.
+#define APPEND(count)                                                                                                  \
+	do {                                                                                                               \
+		i32 appended = (count);                                                                                        \
+		if (appended > 0) { written = SMIN(written + (u32)appended, out_size - 1); }                                  \
+	} while (0)
+
+	for (const char *p = format; *p && written < out_size - 1;) {
+		if (*p != '%') {
+			out[written++] = *p++;
+			continue;
+		}
+
+		log_conversion conversion;
+		p = parse_conversion(p, &conversion);
+		if (conversion.type == LOG_ARG_UNSUPPORTED) { break; }
+
+		// Substitute '*' with the stored width/precision so the value is the only argument left.
+		char spec[MAX_CONVERSION_LENGTH];
+		u32 spec_length = 0;
+		for (const char *c = conversion.start; c < conversion.end && spec_length < MAX_CONVERSION_LENGTH - 12; ++c) {
+			if (*c != '*') {
+				spec[spec_length++] = *c;
+				continue;
+			}
+			i32 value = 0;
+			if (read + sizeof(i32) <= args_size) { scopy_memory(&value, in + read, sizeof(i32)); }
+			read += sizeof(i32);
+			spec_length += (u32)snprintf(spec + spec_length, MAX_CONVERSION_LENGTH - spec_length, "%d", value);
+		}
+		spec[spec_length] = 0;
+
+		char *dest      = out + written;
+		u64 dest_size   = out_size - written;
+		u32 value_size  = 0;
+		switch (conversion.type) {
+			case LOG_ARG_NONE:
+				APPEND(snprintf(dest, dest_size, "%%"));
+				break;
+			case LOG_ARG_INTEGER: {
+				value_size = integer_size(conversion.length);
+				if (read + value_size > args_size) { break; }
+				if (value_size == sizeof(i32)) {
+					i32 value;
+					scopy_memory(&value, in + read, sizeof(i32));
+					APPEND(snprintf(dest, dest_size, spec, value));
+				} else {
+					i64 value;
+					scopy_memory(&value, in + read, sizeof(i64));
+					if (conversion.length == 'l') {
+						APPEND(snprintf(dest, dest_size, spec, (long)value));
+					} else {
+						APPEND(snprintf(dest, dest_size, spec, (long long)value));
+					}
+				}
+			} break;
+			case LOG_ARG_DOUBLE: {
+				value_size = sizeof(f64);
+				if (read + value_size > args_size) { break; }
+				f64 value;
+				scopy_memory(&value, in + read, sizeof(f64));
+				APPEND(snprintf(dest, dest_size, spec, value));
+			} break;
+			case LOG_ARG_POINTER: {
+				value_size = sizeof(u64);
+				if (read + value_size > args_size) { break; }
+				u64 value;
+				scopy_memory(&value, in + read, sizeof(u64));
+				APPEND(snprintf(dest, dest_size, spec, (void *)(uintptr_t)value));
+			} break;
+			case LOG_ARG_STRING: {
+				if (read + sizeof(u16) > args_size) { break; }
+				u16 length;
+				scopy_memory(&length, in + read, sizeof(u16));
+				value_size = sizeof(u16);
+				if (length == NULL_STRING_LENGTH) {
+					APPEND(snprintf(dest, dest_size, spec, "(null)"));
+					break;
+				}
+				if (read + sizeof(u16) + length > args_size) { break; }
+				value_size += length;
+
+				// The stored string isn't terminated, copy it out so the conversion's width/precision still apply.
+				// Too large for the stack.
+				static _Thread_local char value[NULL_STRING_LENGTH];
+				scopy_memory(value, in + read + sizeof(u16), length);
+				value[length] = 0;
+				APPEND(snprintf(dest, dest_size, spec, value));
+			} break;
+			default:
+				break;
+		}
+		read += value_size;
+	}
+
+#undef APPEND
+
+	out[written] = 0;
+	return written;
+}
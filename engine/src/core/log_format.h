@@ -0,0 +1,12 @@
+#pragma once
+
+#include "defines.h"
+
+#include <stdarg.h>
+
+/**
+ * Packs the arguments referenced by a printf-style format string into out_args, without formatting them.
+ * Strings are copied, everything else is stored as raw bytes. Strings that don't fit are truncated.
+ * @returns false if the format uses a conversion that can't be deferred (%n, %Lf, %ls) or the arguments don't fit.
+ */
+b8 log_encode_args(const char *format, va_list args, void *out_args, u32 capacity, u32 *out_size);
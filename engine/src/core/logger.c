@@ -4,61 +4,230 @@
 #include "core/filesystem.h"
 #include "core/smemory.h"
 #include "core/sstring.h"
+#include "log_format.h"
 #include "platform/platform.h"
 
 // TODO: temporary
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
-// NOTE: ~32k character limit
-#define MESSAGE_LENGTH 32000
-#define LEVEL_STRING_MAX_LENGTH 12
-#define FORMAT_STING_LENGTH MESSAGE_LENGTH - LEVEL_STRING_MAX_LENGTH
+// Messages that fit in a ring slot. Longer ones spill into a buffer of their own, see log_slot.
+#define MESSAGE_LENGTH 1024
+// Number of messages that can be waiting for the writer thread. Must be a power of two.
+#define LOG_RING_SIZE 1024
+// Messages written to console.log per write call.
+#define FILE_BATCH_SIZE KIBIBYTES(64)
+// Format strings the writer remembers having written to console.slog. Must be a power of two.
+#define KNOWN_FORMAT_COUNT 1024
+
+// One message in the log ring. Producers format straight into the message buffer.
+typedef struct log_slot {
+	// Equal to the enqueue position when free, position + 1 once the message is published.
+	_Atomic u64 sequence;
+	log_level level;
+	// When set, message holds the arguments for format rather than text.
+	b8 binary;
+	u32 length;
+	const char *format;
+	f64 timestamp;
+	// Text too long for message, from platform_allocate. Freed by the writer.
+	char *spill;
+	char message[MESSAGE_LENGTH];
+} log_slot;
 
 typedef struct logger_system_state {
 	file_handle log_file_handle;
+
+	platform_thread writer_thread;
+	platform_semaphore writer_wake;
+	_Atomic b8 writer_running;
+	// Set when the writer has been signalled but hasn't started draining yet, saves a signal per message.
+	_Atomic b8 wake_pending;
+
+	// Claimed by producers, any thread.
+	_Atomic u64 enqueue_position;
+	u8 enqueue_padding[56];
+	// Owned by the writer thread.
+	u64 dequeue_position;
+	// Everything before this has been written out.
+	_Atomic u64 written_position;
+
+	log_slot slots[LOG_RING_SIZE];
+
+	u64 file_batch_length;
+	char file_batch[FILE_BATCH_SIZE];
+
+	// Opened on the first binary message.
+	file_handle binary_file_handle;
+	u64 binary_batch_length;
+	u8 binary_batch[FILE_BATCH_SIZE];
+	const char *known_formats[KNOWN_FORMAT_COUNT];
 } logger_system_state;
 
 static logger_system_state *state_ptr;
 
-void append_to_log_file(const char *message);
+static const char *level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
+static const char *level_names[6]   = {"fatal", "error", "warn", "info", "debug", "trace"};
+
+static const char *category_names[LOG_CATEGORY_MAX] = {"general", "renderer", "vulkan", "platform", "input", "game"};
+
+#if SPACE_RELEASE == 1
+	#define LOG_DEFAULT_LEVEL LOG_LEVEL_INFO
+#else
+	#define LOG_DEFAULT_LEVEL LOG_LEVEL_TRACE
+#endif
+
+// Not part of the system state, so logging sites can check it before the logger is initialized.
+u8 log_category_levels[LOG_CATEGORY_MAX] = {
+	LOG_DEFAULT_LEVEL,
+	LOG_DEFAULT_LEVEL,
+	LOG_DEFAULT_LEVEL,
+	LOG_DEFAULT_LEVEL,
+	LOG_DEFAULT_LEVEL,
+	LOG_DEFAULT_LEVEL,
+};
+
+static void append_to_log_file(const char *message, u64 length);
+static i32 find_name(const char *start, u64 length, const char **names, i32 name_count);
+static void log_output_v(log_level level, const char *message, va_list args);
+static log_slot *claim_slot(u64 *out_position);
+static void publish_slot(log_slot *slot, u64 position);
+static char *format_message(char *dest, log_level level, const char *message, va_list args, u32 *out_length);
+static void write_message(const char *message, u32 length, log_level level);
+static u32 writer_thread_run(void *params);
+static void writer_drain();
+static void writer_append_binary(const log_slot *slot);
 
 b8 logging_system_initialize(u64 *memory_requirement, void *state) {
 	*memory_requirement = sizeof(logger_system_state);
 	if (state == 0) { return true; }
 
-	state_ptr = state;
+	szero_memory(state, sizeof(logger_system_state));
+	logger_system_state *new_state = state;
 
-	if (!filesystem_open("console.log", FILE_MODE_WRITE, false, &state_ptr->log_file_handle)) {
+	if (!filesystem_open("console.log", FILE_MODE_WRITE, false, &new_state->log_file_handle)) {
 		platform_console_write_error("ERROR: Unable to open console.log for writing.", LOG_LEVEL_ERROR);
 		return false;
 	}
 
+	for (u64 i = 0; i < LOG_RING_SIZE; ++i) { atomic_init(&new_state->slots[i].sequence, i); }
+
+	if (!platform_semaphore_create(0, &new_state->writer_wake)) { return false; }
+
+	// Only publish the state once it is complete, the writer thread uses it right away.
+	state_ptr = new_state;
+	atomic_store(&state_ptr->writer_running, true);
+	if (!platform_thread_create(writer_thread_run, 0, &state_ptr->writer_thread)) {
+		platform_console_write_error("ERROR: Unable to start the log writer thread.", LOG_LEVEL_ERROR);
+		atomic_store(&state_ptr->writer_running, false);
+	}
+
 	return true;
 }
 
-void logging_shutdown() { filesystem_close(&state_ptr->log_file_handle); }
+void logging_shutdown() {
+	if (!state_ptr) { return; }
 
-void log_output(log_level level, const char *message, ...) {
-	const char *level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
-	b8 is_error                  = level < LOG_LEVEL_WARN;
+	if (atomic_exchange(&state_ptr->writer_running, false)) {
+		// The writer drains whatever is left before exiting.
+		platform_semaphore_signal(&state_ptr->writer_wake);
+		platform_thread_join(&state_ptr->writer_thread);
+	}
+	platform_semaphore_destroy(&state_ptr->writer_wake);
+
+	filesystem_close(&state_ptr->log_file_handle);
+	if (state_ptr->binary_file_handle.is_valid) { filesystem_close(&state_ptr->binary_file_handle); }
+	state_ptr = 0;
+}
+
+void logging_flush() {
+	if (!state_ptr || !atomic_load_explicit(&state_ptr->writer_running, memory_order_acquire)) { return; }
+
+	u64 target = atomic_load(&state_ptr->enqueue_position);
+	if (!atomic_exchange(&state_ptr->wake_pending, true)) { platform_semaphore_signal(&state_ptr->writer_wake); }
+	while (atomic_load_explicit(&state_ptr->written_position, memory_order_acquire) < target) { platform_sleep(0); }
+}
+
+void log_set_category_level(log_category category, log_level level) {
+	if (category >= LOG_CATEGORY_MAX) { return; }
+	log_category_levels[category] = (u8)level;
+}
+
+log_level log_get_category_level(log_category category) {
+	return category < LOG_CATEGORY_MAX ? (log_level)log_category_levels[category] : LOG_LEVEL_FATAL;
+}
+
+b8 log_set_category_levels(const char *levels) {
+	b8 success = true;
+
+	const char *entry = levels;
+	while (*entry) {
+		const char *end = entry;
+		while (*end && *end != ',') { end++; }
 
-	char out_message[MESSAGE_LENGTH];
-	szero_memory(out_message, sizeof(out_message));
+		const char *separator = entry;
+		while (separator < end && *separator != '=') { separator++; }
 
+		if (separator == end) {
+			// A bare level applies to everything.
+			i32 level = find_name(entry, (u64)(end - entry), level_names, 6);
+			if (level >= 0) {
+				for (u32 i = 0; i < LOG_CATEGORY_MAX; ++i) { log_category_levels[i] = (u8)level; }
+			} else {
+				success = false;
+			}
+		} else {
+			i32 category = find_name(entry, (u64)(separator - entry), category_names, LOG_CATEGORY_MAX);
+			i32 level    = find_name(separator + 1, (u64)(end - separator - 1), level_names, 6);
+			if (category >= 0 && level >= 0) {
+				log_category_levels[category] = (u8)level;
+			} else {
+				success = false;
+			}
+		}
+
+		entry = *end ? end + 1 : end;
+	}
+
+	return success;
+}
+
+void log_output(log_level level, const char *message, ...) {
 	va_list arg_ptr;
 	va_start(arg_ptr, message);
-	string_format_v(out_message, message, arg_ptr);
+	log_output_v(level, message, arg_ptr);
 	va_end(arg_ptr);
+}
 
-	string_format(out_message, "%s%s", level_strings[level], out_message);
+void log_output_binary(log_level level, const char *format, ...) {
+	va_list arg_ptr;
+	va_start(arg_ptr, format);
 
-	if (is_error) {
-		platform_console_write_error(out_message, (u8)level);
-	} else {
-		platform_console_write(out_message, (u8)level);
+	if (!state_ptr || level == LOG_LEVEL_FATAL
+		|| !atomic_load_explicit(&state_ptr->writer_running, memory_order_relaxed)) {
+		log_output_v(level, format, arg_ptr);
+		va_end(arg_ptr);
+		return;
 	}
 
-	append_to_log_file(out_message);
+	u64 position    = 0;
+	log_slot *slot  = claim_slot(&position);
+	slot->level     = level;
+	slot->format    = format;
+	slot->timestamp = platform_get_absolute_time();
+
+	va_list encode_args;
+	va_copy(encode_args, arg_ptr);
+	slot->binary = log_encode_args(format, encode_args, slot->message, MESSAGE_LENGTH, &slot->length);
+	va_end(encode_args);
+
+	// Formats that can't be deferred are written as text instead.
+	slot->spill = 0;
+	if (!slot->binary) { slot->spill = format_message(slot->message, level, format, arg_ptr, &slot->length); }
+	va_end(arg_ptr);
+
+	publish_slot(slot, position);
 }
 
 void report_assertion_failure(const char *expression, const char *message, const char *file, i32 line) {
@@ -70,12 +239,253 @@ void report_assertion_failure(const char *expression, const char *message, const
 			   line);
 }
 
-void append_to_log_file(const char *message) {
+static void append_to_log_file(const char *message, u64 length) {
 	if (state_ptr && state_ptr->log_file_handle.is_valid) {
-		u64 length  = string_length(message);
 		u64 written = 0;
 		if (!filesystem_write(&state_ptr->log_file_handle, length, message, &written)) {
 			platform_console_write_error("Error: failed to write to console.log.", LOG_LEVEL_ERROR);
 		}
 	}
 }
+
+static i32 find_name(const char *start, u64 length, const char **names, i32 name_count) {
+	for (i32 i = 0; i < name_count; ++i) {
+		if (string_length(names[i]) != length) { continue; }
+
+		u64 c = 0;
+		while (c < length && start[c] == names[i][c]) { c++; }
+		if (c == length) { return i; }
+	}
+	return -1;
+}
+
+static void log_output_v(log_level level, const char *message, va_list args) {
+	// Fatal messages are written right away, the application is likely about to go down.
+	if (!state_ptr || level == LOG_LEVEL_FATAL
+		|| !atomic_load_explicit(&state_ptr->writer_running, memory_order_relaxed)) {
+		logging_flush();
+
+		char out_message[MESSAGE_LENGTH + 1];
+		u32 length  = 0;
+		char *spill = format_message(out_message, level, message, args, &length);
+		char *text  = spill ? spill : out_message;
+
+		write_message(text, length, level);
+		text[length] = '\n';
+		append_to_log_file(text, length + 1);
+		if (spill) { platform_free(spill, false); }
+		return;
+	}
+
+	// Format straight into the slot.
+	u64 position   = 0;
+	log_slot *slot = claim_slot(&position);
+	slot->binary   = false;
+	slot->level    = level;
+	slot->spill    = format_message(slot->message, level, message, args, &slot->length);
+	publish_slot(slot, position);
+}
+
+static log_slot *claim_slot(u64 *out_position) {
+	u64 position = atomic_load_explicit(&state_ptr->enqueue_position, memory_order_relaxed);
+	while (true) {
+		log_slot *slot = &state_ptr->slots[position & (LOG_RING_SIZE - 1)];
+		u64 seq        = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+		i64 delta      = (i64)(seq - position);
+		if (delta == 0) {
+			if (atomic_compare_exchange_weak_explicit(&state_ptr->enqueue_position,
+													  &position,
+													  position + 1,
+													  memory_order_relaxed,
+													  memory_order_relaxed)) {
+				*out_position = position;
+				return slot;
+			}
+		} else if (delta < 0) {
+			// Full, the writer can't keep up. Wait for it rather than dropping the message.
+			if (!atomic_exchange(&state_ptr->wake_pending, true)) {
+				platform_semaphore_signal(&state_ptr->writer_wake);
+			}
+			platform_sleep(0);
+			position = atomic_load_explicit(&state_ptr->enqueue_position, memory_order_relaxed);
+		} else {
+			position = atomic_load_explicit(&state_ptr->enqueue_position, memory_order_relaxed);
+		}
+	}
+}
+
+static void publish_slot(log_slot *slot, u64 position) {
+	atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+	if (!atomic_exchange(&state_ptr->wake_pending, true)) { platform_semaphore_signal(&state_ptr->writer_wake); }
+}
+
+/**
+ * Formats into dest, which holds MESSAGE_LENGTH characters. Messages that don't fit are formatted again into a
+ * buffer from platform_allocate, with room for a newline after the terminator's position.
+ * @returns That buffer, 0 if dest was large enough.
+ */
+static char *format_message(char *dest, log_level level, const char *message, va_list args, u32 *out_length) {
+	va_list spill_args;
+	va_copy(spill_args, args);
+
+	u64 prefix_length = string_length(level_strings[level]);
+	scopy_memory(dest, level_strings[level], prefix_length);
+
+	i32 written = string_format_n_v(dest + prefix_length, MESSAGE_LENGTH - prefix_length, message, args);
+	if (written < 0) { written = 0; }
+
+	u64 length  = prefix_length + (u64)written;
+	char *spill = 0;
+	if (length >= MESSAGE_LENGTH) {
+		spill = platform_allocate(length + 2, false);
+		scopy_memory(spill, level_strings[level], prefix_length);
+		string_format_n_v(spill + prefix_length, (u64)written + 1, message, spill_args);
+	}
+	va_end(spill_args);
+
+	*out_length = (u32)length;
+	return spill;
+}
+
+static void write_message(const char *message, u32 length, log_level level) {
+	(void)length;
+
+	if (level < LOG_LEVEL_WARN) {
+		platform_console_write_error(message, (u8)level);
+	} else {
+		platform_console_write(message, (u8)level);
+	}
+}
+
+static u32 writer_thread_run(void *params) {
+	(void)params;
+
+	while (atomic_load_explicit(&state_ptr->writer_running, memory_order_acquire)) {
+		platform_semaphore_wait(&state_ptr->writer_wake);
+		writer_drain();
+	}
+
+	// Anything logged while shutting down.
+	writer_drain();
+	return 0;
+}
+
+static void writer_drain() {
+	// Anything published from now on needs a new signal.
+	atomic_store(&state_ptr->wake_pending, false);
+
+	while (true) {
+		log_slot *slot = &state_ptr->slots[state_ptr->dequeue_position & (LOG_RING_SIZE - 1)];
+		u64 seq        = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+		if (seq != state_ptr->dequeue_position + 1) {
+			// Empty, or the next message is still being formatted.
+			break;
+		}
+
+		if (slot->binary) {
+			writer_append_binary(slot);
+			atomic_store_explicit(&slot->sequence, state_ptr->dequeue_position + LOG_RING_SIZE, memory_order_release);
+			state_ptr->dequeue_position++;
+			continue;
+		}
+
+		char *text = slot->spill ? slot->spill : slot->message;
+		write_message(text, slot->length, slot->level);
+
+		// Batch file writes, console.log is only touched once per drain.
+		if (state_ptr->file_batch_length + slot->length + 1 > FILE_BATCH_SIZE) {
+			append_to_log_file(state_ptr->file_batch, state_ptr->file_batch_length);
+			state_ptr->file_batch_length = 0;
+		}
+		if (slot->length + 1 > FILE_BATCH_SIZE) {
+			// Larger than a whole batch, written on its own.
+			text[slot->length] = '\n';
+			append_to_log_file(text, slot->length + 1);
+		} else {
+			scopy_memory(state_ptr->file_batch + state_ptr->file_batch_length, text, slot->length);
+			state_ptr->file_batch_length += slot->length;
+			state_ptr->file_batch[state_ptr->file_batch_length++] = '\n';
+		}
+		if (slot->spill) {
+			platform_free(slot->spill, false);
+			slot->spill = 0;
+		}
+
+		// Hand the slot back to the producers.
+		atomic_store_explicit(&slot->sequence, state_ptr->dequeue_position + LOG_RING_SIZE, memory_order_release);
+		state_ptr->dequeue_position++;
+	}
+
+	if (state_ptr->file_batch_length > 0) {
+		append_to_log_file(state_ptr->file_batch, state_ptr->file_batch_length);
+		state_ptr->file_batch_length = 0;
+	}
+	if (state_ptr->binary_batch_length > 0) {
+		u64 written = 0;
+		filesystem_write(&state_ptr->binary_file_handle,
+						 state_ptr->binary_batch_length,
+						 state_ptr->binary_batch,
+						 &written);
+		state_ptr->binary_batch_length = 0;
+	}
+
+	atomic_store_explicit(&state_ptr->written_position, state_ptr->dequeue_position, memory_order_release);
+}
+
+static void binary_batch_push(const void *data, u64 size) {
+	if (state_ptr->binary_batch_length + size > FILE_BATCH_SIZE) {
+		u64 written = 0;
+		filesystem_write(&state_ptr->binary_file_handle,
+						 state_ptr->binary_batch_length,
+						 state_ptr->binary_batch,
+						 &written);
+		state_ptr->binary_batch_length = 0;
+	}
+	scopy_memory(state_ptr->binary_batch + state_ptr->binary_batch_length, data, size);
+	state_ptr->binary_batch_length += size;
+}
+
+// Returns true the first time a format string is seen. If the table fills up, formats are simply repeated.
+static b8 remember_format(const char *format) {
+	u64 hash = ((u64)(uintptr_t)format >> 3) * 0x9E3779B97F4A7C15ULL;
+	for (u64 i = 0; i < KNOWN_FORMAT_COUNT; ++i) {
+		const char **entry = &state_ptr->known_formats[(hash + i) & (KNOWN_FORMAT_COUNT - 1)];
+		if (*entry == format) { return false; }
+		if (*entry == 0) {
+			*entry = format;
+			return true;
+		}
+	}
+	return true;
+}
+
+static void writer_append_binary(const log_slot *slot) {
+	if (!state_ptr->binary_file_handle.is_valid) {
+		if (!filesystem_open("console.slog", FILE_MODE_WRITE, true, &state_ptr->binary_file_handle)) {
+			platform_console_write_error("ERROR: Unable to open console.slog for writing.", LOG_LEVEL_ERROR);
+			return;
+		}
+		log_binary_header header = {.magic = LOG_BINARY_MAGIC, .version = LOG_BINARY_VERSION};
+		binary_batch_push(&header, sizeof(header));
+	}
+
+	u64 id = (u64)(uintptr_t)slot->format;
+	if (remember_format(slot->format)) {
+		u8 type    = LOG_BINARY_RECORD_FORMAT;
+		u16 length = (u16)SMIN(string_length(slot->format), 0xFFFF);
+		binary_batch_push(&type, sizeof(type));
+		binary_batch_push(&id, sizeof(id));
+		binary_batch_push(&length, sizeof(length));
+		binary_batch_push(slot->format, length);
+	}
+
+	u8 type       = LOG_BINARY_RECORD_MESSAGE;
+	u8 level      = (u8)slot->level;
+	u16 args_size = (u16)slot->length;
+	binary_batch_push(&type, sizeof(type));
+	binary_batch_push(&level, sizeof(level));
+	binary_batch_push(&id, sizeof(id));
+	binary_batch_push(&slot->timestamp, sizeof(slot->timestamp));
+	binary_batch_push(&args_size, sizeof(args_size));
+	binary_batch_push(slot->message, args_size);
+}
@@ -0,0 +1,250 @@
+#include "core/lz.h"
+
+#include <string.h>
+
+// The LZ4 block format: a token with 4 bits of literal length and 4 bits of match length, extended by bytes of
+// 255 while saturated, the literals, then a 2 byte offset back into the output.
+#define LZ_MIN_MATCH 4
+// Matches start at least this far from the end of a block and the last bytes are always literals.
+#define LZ_MATCH_START_LIMIT 12
+#define LZ_LAST_LITERALS 5
+#define LZ_HASH_BITS 14
+
+static u32 read32(const u8 *p) {
+	u32 value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static u64 read64(const u8 *p) {
+	u64 value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+#if defined(_MSC_VER) && !defined(__clang__)
+	#include <intrin.h>
+static u32 first_set_bit64(u64 mask) {
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return (u32)index;
+}
+#else
+static u32 first_set_bit64(u64 mask) { return (u32)__builtin_ctzll(mask); }
+#endif
+
+static u32 hash32(u32 sequence) { return (sequence * 2654435761U) >> (32 - LZ_HASH_BITS); }
+
+// Writes the part of a length that didn't fit into its token nibble.
+static b8 write_length(u8 **op, const u8 *oend, u64 length) {
+	length -= 15;
+	while (length >= 255) {
+		if (*op >= oend) { return false; }
+		*(*op)++ = 255;
+		length -= 255;
+	}
+	if (*op >= oend) { return false; }
+	*(*op)++ = (u8)length;
+	return true;
+}
+
+// A match_length of 0 writes only the literals, which is how every block ends.
+static b8 write_sequence(u8 **op,
+						 const u8 *oend,
+						 const u8 *literals,
+						 u64 literal_length,
+						 u64 offset,
+						 u64 match_length) {
+	if (*op >= oend) { return false; }
+	u8 *token       = (*op)++;
+	u64 match_extra = match_length ? match_length - LZ_MIN_MATCH : 0;
+	*token          = (u8)((SMIN(literal_length, 15) << 4) | SMIN(match_extra, 15));
+
+	if (literal_length >= 15 && !write_length(op, oend, literal_length)) { return false; }
+	if ((u64)(oend - *op) < literal_length) { return false; }
+	memcpy(*op, literals, literal_length);
+	*op += literal_length;
+
+	if (match_length == 0) { return true; }
+	if (oend - *op < 2) { return false; }
+	*(*op)++ = (u8)offset;
+	*(*op)++ = (u8)(offset >> 8);
+	return match_extra < 15 || write_length(op, oend, match_extra);
+}
+
+u64 lz_compress_block(const void *src, u64 size, void *dst, u64 dst_capacity) {
+	// Positions are kept as u16, which also keeps every offset within range.
+	if (size > LZ_BLOCK_SIZE) { return 0; }
+
+	const u8 *in   = src;
+	u8 *op         = dst;
+	const u8 *oend = op + dst_capacity;
+	u64 anchor     = 0;
+
+	if (size > LZ_MATCH_START_LIMIT) {
+		u16 table[1 << LZ_HASH_BITS];
+		memset(table, 0, sizeof(table));
+
+		u64 match_start_limit = size - LZ_MATCH_START_LIMIT;
+		u64 match_limit       = size - LZ_LAST_LITERALS;
+		u64 ip                = 1;
+		while (ip < match_start_limit) {
+			u32 sequence = read32(in + ip);
+			u32 hash     = hash32(sequence);
+			u64 ref      = table[hash];
+			table[hash]  = (u16)ip;
+
+			if (ref >= ip || read32(in + ref) != sequence) {
+				// Step faster through data that keeps failing to match.
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			while (ip > anchor && ref > 0 && in[ip - 1] == in[ref - 1]) {
+				ip--;
+				ref--;
+			}
+
+			u64 length = LZ_MIN_MATCH;
+			while (ip + length + sizeof(u64) <= match_limit) {
+				u64 difference = read64(in + ip + length) ^ read64(in + ref + length);
+				if (difference) {
+					length += first_set_bit64(difference) >> 3;
+					goto match_found;
+				}
+				length += sizeof(u64);
+			}
+			while (ip + length < match_limit && in[ip + length] == in[ref + length]) { length++; }
+		match_found:
+
+			if (!write_sequence(&op, oend, in + anchor, ip - anchor, ip - ref, length)) { return 0; }
+			ip += length;
+			anchor = ip;
+
+			// The match skipped some positions, remember one so runs of matches chain.
+			if (ip < match_start_limit) { table[hash32(read32(in + ip - 2))] = (u16)(ip - 2); }
+		}
+	}
+
+	if (!write_sequence(&op, oend, in + anchor, size - anchor, 0, 0)) { return 0; }
+	return (u64)(op - (u8 *)dst);
+}
+
+// Reads the extension of a saturated length.
+static b8 read_length(const u8 **ip, const u8 *iend, u64 *length) {
+	u8 byte;
+	do {
+		if (*ip >= iend) { return false; }
+		byte = *(*ip)++;
+		*length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+b8 lz_decompress_block(const void *src, u64 src_size, void *dst, u64 dst_size) {
+	const u8 *ip   = src;
+	const u8 *iend = ip + src_size;
+	u8 *op         = dst;
+	u8 *oend       = op + dst_size;
+
+	while (ip < iend) {
+		u8 token           = *ip++;
+		u64 literal_length = token >> 4;
+		if (literal_length == 15 && !read_length(&ip, iend, &literal_length)) { return false; }
+		if (literal_length > (u64)(iend - ip) || literal_length > (u64)(oend - op)) { return false; }
+
+		// Short literal runs are copied in whole 16 byte chunks when both buffers have room past them.
+		if (literal_length <= 32 && iend - ip >= 32 && oend - op >= 32) {
+			memcpy(op, ip, 16);
+			memcpy(op + 16, ip + 16, 16);
+		} else {
+			memcpy(op, ip, literal_length);
+		}
+		ip += literal_length;
+		op += literal_length;
+
+		// The last sequence has no match.
+		if (ip == iend) { break; }
+
+		if (iend - ip < 2) { return false; }
+		u64 offset = (u64)ip[0] | ((u64)ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (u64)(op - (u8 *)dst)) { return false; }
+
+		u64 match_length = token & 15;
+		if (match_length == 15 && !read_length(&ip, iend, &match_length)) { return false; }
+		match_length += LZ_MIN_MATCH;
+		if (match_length > (u64)(oend - op)) { return false; }
+
+		// Chunked copies only read bytes that are already written as long as the offset is at least a chunk.
+		const u8 *match = op - offset;
+		if (offset >= 16 && (u64)(oend - op) >= match_length + 15) {
+			memcpy(op, match, 16);
+			for (u64 i = 16; i < match_length; i += 16) { memcpy(op + i, match + i, 16); }
+		} else if (offset >= 8 && (u64)(oend - op) >= match_length + 7) {
+			for (u64 i = 0; i < match_length; i += 8) { memcpy(op + i, match + i, 8); }
+		} else {
+			for (u64 i = 0; i < match_length; ++i) { op[i] = match[i]; }
+		}
+		op += match_length;
+	}
+
+	return op == oend;
+}
+
+u64 lz_compress_bound(u64 size) { return size + (size + LZ_BLOCK_SIZE - 1) / LZ_BLOCK_SIZE * sizeof(u32); }
+
+u64 lz_compress(const void *src, u64 size, void *dst, u64 dst_capacity) {
+	const u8 *in = src;
+	u8 *out      = dst;
+	u64 written  = 0;
+
+	for (u64 offset = 0; offset < size; offset += LZ_BLOCK_SIZE) {
+		u64 block_size = SMIN(LZ_BLOCK_SIZE, size - offset);
+		if (dst_capacity - written < sizeof(u32)) { return 0; }
+		u8 *block_data = out + written + sizeof(u32);
+		u64 available  = dst_capacity - written - sizeof(u32);
+
+		// Only keep the compressed block when it's smaller, otherwise store it as is.
+		u64 stored = lz_compress_block(in + offset, block_size, block_data, SMIN(available, block_size - 1));
+		u32 header = (u32)stored;
+		if (stored == 0) {
+			if (available < block_size) { return 0; }
+			memcpy(block_data, in + offset, block_size);
+			stored = block_size;
+			header = (u32)block_size | LZ_BLOCK_UNCOMPRESSED;
+		}
+
+		memcpy(out + written, &header, sizeof(header));
+		written += sizeof(u32) + stored;
+	}
+
+	return written;
+}
+
+b8 lz_decompress(const void *src, u64 src_size, void *dst, u64 dst_size) {
+	const u8 *in = src;
+	u8 *out      = dst;
+	u64 read     = 0;
+
+	for (u64 offset = 0; offset < dst_size; offset += LZ_BLOCK_SIZE) {
+		u64 block_size = SMIN(LZ_BLOCK_SIZE, dst_size - offset);
+		if (src_size - read < sizeof(u32)) { return false; }
+
+		u32 header;
+		memcpy(&header, in + read, sizeof(header));
+		read += sizeof(u32);
+		u64 stored = header & ~LZ_BLOCK_UNCOMPRESSED;
+		if (stored > src_size - read) { return false; }
+
+		if (header & LZ_BLOCK_UNCOMPRESSED) {
+			if (stored != block_size) { return false; }
+			memcpy(out + offset, in + read, block_size);
+		} else if (!lz_decompress_block(in + read, stored, out + offset, block_size)) {
+			return false;
+		}
+		read += stored;
+	}
+
+	return read == src_size;
+}
@@ -4,9 +4,6 @@
 #include "core/sstring.h"
 #include "platform/platform.h"
 
-// TODO: Custom string lib
-#include <stdio.h>
-
 #define USAGE_STRING_BUFFER_SIZE 8000
 
 struct memory_stats {
@@ -31,8 +28,9 @@ static const char *memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
 	"TRANSFORM",
 	"ENTITY",
 	"ENTITY_NODE",
-	"LINEAR_ALLOCATOR",
 	"SCENE",
+	"LINEAR_ALLOCATOR",
+	"RESOURCE",
 };
 
 typedef struct memory_system_state {
@@ -123,14 +121,14 @@ char *get_memory_usage_string() {
 			amount  = (f32)state_ptr->stats.tagged_allocations[i];
 		}
 
-		i32 length = snprintf(buffer + offset,
-							  USAGE_STRING_BUFFER_SIZE,
-							  "  %-*s: %.2f%s\n",
-							  (i32)longest_memory_tag_string,
-							  memory_tag_strings[i],
-							  amount,
-							  unit);
-		offset += (u64)length;
+		i32 length = string_format_n(buffer + offset,
+									 USAGE_STRING_BUFFER_SIZE - offset,
+									 "  %-*s: %.2f%s\n",
+									 (i32)longest_memory_tag_string,
+									 memory_tag_strings[i],
+									 amount,
+									 unit);
+		if (length > 0) { offset = SMIN(offset + (u64)length, USAGE_STRING_BUFFER_SIZE - 1); }
 	}
 	char *out_string = string_duplicate(buffer);
 	return out_string;
@@ -1,12 +1,165 @@
 #include "core/sstring.h"
 
 #include "core/smemory.h"
+#include "memory/linear_allocator.h"
 
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-u64 string_length(const char *str) { return strlen(str); }
+#if defined(__SSE2__) || defined(_M_X64)
+	#define STRING_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+// AVX2 versions are compiled with a target attribute and picked at runtime, the engine itself targets SSE2.
+#if defined(STRING_SSE2) && (defined(__GNUC__) || defined(__clang__))
+	#define STRING_AVX2 1
+	#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+	// Vector loads are aligned or checked against page boundaries, but may still read past the terminator.
+	#define STRING_NO_SANITIZE __attribute__((no_sanitize_address))
+#else
+	#define STRING_NO_SANITIZE
+#endif
+
+#define STRING_PAGE_SIZE 4096
+
+// Upper bound string_format assumes for dest, kept from when it formatted into a stack buffer first.
+#define STRING_FORMAT_MAX_LENGTH 32000
+
+static char empty_string[1];
+
+#if defined(STRING_SSE2)
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+static u32 first_set_bit(u32 mask) {
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (u32)index;
+}
+	#else
+static u32 first_set_bit(u32 mask) { return (u32)__builtin_ctz(mask); }
+	#endif
+
+// True if reading width bytes from p could touch the next page.
+static b8 crosses_page(const char *p, u64 width) {
+	return ((uintptr_t)p & (STRING_PAGE_SIZE - 1)) > STRING_PAGE_SIZE - width;
+}
+
+STRING_NO_SANITIZE static u64 string_length_sse2(const char *str) {
+	// Aligned loads never cross into the next page.
+	const char *block = (const char *)((uintptr_t)str & ~(uintptr_t)15);
+	const __m128i zero = _mm_setzero_si128();
+
+	u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)block), zero));
+	mask >>= (u32)(str - block);
+	if (mask) { return first_set_bit(mask); }
+
+	while (true) {
+		block += 16;
+		mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)block), zero));
+		if (mask) { return (u64)(block - str) + first_set_bit(mask); }
+	}
+}
+
+// Compares until the first difference or terminator. With prefix set, only str1's terminator counts and
+// reaching it means str0 starts with str1. Otherwise returns true if both strings end together.
+STRING_NO_SANITIZE static b8 string_compare_sse2(const char *str0, const char *str1, b8 prefix) {
+	const __m128i zero = _mm_setzero_si128();
+
+	for (u64 i = 0;; i += 16) {
+		if (crosses_page(str0 + i, 16) || crosses_page(str1 + i, 16)) {
+			for (u64 limit = i + 16; i < limit; ++i) {
+				if (prefix && str1[i] == 0) { return true; }
+				if (str0[i] != str1[i]) { return false; }
+				if (str0[i] == 0) { return true; }
+			}
+			i -= 16;
+			continue;
+		}
+
+		__m128i block0 = _mm_loadu_si128((const __m128i *)(str0 + i));
+		__m128i block1 = _mm_loadu_si128((const __m128i *)(str1 + i));
+		u32 diff       = ~(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(block0, block1)) & 0xFFFF;
+		u32 end        = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(prefix ? block1 : block0, zero));
+		u32 stop       = diff | end;
+		if (stop) {
+			u32 bit = stop & (~stop + 1);
+			return prefix ? (end & bit) != 0 : (diff & bit) == 0;
+		}
+	}
+}
+#endif
+
+#if defined(STRING_AVX2)
+static b8 avx2_supported() {
+	static i32 supported = -1;
+	if (supported < 0) {
+		__builtin_cpu_init();
+		supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return supported == 1;
+}
+
+STRING_NO_SANITIZE __attribute__((target("avx2"))) static u64 string_length_avx2(const char *str) {
+	const char *block  = (const char *)((uintptr_t)str & ~(uintptr_t)31);
+	const __m256i zero = _mm256_setzero_si256();
+
+	u32 mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)block), zero));
+	mask >>= (u32)(str - block);
+	if (mask) { return first_set_bit(mask); }
+
+	while (true) {
+		block += 32;
+		mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)block), zero));
+		if (mask) { return (u64)(block - str) + first_set_bit(mask); }
+	}
+}
+
+STRING_NO_SANITIZE __attribute__((target("avx2"))) static b8 string_compare_avx2(const char *str0,
+																				 const char *str1,
+																				 b8 prefix) {
+	const __m256i zero = _mm256_setzero_si256();
+
+	for (u64 i = 0;; i += 32) {
+		if (crosses_page(str0 + i, 32) || crosses_page(str1 + i, 32)) {
+			for (u64 limit = i + 32; i < limit; ++i) {
+				if (prefix && str1[i] == 0) { return true; }
+				if (str0[i] != str1[i]) { return false; }
+				if (str0[i] == 0) { return true; }
+			}
+			i -= 32;
+			continue;
+		}
+
+		__m256i block0 = _mm256_loadu_si256((const __m256i *)(str0 + i));
+		__m256i block1 = _mm256_loadu_si256((const __m256i *)(str1 + i));
+		u32 diff       = ~(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block0, block1));
+		u32 end        = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(prefix ? block1 : block0, zero));
+		u32 stop       = diff | end;
+		if (stop) {
+			u32 bit = stop & (~stop + 1);
+			return prefix ? (end & bit) != 0 : (diff & bit) == 0;
+		}
+	}
+}
+#endif
+
+u64 string_length(const char *str) {
+#if defined(STRING_AVX2)
+	if (avx2_supported()) { return string_length_avx2(str); }
+#endif
+#if defined(STRING_SSE2)
+	return string_length_sse2(str);
+#else
+	return strlen(str);
+#endif
+}
 
 char *string_duplicate(const char *str) {
 	u64 length = string_length(str);
@@ -15,7 +168,53 @@ char *string_duplicate(const char *str) {
 	return copy;
 }
 
-b8 string_equal(const char *str0, const char *str1) { return strcmp(str0, str1) == 0; }
+b8 string_equal(const char *str0, const char *str1) {
+#if defined(STRING_AVX2)
+	if (avx2_supported()) { return string_compare_avx2(str0, str1, false); }
+#endif
+#if defined(STRING_SSE2)
+	return string_compare_sse2(str0, str1, false);
+#else
+	return strcmp(str0, str1) == 0;
+#endif
+}
+
+b8 string_starts_with(const char *str, const char *prefix) {
+#if defined(STRING_AVX2)
+	if (avx2_supported()) { return string_compare_avx2(str, prefix, true); }
+#endif
+#if defined(STRING_SSE2)
+	return string_compare_sse2(str, prefix, true);
+#else
+	return strncmp(str, prefix, strlen(prefix)) == 0;
+#endif
+}
+
+// Must match STRING_HASH_LITERAL.
+static u64 string_hash_step(u64 hash, u64 word) { return (hash ^ word ^ (word >> 32)) * STRING_HASH_MULTIPLIER; }
+
+u64 string_hash_n(const void *data, u64 length) {
+	const u8 *bytes = data;
+	u64 hash        = STRING_HASH_SEED ^ (length * STRING_HASH_MULTIPLIER);
+
+	// NOTE: Words are read in native order, which matches STRING_HASH_LITERAL on little-endian targets.
+	u64 i = 0;
+	for (; i + 8 <= length; i += 8) {
+		u64 word;
+		memcpy(&word, bytes + i, sizeof(word));
+		hash = string_hash_step(hash, word);
+	}
+	if (i < length) {
+		u64 word = 0;
+		memcpy(&word, bytes + i, length - i);
+		hash = string_hash_step(hash, word);
+	}
+
+	hash = (hash ^ (hash >> 32)) * STRING_HASH_FINISH_MULTIPLIER;
+	return hash ^ (hash >> 29);
+}
+
+u64 string_hash(const char *str) { return string_hash_n(str, string_length(str)); }
 
 i32 string_format(char *dest, const char *format, ...) {
 	if (dest) {
@@ -29,13 +228,149 @@ i32 string_format(char *dest, const char *format, ...) {
 }
 
 i32 string_format_v(char *dest, const char *format, void *va_listp) {
-	if (dest) {
-		char buffer[32000];
-		i32 written     = vsnprintf(buffer, 32000, format, va_listp);
-		buffer[written] = 0;
-		scopy_memory(dest, buffer, (u64)(written + 1));
+	if (dest) { return vsnprintf(dest, STRING_FORMAT_MAX_LENGTH, format, va_listp); }
+	return -1;
+}
 
-		return written;
+i32 string_format_n(char *dest, u64 dest_size, const char *format, ...) {
+	va_list arg_ptr;
+	va_start(arg_ptr, format);
+	i32 written = string_format_n_v(dest, dest_size, format, arg_ptr);
+	va_end(arg_ptr);
+	return written;
+}
+
+i32 string_format_n_v(char *dest, u64 dest_size, const char *format, void *va_listp) {
+	if (!dest || dest_size == 0) { return -1; }
+	return vsnprintf(dest, dest_size, format, va_listp);
+}
+
+string_view string_view_create(const char *str) {
+	string_view view = {.data = str, .length = str ? string_length(str) : 0};
+	return view;
+}
+
+string_view string_view_substring(string_view view, u64 start, u64 length) {
+	start              = SMIN(start, view.length);
+	string_view result = {.data = view.data + start, .length = SMIN(length, view.length - start)};
+	return result;
+}
+
+b8 string_view_equal(string_view view0, string_view view1) {
+	if (view0.length != view1.length) { return false; }
+	return view0.length == 0 || memcmp(view0.data, view1.data, view0.length) == 0;
+}
+
+b8 string_view_to_f64(string_view view, f64 *out_value) {
+	// strtod needs a terminated string, numbers longer than this aren't worth supporting.
+	char buffer[64];
+	if (view.length == 0 || view.length >= sizeof(buffer)) { return false; }
+	memcpy(buffer, view.data, view.length);
+	buffer[view.length] = '\0';
+
+	char *end  = 0;
+	*out_value = strtod(buffer, &end);
+	return end == buffer + view.length;
+}
+
+// True if nothing has been allocated after the builder's string, so it can grow in place.
+static b8 builder_is_on_top(const string_builder *builder) {
+	linear_allocator *allocator = builder->allocator;
+	return builder->data + builder->length + 1 == (char *)allocator->memory + allocator->allocated;
+}
+
+// Makes room for extra more characters after the current string.
+static b8 builder_reserve(string_builder *builder, u64 extra) {
+	if (builder->overflowed) { return false; }
+
+	linear_allocator *allocator = builder->allocator;
+	if (builder_is_on_top(builder)) {
+		if (allocator->total_size - allocator->allocated < extra) {
+			builder->overflowed = true;
+			return false;
+		}
+		linear_allocator_allocate(allocator, extra);
+		return true;
 	}
-	return -1;
+
+	// Something else was allocated since, move the string to the top.
+	char *data = linear_allocator_allocate(allocator, builder->length + extra + 1);
+	if (!data) {
+		builder->overflowed = true;
+		return false;
+	}
+	scopy_memory(data, builder->data, builder->length + 1);
+	builder->data = data;
+	return true;
+}
+
+void string_builder_begin(linear_allocator *allocator, string_builder *out_builder) {
+	out_builder->allocator  = allocator;
+	out_builder->length     = 0;
+	out_builder->overflowed = false;
+	out_builder->data       = linear_allocator_allocate(allocator, 1);
+	if (!out_builder->data) {
+		out_builder->data       = empty_string;
+		out_builder->overflowed = true;
+		return;
+	}
+	out_builder->data[0] = 0;
+}
+
+b8 string_builder_append(string_builder *builder, string_view text) {
+	if (!builder_reserve(builder, text.length)) { return false; }
+
+	scopy_memory(builder->data + builder->length, text.data, text.length);
+	builder->length += text.length;
+	builder->data[builder->length] = 0;
+	return true;
+}
+
+b8 string_builder_append_cstr(string_builder *builder, const char *text) {
+	return string_builder_append(builder, string_view_create(text));
+}
+
+b8 string_builder_append_format(string_builder *builder, const char *format, ...) {
+	if (builder->overflowed) { return false; }
+
+	va_list arg_ptr;
+	va_start(arg_ptr, format);
+
+	if (builder_is_on_top(builder)) {
+		// Format straight into the free space, the current terminator included.
+		linear_allocator *allocator = builder->allocator;
+		u64 available               = allocator->total_size - allocator->allocated + 1;
+		i32 written                 = vsnprintf(builder->data + builder->length, available, format, arg_ptr);
+		va_end(arg_ptr);
+
+		if (written < 0 || (u64)written >= available) {
+			builder->data[builder->length] = 0;
+			builder->overflowed            = true;
+			return false;
+		}
+		linear_allocator_allocate(allocator, (u64)written);
+		builder->length += (u64)written;
+		return true;
+	}
+
+	// Measure first, then format into the moved string.
+	va_list measure_args;
+	va_copy(measure_args, arg_ptr);
+	i32 length = vsnprintf(0, 0, format, measure_args);
+	va_end(measure_args);
+
+	if (length < 0 || !builder_reserve(builder, (u64)length)) {
+		va_end(arg_ptr);
+		builder->overflowed = true;
+		return false;
+	}
+	vsnprintf(builder->data + builder->length, (u64)length + 1, format, arg_ptr);
+	va_end(arg_ptr);
+	builder->length += (u64)length;
+	return true;
+}
+
+string_view string_builder_view(const string_builder *builder) {
+	string_view view = {.data = builder->data, .length = builder->length};
+	return view;
 }
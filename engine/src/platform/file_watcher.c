@@ -0,0 +1,182 @@
+#define LOG_CATEGORY LOG_CATEGORY_PLATFORM
+
+#include "file_watcher.h"
+
+#include "core/event.h"
+#include "core/logger.h"
+#include "core/smemory.h"
+#include "core/sstring.h"
+
+#if SPACE_PLATFORM_LINUX
+	#include <dirent.h>
+	#include <errno.h>
+	#include <sys/inotify.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+// Directories watched, the root included. inotify watches aren't recursive, each directory needs its own.
+#define MAX_WATCHED_DIRECTORIES 64
+#define MAX_WATCH_PATH_LENGTH 256
+// Changes reported per update. A tool writing a file several times in one frame reports it once.
+#define MAX_CHANGES_PER_UPDATE 64
+
+typedef struct watched_directory {
+	i32 descriptor;
+	// Relative to the root, with a trailing '/'. Empty for the root itself.
+	char prefix[MAX_WATCH_PATH_LENGTH];
+} watched_directory;
+
+typedef struct file_watcher_state {
+	i32 fd;
+	char root[MAX_WATCH_PATH_LENGTH];
+	u32 directory_count;
+	watched_directory directories[MAX_WATCHED_DIRECTORIES];
+} file_watcher_state;
+
+static file_watcher_state *state_ptr;
+
+#if SPACE_PLATFORM_LINUX
+static void watch_directory(const char *prefix) {
+	if (state_ptr->directory_count == MAX_WATCHED_DIRECTORIES) {
+		SWARN("file_watcher - Too many directories, '%s' isn't watched.", prefix);
+		return;
+	}
+
+	char path[MAX_WATCH_PATH_LENGTH * 2];
+	string_format_n(path, sizeof(path), "%s/%s", state_ptr->root, prefix);
+
+	// Moves in count as writes, tools often write a temporary and rename it over the asset.
+	i32 descriptor = inotify_add_watch(state_ptr->fd, path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+	if (descriptor < 0) {
+		SWARN("file_watcher - Unable to watch '%s': %d", path, errno);
+		return;
+	}
+
+	watched_directory *directory = &state_ptr->directories[state_ptr->directory_count++];
+	directory->descriptor        = descriptor;
+	string_format_n(directory->prefix, MAX_WATCH_PATH_LENGTH, "%s", prefix);
+
+	DIR *dir = opendir(path);
+	if (!dir) { return; }
+
+	struct dirent *item;
+	while ((item = readdir(dir))) {
+		if (item->d_name[0] == '.') { continue; }
+
+		char child[MAX_WATCH_PATH_LENGTH];
+		string_format_n(child, sizeof(child), "%s%s/", prefix, item->d_name);
+		// Some filesystems don't fill in d_type.
+		struct stat info;
+		char child_path[MAX_WATCH_PATH_LENGTH * 2];
+		string_format_n(child_path, sizeof(child_path), "%s/%s", state_ptr->root, child);
+		b8 is_directory = item->d_type == DT_DIR
+					   || (item->d_type == DT_UNKNOWN && stat(child_path, &info) == 0 && S_ISDIR(info.st_mode));
+		if (is_directory) { watch_directory(child); }
+	}
+	closedir(dir);
+}
+
+static const watched_directory *find_directory(i32 descriptor) {
+	for (u32 i = 0; i < state_ptr->directory_count; ++i) {
+		if (state_ptr->directories[i].descriptor == descriptor) { return &state_ptr->directories[i]; }
+	}
+	return 0;
+}
+#endif
+
+b8 file_watcher_initialize(u64 *memory_requirement, void *state, const char *directory) {
+	*memory_requirement = sizeof(file_watcher_state);
+	if (state == 0) { return true; }
+
+	szero_memory(state, sizeof(file_watcher_state));
+	state_ptr     = state;
+	state_ptr->fd = -1;
+	string_format_n(state_ptr->root, MAX_WATCH_PATH_LENGTH, "%s", directory);
+
+#if SPACE_PLATFORM_LINUX
+	// A missing directory just means there is nothing to reload, e.g. when running from a pack.
+	DIR *root = opendir(directory);
+	if (!root) { return true; }
+	closedir(root);
+
+	state_ptr->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (state_ptr->fd < 0) {
+		SWARN("file_watcher - inotify unavailable, hot reload is disabled.");
+		return true;
+	}
+
+	watch_directory("");
+	SDEBUG("Watching '%s' for changes in %u directories.", directory, state_ptr->directory_count);
+#else
+	SDEBUG("Hot reload is only supported on Linux.");
+#endif
+
+	return true;
+}
+
+void file_watcher_shutdown(void *state) {
+	(void)state;
+	if (!state_ptr) { return; }
+
+#if SPACE_PLATFORM_LINUX
+	// Closing the descriptor drops every watch with it.
+	if (state_ptr->fd >= 0) { close(state_ptr->fd); }
+#endif
+	state_ptr = 0;
+}
+
+void file_watcher_update() {
+#if SPACE_PLATFORM_LINUX
+	if (!state_ptr || state_ptr->fd < 0) { return; }
+
+	u64 changes[MAX_CHANGES_PER_UPDATE];
+	char names[MAX_CHANGES_PER_UPDATE][MAX_WATCH_PATH_LENGTH];
+	u32 change_count = 0;
+
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	while (true) {
+		i64 length = read(state_ptr->fd, buffer, sizeof(buffer));
+		if (length <= 0) { break; }
+
+		for (i64 offset = 0; offset < length;) {
+			const struct inotify_event *event = (const struct inotify_event *)(buffer + offset);
+			offset += (i64)(sizeof(struct inotify_event) + event->len);
+
+			if (event->mask & IN_Q_OVERFLOW) { SWARN("file_watcher - Event queue overflowed, changes were missed."); }
+			const watched_directory *directory = find_directory(event->wd);
+			if (!directory || event->len == 0) { continue; }
+
+			char name[MAX_WATCH_PATH_LENGTH];
+			string_format_n(name, sizeof(name), "%s%s", directory->prefix, event->name);
+
+			if (event->mask & IN_ISDIR) {
+				// New directories are watched from here on, files already in them are missed.
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					string_format_n(name, sizeof(name), "%s%s/", directory->prefix, event->name);
+					watch_directory(name);
+				}
+				continue;
+			}
+			// Files are reported once they are complete, not when created.
+			if (!(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) { continue; }
+
+			u64 hash       = string_hash(name);
+			b8 is_repeated = false;
+			for (u32 i = 0; i < change_count && !is_repeated; ++i) { is_repeated = changes[i] == hash; }
+			if (is_repeated || change_count == MAX_CHANGES_PER_UPDATE) { continue; }
+
+			changes[change_count] = hash;
+			string_format_n(names[change_count], MAX_WATCH_PATH_LENGTH, "%s", name);
+			change_count++;
+		}
+	}
+
+	for (u32 i = 0; i < change_count; ++i) {
+		SINFO("Asset changed: %s", names[i]);
+		event_context context;
+		context.data.u64[0] = changes[i];
+		event_fire(EVENT_CODE_ASSET_CHANGED, 0, context);
+	}
+#endif
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * Watches a directory tree for files that finished being written, for hot reloading assets. Every changed file
+ * fires EVENT_CODE_ASSET_CHANGED from file_watcher_update with the string_hash of its name relative to the
+ * watched directory, so listeners compare against the same names asset_map takes.
+ * Only implemented on Linux, elsewhere nothing is reported.
+ */
+b8 file_watcher_initialize(u64 *memory_requirement, void *state, const char *directory);
+void file_watcher_shutdown(void *state);
+
+// Polls for changes without blocking. Called once per frame on the main thread.
+void file_watcher_update();
@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_PLATFORM
+
 #include "core/filesystem.h"
 
 #include "core/logger.h"
@@ -7,6 +9,14 @@
 #include <string.h>
 #include <sys/stat.h>
 
+#if SPACE_PLATFORM_LINUX
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#elif SPACE_PLATFORM_WINDOWS
+	#include <windows.h>
+#endif
+
 b8 filesystem_exists(char const *path) {
 	struct stat buffer;
 	return stat(path, &buffer) == 0;
@@ -82,6 +92,95 @@ b8 filesystem_read(file_handle *handle, u64 data_size, void *out_data, u64 *out_
 	return true;
 }
 
+b8 filesystem_line_reader_create(file_handle *handle, u64 buffer_size, file_line_reader *out_reader) {
+	szero_memory(out_reader, sizeof(file_line_reader));
+	if (!handle->is_valid || !handle->handle) { return false; }
+
+	out_reader->handle   = handle;
+	out_reader->capacity = buffer_size ? buffer_size : FILE_LINE_READER_DEFAULT_SIZE;
+	out_reader->buffer   = sallocate(out_reader->capacity, MEMORY_TAG_STRING);
+	return true;
+}
+
+void filesystem_line_reader_destroy(file_line_reader *reader) {
+	if (reader->buffer) { sfree(reader->buffer, reader->capacity, MEMORY_TAG_STRING); }
+	szero_memory(reader, sizeof(file_line_reader));
+}
+
+// Drops the line ending, \r included for files written on Windows.
+static string_view make_line(const char *start, u64 length) {
+	if (length > 0 && start[length - 1] == '\r') { length--; }
+	return (string_view){start, length};
+}
+
+b8 filesystem_line_reader_next(file_line_reader *reader, string_view *out_line) {
+	if (!reader->buffer) { return false; }
+
+	// Where the newline search continues, so long lines aren't rescanned after every refill.
+	u64 scanned = reader->start;
+	while (true) {
+		const char *newline = memchr(reader->buffer + scanned, '\n', reader->end - scanned);
+		if (newline) {
+			*out_line     = make_line(reader->buffer + reader->start, (u64)(newline - reader->buffer) - reader->start);
+			reader->start = (u64)(newline - reader->buffer) + 1;
+			reader->line_number++;
+			return true;
+		}
+
+		if (reader->eof) {
+			if (reader->start == reader->end) { return false; }
+			// Last line without a trailing newline.
+			*out_line     = make_line(reader->buffer + reader->start, reader->end - reader->start);
+			reader->start = reader->end;
+			reader->line_number++;
+			return true;
+		}
+
+		// Keep the partial line and refill behind it.
+		u64 partial = reader->end - reader->start;
+		if (reader->start > 0) {
+			memmove(reader->buffer, reader->buffer + reader->start, partial);
+			reader->start = 0;
+			reader->end   = partial;
+		}
+		if (reader->end == reader->capacity) {
+			char *grown = sallocate(reader->capacity * 2, MEMORY_TAG_STRING);
+			scopy_memory(grown, reader->buffer, reader->end);
+			sfree(reader->buffer, reader->capacity, MEMORY_TAG_STRING);
+			reader->buffer = grown;
+			reader->capacity *= 2;
+		}
+		scanned = reader->end;
+
+		FILE *file = (FILE *)reader->handle->handle;
+		u64 read   = fread(reader->buffer + reader->end, 1, reader->capacity - reader->end, file);
+		reader->end += read;
+		if (read == 0) { reader->eof = true; }
+	}
+}
+
+b8 filesystem_for_each_line(const char *path, PFN_on_line callback, void *user_data) {
+	file_view view;
+	if (!filesystem_map(path, &view)) { return false; }
+
+	const char *cursor = view.data;
+	const char *end    = cursor + view.size;
+	u64 line_number    = 0;
+	b8 completed       = true;
+	while (cursor < end) {
+		const char *newline  = memchr(cursor, '\n', (u64)(end - cursor));
+		const char *line_end = newline ? newline : end;
+		if (!callback(make_line(cursor, (u64)(line_end - cursor)), ++line_number, user_data)) {
+			completed = false;
+			break;
+		}
+		cursor = line_end + 1;
+	}
+
+	filesystem_unmap(&view);
+	return completed;
+}
+
 b8 filesystem_read_all_bytes(file_handle *handle, u8 **out_bytes, u64 *out_bytes_read) {
 	if (!handle->is_valid || !handle->handle) { return false; }
 
@@ -105,3 +204,94 @@ b8 filesystem_write(file_handle *handle, u64 data_size, void const *data, u64 *o
 	fflush((FILE *)handle->handle);
 	return true;
 }
+
+#if SPACE_PLATFORM_LINUX
+b8 filesystem_map(const char *path, file_view *out_view) {
+	out_view->data = 0;
+	out_view->size = 0;
+
+	i32 fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) { return false; }
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+	if (info.st_size == 0) {
+		close(fd);
+		return true;
+	}
+
+	void *data = mmap(0, (u64)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps the file alive.
+	close(fd);
+	if (data == MAP_FAILED) {
+		SERROR("filesystem_map - Failed to map '%s'.", path);
+		return false;
+	}
+
+	// Advice values aren't flags, each needs its own call.
+	madvise(data, (u64)info.st_size, MADV_SEQUENTIAL);
+	madvise(data, (u64)info.st_size, MADV_WILLNEED);
+
+	out_view->data = data;
+	out_view->size = (u64)info.st_size;
+	return true;
+}
+
+void filesystem_unmap(file_view *view) {
+	if (view->data) { munmap((void *)view->data, view->size); }
+	view->data = 0;
+	view->size = 0;
+}
+#elif SPACE_PLATFORM_WINDOWS
+b8 filesystem_map(const char *path, file_view *out_view) {
+	out_view->data = 0;
+	out_view->size = 0;
+
+	HANDLE file = CreateFileA(path,
+							  GENERIC_READ,
+							  FILE_SHARE_READ,
+							  0,
+							  OPEN_EXISTING,
+							  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+							  0);
+	if (file == INVALID_HANDLE_VALUE) { return false; }
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return false;
+	}
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+	CloseHandle(file);
+	if (!mapping) {
+		SERROR("filesystem_map - Failed to map '%s'.", path);
+		return false;
+	}
+
+	// The view keeps the mapping alive.
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data) {
+		SERROR("filesystem_map - Failed to map '%s'.", path);
+		return false;
+	}
+
+	out_view->data = data;
+	out_view->size = (u64)size.QuadPart;
+	return true;
+}
+
+void filesystem_unmap(file_view *view) {
+	if (view->data) { UnmapViewOfFile(view->data); }
+	view->data = 0;
+	view->size = 0;
+}
+#endif
@@ -0,0 +1,393 @@
+#define LOG_CATEGORY LOG_CATEGORY_PLATFORM
+
+#include "core/filesystem.h"
+
+#include "core/logger.h"
+#include "core/smemory.h"
+#include "core/sstring.h"
+#include "platform/platform.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#if SPACE_PLATFORM_LINUX
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+#endif
+
+// Reads in flight at once. filesystem_read_async fails when all are in use.
+#define MAX_ASYNC_READS 256
+#define MAX_ASYNC_PATH_LENGTH 256
+#define MAX_ASYNC_WORKERS 4
+
+typedef enum async_read_status {
+	ASYNC_READ_FREE,
+	ASYNC_READ_PENDING,
+	ASYNC_READ_COMPLETE,
+} async_read_status;
+
+typedef struct async_read {
+	_Atomic u32 status;
+	b8 success;
+	char path[MAX_ASYNC_PATH_LENGTH];
+	u64 offset;
+	u64 size;
+	u64 bytes_read;
+	void *dest;
+	PFN_on_file_read callback;
+	void *user_data;
+#if SPACE_PLATFORM_LINUX
+	i32 fd;
+	struct iovec iov;
+#endif
+} async_read;
+
+#if SPACE_PLATFORM_LINUX
+typedef struct io_uring_queue {
+	i32 ring_fd;
+	void *sq_ring;
+	void *cq_ring;
+	u64 sq_ring_size;
+	u64 cq_ring_size;
+	struct io_uring_sqe *sqes;
+	u64 sqes_size;
+	_Atomic u32 *sq_tail;
+	_Atomic u32 *sq_head;
+	u32 sq_mask;
+	u32 *sq_array;
+	_Atomic u32 *cq_head;
+	_Atomic u32 *cq_tail;
+	u32 cq_mask;
+	struct io_uring_cqe *cqes;
+} io_uring_queue;
+#endif
+
+typedef struct filesystem_async_state {
+	async_read reads[MAX_ASYNC_READS];
+	u32 pending_count;
+
+	b8 use_io_uring;
+#if SPACE_PLATFORM_LINUX
+	io_uring_queue ring;
+#endif
+
+	// Thread pool fallback. Only the main thread submits, workers claim requests in order.
+	u32 worker_count;
+	platform_thread workers[MAX_ASYNC_WORKERS];
+	platform_semaphore work_available;
+	_Atomic b8 workers_running;
+	u32 queue_head;
+	_Atomic u32 queue_claimed;
+	u32 queue[MAX_ASYNC_READS];
+} filesystem_async_state;
+
+static filesystem_async_state *state_ptr;
+
+static void worker_read(async_read *read);
+static u32 worker_run(void *params);
+
+#if SPACE_PLATFORM_LINUX
+static b8 io_uring_create(io_uring_queue *ring, u32 entries) {
+	struct io_uring_params params;
+	szero_memory(&params, sizeof(params));
+
+	i32 fd = (i32)syscall(__NR_io_uring_setup, entries, &params);
+	if (fd < 0) { return false; }
+	ring->ring_fd = fd;
+
+	ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+	ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	b8 single_mmap     = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mmap) {
+		ring->sq_ring_size = SMAX(ring->sq_ring_size, ring->cq_ring_size);
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+
+	ring->sq_ring =
+		mmap(0, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (ring->sq_ring == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	ring->cq_ring = single_mmap ? ring->sq_ring
+								: mmap(0,
+									   ring->cq_ring_size,
+									   PROT_READ | PROT_WRITE,
+									   MAP_SHARED | MAP_POPULATE,
+									   fd,
+									   IORING_OFF_CQ_RING);
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(0, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+		munmap(ring->sq_ring, ring->sq_ring_size);
+		if (!single_mmap && ring->cq_ring != MAP_FAILED) { munmap(ring->cq_ring, ring->cq_ring_size); }
+		if (ring->sqes != MAP_FAILED) { munmap(ring->sqes, ring->sqes_size); }
+		close(fd);
+		return false;
+	}
+
+	u8 *sq         = ring->sq_ring;
+	u8 *cq         = ring->cq_ring;
+	ring->sq_head  = (_Atomic u32 *)(sq + params.sq_off.head);
+	ring->sq_tail  = (_Atomic u32 *)(sq + params.sq_off.tail);
+	ring->sq_mask  = *(u32 *)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (u32 *)(sq + params.sq_off.array);
+	ring->cq_head  = (_Atomic u32 *)(cq + params.cq_off.head);
+	ring->cq_tail  = (_Atomic u32 *)(cq + params.cq_off.tail);
+	ring->cq_mask  = *(u32 *)(cq + params.cq_off.ring_mask);
+	ring->cqes     = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+	return true;
+}
+
+static void io_uring_destroy(io_uring_queue *ring) {
+	munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ring != ring->sq_ring) { munmap(ring->cq_ring, ring->cq_ring_size); }
+	munmap(ring->sq_ring, ring->sq_ring_size);
+	close(ring->ring_fd);
+}
+
+// Queues a read of whatever is left of the request.
+static b8 io_uring_submit_read(io_uring_queue *ring, async_read *read, u32 index) {
+	u32 tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed);
+	u32 slot = tail & ring->sq_mask;
+
+	// Reads can come back short, each submission continues where the last one stopped.
+	read->iov.iov_base = (u8 *)read->dest + read->bytes_read;
+	read->iov.iov_len  = read->size - read->bytes_read;
+
+	struct io_uring_sqe *sqe = &ring->sqes[slot];
+	szero_memory(sqe, sizeof(*sqe));
+	sqe->opcode    = IORING_OP_READV;
+	sqe->fd        = read->fd;
+	sqe->addr      = (u64)&read->iov;
+	sqe->len       = 1;
+	sqe->off       = read->offset + read->bytes_read;
+	sqe->user_data = index;
+
+	ring->sq_array[slot] = slot;
+	atomic_store_explicit(ring->sq_tail, tail + 1, memory_order_release);
+
+	i32 result = (i32)syscall(__NR_io_uring_enter, ring->ring_fd, 1, 0, 0, 0, 0);
+	if (result >= 0) { return true; }
+
+	// Take the entry back so the caller can free the read. If the kernel picked it up anyway, a completion for
+	// it is coming and the read stays in flight.
+	if (atomic_load_explicit(ring->sq_head, memory_order_acquire) != tail) { return true; }
+	atomic_store_explicit(ring->sq_tail, tail, memory_order_release);
+	return false;
+}
+
+static void complete_read(async_read *read, b8 success);
+
+static void io_uring_reap(io_uring_queue *ring) {
+	u32 head = atomic_load_explicit(ring->cq_head, memory_order_relaxed);
+	u32 tail = atomic_load_explicit(ring->cq_tail, memory_order_acquire);
+
+	for (; head != tail; ++head) {
+		struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+		u32 index                = (u32)cqe->user_data;
+		async_read *read         = &state_ptr->reads[index];
+
+		if (cqe->res < 0) {
+			SWARN("filesystem_read_async - Read of '%s' failed: %d", read->path, -cqe->res);
+			complete_read(read, false);
+			continue;
+		}
+
+		read->bytes_read += (u64)cqe->res;
+		// Zero means end of file.
+		if (cqe->res == 0 || read->bytes_read == read->size) {
+			complete_read(read, read->bytes_read == read->size);
+		} else if (!io_uring_submit_read(ring, read, index)) {
+			complete_read(read, false);
+		}
+	}
+
+	atomic_store_explicit(ring->cq_head, head, memory_order_release);
+}
+#endif
+
+static void complete_read(async_read *read, b8 success) {
+#if SPACE_PLATFORM_LINUX
+	if (read->fd >= 0) { close(read->fd); }
+	read->fd = -1;
+#endif
+	read->success = success;
+	atomic_store_explicit(&read->status, ASYNC_READ_COMPLETE, memory_order_release);
+}
+
+b8 filesystem_async_initialize(u64 *memory_requirement, void *state) {
+	*memory_requirement = sizeof(filesystem_async_state);
+	if (state == 0) { return true; }
+
+	szero_memory(state, sizeof(filesystem_async_state));
+	state_ptr = state;
+
+#if SPACE_PLATFORM_LINUX
+	state_ptr->use_io_uring = io_uring_create(&state_ptr->ring, MAX_ASYNC_READS);
+	if (state_ptr->use_io_uring) {
+		SDEBUG("Async file reads use io_uring.");
+		return true;
+	}
+	SDEBUG("io_uring unavailable, async file reads use worker threads.");
+#endif
+
+	if (!platform_semaphore_create(0, &state_ptr->work_available)) { return false; }
+	atomic_store(&state_ptr->workers_running, true);
+
+	u32 processors          = platform_get_processor_count();
+	state_ptr->worker_count = SMAX(1, SMIN(processors > 1 ? processors - 1 : 1, MAX_ASYNC_WORKERS));
+	for (u32 i = 0; i < state_ptr->worker_count; ++i) {
+		if (!platform_thread_create(worker_run, 0, &state_ptr->workers[i])) {
+			SERROR("Failed to start async file read worker.");
+			state_ptr->worker_count = i;
+			break;
+		}
+	}
+	return state_ptr->worker_count > 0;
+}
+
+void filesystem_async_shutdown(void *state) {
+	(void)state;
+	if (!state_ptr) { return; }
+
+	// Let everything in flight land, callbacks included, before the destinations go away.
+	while (state_ptr->pending_count > 0) {
+		filesystem_async_update();
+		if (state_ptr->pending_count > 0) { platform_sleep(1); }
+	}
+
+#if SPACE_PLATFORM_LINUX
+	if (state_ptr->use_io_uring) {
+		io_uring_destroy(&state_ptr->ring);
+		state_ptr = 0;
+		return;
+	}
+#endif
+
+	atomic_store(&state_ptr->workers_running, false);
+	for (u32 i = 0; i < state_ptr->worker_count; ++i) { platform_semaphore_signal(&state_ptr->work_available); }
+	for (u32 i = 0; i < state_ptr->worker_count; ++i) { platform_thread_join(&state_ptr->workers[i]); }
+	platform_semaphore_destroy(&state_ptr->work_available);
+	state_ptr = 0;
+}
+
+b8 filesystem_read_async(const char *path,
+						 u64 offset,
+						 u64 size,
+						 void *dest,
+						 PFN_on_file_read callback,
+						 void *user_data) {
+	if (!state_ptr || !path || !dest) { return false; }
+	if (string_length(path) >= MAX_ASYNC_PATH_LENGTH) {
+		SERROR("filesystem_read_async - Path too long: '%s'", path);
+		return false;
+	}
+
+	u32 index = MAX_ASYNC_READS;
+	for (u32 i = 0; i < MAX_ASYNC_READS; ++i) {
+		if (atomic_load_explicit(&state_ptr->reads[i].status, memory_order_relaxed) == ASYNC_READ_FREE) {
+			index = i;
+			break;
+		}
+	}
+	if (index == MAX_ASYNC_READS) {
+		SWARN("filesystem_read_async - Too many reads in flight, '%s' was not queued.", path);
+		return false;
+	}
+
+	async_read *read = &state_ptr->reads[index];
+	string_format_n(read->path, MAX_ASYNC_PATH_LENGTH, "%s", path);
+	read->offset     = offset;
+	read->size       = size;
+	read->bytes_read = 0;
+	read->dest       = dest;
+	read->callback   = callback;
+	read->user_data  = user_data;
+	read->success    = false;
+	atomic_store_explicit(&read->status, ASYNC_READ_PENDING, memory_order_relaxed);
+	state_ptr->pending_count++;
+
+#if SPACE_PLATFORM_LINUX
+	read->fd = -1;
+	if (state_ptr->use_io_uring) {
+		// NOTE: The open is still synchronous, only the read goes through the ring.
+		read->fd = open(path, O_RDONLY | O_CLOEXEC);
+		if (read->fd < 0) {
+			complete_read(read, false);
+		} else if (size == 0) {
+			complete_read(read, true);
+		} else if (!io_uring_submit_read(&state_ptr->ring, read, index)) {
+			complete_read(read, false);
+		}
+		// Failures are reported through the callback like any other completion.
+		return true;
+	}
+#endif
+
+	state_ptr->queue[state_ptr->queue_head % MAX_ASYNC_READS] = index;
+	state_ptr->queue_head++;
+	platform_semaphore_signal(&state_ptr->work_available);
+	return true;
+}
+
+void filesystem_async_update() {
+	if (!state_ptr || state_ptr->pending_count == 0) { return; }
+
+#if SPACE_PLATFORM_LINUX
+	if (state_ptr->use_io_uring) { io_uring_reap(&state_ptr->ring); }
+#endif
+
+	for (u32 i = 0; i < MAX_ASYNC_READS && state_ptr->pending_count > 0; ++i) {
+		async_read *read = &state_ptr->reads[i];
+		if (atomic_load_explicit(&read->status, memory_order_acquire) != ASYNC_READ_COMPLETE) { continue; }
+
+		// Free the slot first, so the callback can queue follow-up reads.
+		PFN_on_file_read callback = read->callback;
+		void *user_data           = read->user_data;
+		void *dest                = read->dest;
+		u64 bytes_read            = read->bytes_read;
+		b8 success                = read->success;
+		atomic_store_explicit(&read->status, ASYNC_READ_FREE, memory_order_relaxed);
+		state_ptr->pending_count--;
+
+		if (callback) { callback(success, dest, bytes_read, user_data); }
+	}
+}
+
+static u32 worker_run(void *params) {
+	(void)params;
+
+	while (true) {
+		platform_semaphore_wait(&state_ptr->work_available);
+		if (!atomic_load(&state_ptr->workers_running)) { break; }
+
+		u32 claimed = atomic_fetch_add(&state_ptr->queue_claimed, 1);
+		worker_read(&state_ptr->reads[state_ptr->queue[claimed % MAX_ASYNC_READS]]);
+	}
+
+	return 0;
+}
+
+static void worker_read(async_read *read) {
+	FILE *file = fopen(read->path, "rb");
+	if (!file) {
+		complete_read(read, false);
+		return;
+	}
+
+#if defined(_MSC_VER)
+	i32 seek_result = _fseeki64(file, (i64)read->offset, SEEK_SET);
+#else
+	i32 seek_result = fseeko(file, (off_t)read->offset, SEEK_SET);
+#endif
+	if (seek_result == 0) { read->bytes_read = fread(read->dest, 1, read->size, file); }
+	fclose(file);
+
+	complete_read(read, seek_result == 0 && read->bytes_read == read->size);
+}
@@ -26,3 +26,24 @@ void platform_console_write_error(const char *message, u8 colour);
 f64 platform_get_absolute_time();
 
 void platform_sleep(u64 ms);
+
+// Threads
+typedef u32 (*pfn_thread_start)(void *params);
+
+typedef struct platform_thread {
+	void *internal_data;
+} platform_thread;
+
+b8 platform_thread_create(pfn_thread_start start, void *params, platform_thread *out_thread);
+// Waits for the thread to exit and releases it.
+void platform_thread_join(platform_thread *thread);
+u32 platform_get_processor_count();
+
+typedef struct platform_semaphore {
+	void *internal_data;
+} platform_semaphore;
+
+b8 platform_semaphore_create(u32 initial_count, platform_semaphore *out_semaphore);
+void platform_semaphore_destroy(platform_semaphore *semaphore);
+void platform_semaphore_signal(platform_semaphore *semaphore);
+void platform_semaphore_wait(platform_semaphore *semaphore);
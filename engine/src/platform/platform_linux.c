@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_PLATFORM
+
 #include "platform/platform.h"
 
 // Linux platform layer
@@ -15,6 +17,7 @@
 	#include <X11/keysym.h>
 	#include <sys/time.h>
 	#include <xcb/xcb.h>
+	#include <xcb/xinput.h>
 
 	#if _POSIX_C_SOURCE >= 199309L
 		#include <time.h> // nanosleep
@@ -22,9 +25,12 @@
 		#include <unistd.h> // usleep
 	#endif
 
+	#include <pthread.h>
+	#include <semaphore.h>
 	#include <stdio.h>
 	#include <stdlib.h>
 	#include <string.h>
+	#include <unistd.h> // sysconf
 
 	// For surface creation
 	#define VK_USE_PLATFORM_XCB_KHR
@@ -39,11 +45,18 @@ typedef struct platform_state {
 	xcb_atom_t wm_protocols;
 	xcb_atom_t wm_delete_win;
 	VkSurfaceKHR surface;
+
+	// XInput2 raw motion, only used when the server supports XI 2.0 or later.
+	b8 raw_motion_enabled;
+	u8 xinput_opcode;
+	b8 has_focus;
 } platform_state;
 
 static platform_state *state_ptr;
 
 keys translate_keycode(KeySym x_keycode);
+static b8 raw_motion_enable();
+static void raw_motion_process(xcb_input_raw_motion_event_t *raw_event);
 
 b8 platform_system_startup(u64 *memory_requirement,
 						   void *state,
@@ -94,7 +107,7 @@ b8 platform_system_startup(u64 *memory_requirement,
 	// Listen for keyboard and mouse buttons
 	u32 event_values = XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_KEY_PRESS
 					 | XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_POINTER_MOTION
-					 | XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+					 | XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_FOCUS_CHANGE;
 
 	// Values to be sent over XCB (bg colour, events)
 	u32 value_list[] = {state_ptr->screen->black_pixel, event_values};
@@ -148,6 +161,11 @@ b8 platform_system_startup(u64 *memory_requirement,
 	// Map the window to the screen
 	xcb_map_window(state_ptr->connection, state_ptr->window);
 
+	// Relative mouse motion straight from the device, falls back to motion notify deltas.
+	state_ptr->raw_motion_enabled = raw_motion_enable();
+	input_set_raw_motion_available(state_ptr->raw_motion_enabled);
+	if (!state_ptr->raw_motion_enabled) { SWARN("XInput2 not available, using pointer motion for mouse deltas."); }
+
 	// Flush the stream
 	i32 stream_result = xcb_flush(state_ptr->connection);
 	if (stream_result <= 0) {
@@ -194,7 +212,7 @@ b8 platform_pump_messages() {
 
 				keys key = translate_keycode(key_sym);
 
-				input_process_key(key, pressed);
+				input_process_key(key, pressed, kb_event->time);
 			} break;
 
 			case XCB_BUTTON_PRESS:
@@ -205,6 +223,15 @@ b8 platform_pump_messages() {
 
 				buttons mouse_button = BUTTON_MAX_BUTTONS;
 				switch (mouse_event->detail) {
+					// The wheel is reported as buttons 4 (up) and 5 (down), only the press matters.
+					case XCB_BUTTON_INDEX_4:
+					case XCB_BUTTON_INDEX_5:
+						if (pressed) {
+							input_process_mouse_wheel(mouse_event->detail == XCB_BUTTON_INDEX_4 ? 1 : -1,
+													  mouse_event->time);
+						}
+						break;
+
 					case XCB_BUTTON_INDEX_1:
 						mouse_button = BUTTON_LEFT;
 						break;
@@ -218,22 +245,40 @@ b8 platform_pump_messages() {
 						break;
 				}
 
-				if (mouse_button != BUTTON_MAX_BUTTONS) { input_process_button(mouse_button, pressed); }
+				if (mouse_button != BUTTON_MAX_BUTTONS) {
+					input_process_button(mouse_button, pressed, mouse_event->time);
+				}
 			} break;
 
 			case XCB_MOTION_NOTIFY: {
 				xcb_motion_notify_event_t *move_event = (xcb_motion_notify_event_t *)event;
 
-				input_process_mouse_move(move_event->event_x, move_event->event_y);
+				input_process_mouse_move(move_event->event_x, move_event->event_y, move_event->time);
 			} break;
 
+			case XCB_GE_GENERIC: {
+				xcb_ge_generic_event_t *generic_event = (xcb_ge_generic_event_t *)event;
+				if (state_ptr->raw_motion_enabled && generic_event->extension == state_ptr->xinput_opcode
+					&& generic_event->event_type == XCB_INPUT_RAW_MOTION) {
+					raw_motion_process((xcb_input_raw_motion_event_t *)event);
+				}
+			} break;
+
+			case XCB_FOCUS_IN:
+				state_ptr->has_focus = true;
+				break;
+
+			case XCB_FOCUS_OUT:
+				state_ptr->has_focus = false;
+				break;
+
 			case XCB_CONFIGURE_NOTIFY: {
 				xcb_configure_notify_event_t *configure_event = (xcb_configure_notify_event_t *)event;
 
 				event_context context;
 				context.data.u16[0] = configure_event->width;
 				context.data.u16[1] = configure_event->height;
-				event_fire(EVENT_CODE_RESIZED, 0, context);
+				event_post(EVENT_CODE_RESIZED, 0, context);
 			} break;
 
 			case XCB_CLIENT_MESSAGE: {
@@ -302,6 +347,82 @@ void platform_sleep(u64 ms) {
 	#endif
 }
 
+typedef struct linux_thread_start {
+	pfn_thread_start start;
+	void *params;
+} linux_thread_start;
+
+static void *thread_entry(void *params) {
+	linux_thread_start start = *(linux_thread_start *)params;
+	platform_free(params, false);
+	u32 result = start.start(start.params);
+	// The thread may have posted events, let another thread have its command ring.
+	event_thread_release();
+	return (void *)(u64)result;
+}
+
+b8 platform_thread_create(pfn_thread_start start, void *params, platform_thread *out_thread) {
+	out_thread->internal_data = 0;
+
+	// NOTE: Freed by the thread itself once started.
+	linux_thread_start *start_params = platform_allocate(sizeof(linux_thread_start), false);
+	start_params->start              = start;
+	start_params->params             = params;
+
+	pthread_t *handle = platform_allocate(sizeof(pthread_t), false);
+	i32 result        = pthread_create(handle, 0, thread_entry, start_params);
+	if (result != 0) {
+		SERROR("Failed to create thread: %d", result);
+		platform_free(start_params, false);
+		platform_free(handle, false);
+		return false;
+	}
+
+	out_thread->internal_data = handle;
+	return true;
+}
+
+void platform_thread_join(platform_thread *thread) {
+	if (!thread->internal_data) { return; }
+
+	pthread_join(*(pthread_t *)thread->internal_data, 0);
+	platform_free(thread->internal_data, false);
+	thread->internal_data = 0;
+}
+
+u32 platform_get_processor_count() {
+	i64 count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (u32)count : 1;
+}
+
+b8 platform_semaphore_create(u32 initial_count, platform_semaphore *out_semaphore) {
+	sem_t *handle = platform_allocate(sizeof(sem_t), false);
+	if (sem_init(handle, 0, initial_count) != 0) {
+		SERROR("Failed to create semaphore.");
+		platform_free(handle, false);
+		out_semaphore->internal_data = 0;
+		return false;
+	}
+
+	out_semaphore->internal_data = handle;
+	return true;
+}
+
+void platform_semaphore_destroy(platform_semaphore *semaphore) {
+	if (!semaphore->internal_data) { return; }
+
+	sem_destroy(semaphore->internal_data);
+	platform_free(semaphore->internal_data, false);
+	semaphore->internal_data = 0;
+}
+
+void platform_semaphore_signal(platform_semaphore *semaphore) { sem_post(semaphore->internal_data); }
+
+void platform_semaphore_wait(platform_semaphore *semaphore) {
+	// Retry when interrupted by a signal.
+	while (sem_wait(semaphore->internal_data) != 0) {}
+}
+
 void platform_get_required_extension_names(const char ***names_darray) {
 	darray_push(*names_darray, &"VK_KHR_xcb_surface");
 }
@@ -325,6 +446,61 @@ b8 platform_create_vulkan_surface(vulkan_context *context) {
 	return true;
 }
 
+static b8 raw_motion_enable() {
+	const xcb_query_extension_reply_t *extension = xcb_get_extension_data(state_ptr->connection, &xcb_input_id);
+	if (!extension || !extension->present) { return false; }
+
+	xcb_input_xi_query_version_cookie_t version_cookie =
+		xcb_input_xi_query_version(state_ptr->connection, XCB_INPUT_MAJOR_VERSION, XCB_INPUT_MINOR_VERSION);
+	xcb_input_xi_query_version_reply_t *version_reply =
+		xcb_input_xi_query_version_reply(state_ptr->connection, version_cookie, NULL);
+	if (!version_reply) { return false; }
+
+	b8 supported = version_reply->major_version >= 2;
+	free(version_reply);
+	if (!supported) { return false; }
+
+	// Raw events are only delivered to the root window.
+	struct {
+		xcb_input_event_mask_t head;
+		u32 mask;
+	} raw_mask = {
+		.head =
+			{
+				.deviceid = XCB_INPUT_DEVICE_ALL_MASTER,
+				.mask_len = 1,
+			},
+		.mask = XCB_INPUT_XI_EVENT_MASK_RAW_MOTION,
+	};
+	xcb_input_xi_select_events(state_ptr->connection, state_ptr->screen->root, 1, &raw_mask.head);
+
+	state_ptr->xinput_opcode = extension->major_opcode;
+	return true;
+}
+
+static void raw_motion_process(xcb_input_raw_motion_event_t *raw_event) {
+	// Raw events don't care about focus, the mouse might be used in another window.
+	if (!state_ptr->has_focus) { return; }
+
+	const u32 *mask                  = xcb_input_raw_button_press_valuator_mask(raw_event);
+	i32 mask_length                  = xcb_input_raw_button_press_valuator_mask_length(raw_event);
+	const xcb_input_fp3232_t *values = xcb_input_raw_button_press_axisvalues_raw(raw_event);
+	i32 value_count                  = xcb_input_raw_button_press_axisvalues_raw_length(raw_event);
+	f32 delta[2]                     = {0, 0};
+	i32 value_index                  = 0;
+
+	// Only the valuators set in the mask are present in the values, in axis order.
+	// Axis 0 and 1 are x and y for pointer devices.
+	for (i32 axis = 0; axis < 2 && axis < mask_length * 32 && value_index < value_count; ++axis) {
+		if (mask[axis / 32] & (1u << (axis % 32))) {
+			xcb_input_fp3232_t value = values[value_index++];
+			delta[axis]              = (f32)((f64)value.integral + (f64)value.frac / 4294967296.0);
+		}
+	}
+
+	input_process_mouse_raw_motion(delta[0], delta[1]);
+}
+
 keys translate_keycode(KeySym x_keycode) {
 	switch (x_keycode) {
 		case XK_BackSpace:
@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_PLATFORM
+
 #include "platform/platform.h"
 
 // Windows platform layer.
@@ -198,6 +200,71 @@ f64 platform_get_absolute_time() {
 
 void platform_sleep(u64 ms) { Sleep((u32)ms); }
 
+typedef struct win32_thread_start {
+	pfn_thread_start start;
+	void *params;
+} win32_thread_start;
+
+static DWORD WINAPI thread_entry(LPVOID params) {
+	win32_thread_start start = *(win32_thread_start *)params;
+	platform_free(params, false);
+	u32 result = start.start(start.params);
+	// The thread may have posted events, let another thread have its command ring.
+	event_thread_release();
+	return result;
+}
+
+b8 platform_thread_create(pfn_thread_start start, void *params, platform_thread *out_thread) {
+	// NOTE: Freed by the thread itself once started.
+	win32_thread_start *start_params = platform_allocate(sizeof(win32_thread_start), false);
+	start_params->start              = start;
+	start_params->params             = params;
+
+	out_thread->internal_data = CreateThread(0, 0, thread_entry, start_params, 0, 0);
+	if (!out_thread->internal_data) {
+		SERROR("Failed to create thread: %lu", GetLastError());
+		platform_free(start_params, false);
+		return false;
+	}
+
+	return true;
+}
+
+void platform_thread_join(platform_thread *thread) {
+	if (!thread->internal_data) { return; }
+
+	WaitForSingleObject(thread->internal_data, INFINITE);
+	CloseHandle(thread->internal_data);
+	thread->internal_data = 0;
+}
+
+u32 platform_get_processor_count() {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+}
+
+b8 platform_semaphore_create(u32 initial_count, platform_semaphore *out_semaphore) {
+	out_semaphore->internal_data = CreateSemaphoreA(0, (LONG)initial_count, LONG_MAX, 0);
+	if (!out_semaphore->internal_data) {
+		SERROR("Failed to create semaphore.");
+		return false;
+	}
+
+	return true;
+}
+
+void platform_semaphore_destroy(platform_semaphore *semaphore) {
+	if (!semaphore->internal_data) { return; }
+
+	CloseHandle(semaphore->internal_data);
+	semaphore->internal_data = 0;
+}
+
+void platform_semaphore_signal(platform_semaphore *semaphore) { ReleaseSemaphore(semaphore->internal_data, 1, 0); }
+
+void platform_semaphore_wait(platform_semaphore *semaphore) { WaitForSingleObject(semaphore->internal_data, INFINITE); }
+
 void platform_get_required_extension_names(const char ***names_darray) {
 	darray_push(*names_darray, &"VK_KHR_win32_surface");
 }
@@ -247,7 +314,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 message, WPARAM w_param, L
 			event_context context;
 			context.data.u16[0] = (u16)width;
 			context.data.u16[1] = (u16)height;
-			event_fire(EVENT_CODE_RESIZED, 0, context);
+			event_post(EVENT_CODE_RESIZED, 0, context);
 		} break;
 
 		case WM_KEYDOWN:
@@ -258,7 +325,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 message, WPARAM w_param, L
 			b8 pressed = (message == WM_KEYDOWN || message == WM_SYSKEYDOWN);
 			keys key   = (u16)w_param;
 
-			input_process_key(key, pressed);
+			input_process_key(key, pressed, (u32)GetMessageTime());
 		} break;
 
 		case WM_MOUSEMOVE: {
@@ -266,7 +333,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 message, WPARAM w_param, L
 			i32 x_position = GET_X_LPARAM(l_param);
 			i32 y_position = GET_Y_LPARAM(l_param);
 
-			input_process_mouse_move((i16)x_position, (i16)y_position);
+			input_process_mouse_move((i16)x_position, (i16)y_position, (u32)GetMessageTime());
 		} break;
 
 		case WM_MOUSEHWHEEL: {
@@ -274,7 +341,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 message, WPARAM w_param, L
 			if (z_delta != 0) {
 				// Flatten the input to an OS-independent(-1, 1)
 				z_delta = (z_delta < 0) ? -1 : 1;
-				input_process_mouse_wheel((i8)z_delta);
+				input_process_mouse_wheel((i8)z_delta, (u32)GetMessageTime());
 			}
 		} break;
 
@@ -307,7 +374,9 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 message, WPARAM w_param, L
 					break;
 			}
 
-			if (mouse_button != BUTTON_MAX_BUTTONS) { input_process_button(mouse_button, pressed); }
+			if (mouse_button != BUTTON_MAX_BUTTONS) {
+				input_process_button(mouse_button, pressed, (u32)GetMessageTime());
+			}
 		} break;
 
 		default:
@@ -17,6 +17,14 @@ b8 renderer_backend_create(renderer_backend_type type, renderer_backend *out_ren
 			out_renderer_backend->create_texture      = vulkan_renderer_create_texture;
 			out_renderer_backend->destroy_texture     = vulkan_renderer_destroy_texture;
 
+			out_renderer_backend->create_texture_staging      = vulkan_renderer_create_texture_staging;
+			out_renderer_backend->destroy_texture_staging     = vulkan_renderer_destroy_texture_staging;
+			out_renderer_backend->create_texture_from_staging = vulkan_renderer_create_texture_from_staging;
+			out_renderer_backend->texture_format_supported    = vulkan_renderer_texture_format_supported;
+
+			out_renderer_backend->create_geometry  = vulkan_renderer_create_geometry;
+			out_renderer_backend->destroy_geometry = vulkan_renderer_destroy_geometry;
+
 			return true;
 
 		default:
@@ -36,4 +44,12 @@ void renderer_backend_destroy(renderer_backend *renderer_backend) {
 	renderer_backend->update_object       = 0;
 	renderer_backend->create_texture      = 0;
 	renderer_backend->destroy_texture     = 0;
+
+	renderer_backend->create_texture_staging      = 0;
+	renderer_backend->destroy_texture_staging     = 0;
+	renderer_backend->create_texture_from_staging = 0;
+	renderer_backend->texture_format_supported    = 0;
+
+	renderer_backend->create_geometry  = 0;
+	renderer_backend->destroy_geometry = 0;
 }
@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "renderer_frontend.h"
 
 #include "renderer_backend.h"
@@ -7,6 +9,8 @@
 #include "math/smath.h"
 
 #include "resources/resource_types.h"
+#include "systems/geometry_system.h"
+#include "systems/texture_system.h"
 
 typedef struct renderer_system_state {
 	renderer_backend backend;
@@ -14,8 +18,7 @@ typedef struct renderer_system_state {
 	mat4 view;
 	f32 near_clip;
 	f32 far_clip;
-
-	texture default_texture;
+	texture *diffuse;
 } renderer_system_state;
 
 // Backend render context.
@@ -43,47 +46,12 @@ b8 render_system_initialize(u64 *memory_requirement, void *state, const char *ap
 	state_ptr->view = mat4_translation((vec3){.x = 0, .y = 0, .z = -30.0f});
 	state_ptr->view = mat4_inverse(state_ptr->view);
 
-	STRACE("Generating default texture...");
-	const u32 texture_dimension = 256;
-	const u32 channels          = 4;
-	const u32 pixel_count       = texture_dimension * texture_dimension;
-	u8 pixels[pixel_count * channels];
-	sset_memory(pixels, 255, sizeof(u8) * pixel_count * channels);
-
-	for (u64 row = 0; row < texture_dimension; ++row) {
-		for (u64 col = 0; col < texture_dimension; ++col) {
-			u64 index          = (row * texture_dimension) + col;
-			u64 index_channels = index * channels;
-			if (row % 2) {
-				if (col % 2) {
-					pixels[index_channels + 0] = 0;
-					pixels[index_channels + 1] = 0;
-				}
-			} else {
-				if (!(col % 2)) {
-					pixels[index_channels + 0] = 0;
-					pixels[index_channels + 1] = 0;
-				}
-			}
-		}
-	}
-
-	renderer_create_texture("default",
-							false,
-							texture_dimension,
-							texture_dimension,
-							4,
-							pixels,
-							false,
-							&state_ptr->default_texture);
-
 	return true;
 }
 
 void renderer_system_shutdown(void *state) {
 	(void)state;
 	if (state_ptr) {
-		renderer_destroy_texture(&state_ptr->default_texture);
 		state_ptr->backend.shutdown(&state_ptr->backend);
 	}
 	state_ptr = 0;
@@ -128,7 +96,9 @@ b8 renderer_draw_frame(render_packet *packet) {
 		geometry_render_data data = {};
 		data.object_id            = 0;
 		data.model                = model;
-		data.textures[0]          = &state_ptr->default_texture;
+		data.geometry             = geometry_system_get_default_geometry();
+		data.textures[0]          = state_ptr->diffuse ? state_ptr->diffuse : texture_system_get_default_texture();
+		texture_system_mark_used(data.textures[0]);
 
 		state_ptr->backend.update_object(data);
 
@@ -146,6 +116,8 @@ b8 renderer_draw_frame(render_packet *packet) {
 
 void renderer_set_view(mat4 view) { state_ptr->view = view; }
 
+void renderer_set_diffuse(texture *diffuse) { state_ptr->diffuse = diffuse; }
+
 void renderer_create_texture(const char *name,
 							 b8 auto_release,
 							 u32 width,
@@ -159,3 +131,45 @@ void renderer_create_texture(const char *name,
 }
 
 void renderer_destroy_texture(texture *texture) { state_ptr->backend.destroy_texture(texture); }
+
+b8 renderer_create_texture_staging(u64 size, texture_staging *out_staging) {
+	return state_ptr->backend.create_texture_staging(size, out_staging);
+}
+
+void renderer_destroy_texture_staging(texture_staging *staging) { state_ptr->backend.destroy_texture_staging(staging); }
+
+void renderer_create_texture_from_staging(const char *name,
+										  b8 auto_release,
+										  u32 width,
+										  u32 height,
+										  i32 channel_count,
+										  texture_format format,
+										  u32 level_count,
+										  const texture_staging *staging,
+										  b8 has_transparency,
+										  texture *out_texture) {
+	state_ptr->backend.create_texture_from_staging(name,
+												   auto_release,
+												   width,
+												   height,
+												   channel_count,
+												   format,
+												   level_count,
+												   staging,
+												   has_transparency,
+												   out_texture);
+}
+
+b8 renderer_texture_format_supported(texture_format format) {
+	return state_ptr->backend.texture_format_supported(format);
+}
+
+b8 renderer_create_geometry(u32 vertex_count,
+							const vertex_3d *vertices,
+							u32 index_count,
+							const u32 *indices,
+							geometry *out_geometry) {
+	return state_ptr->backend.create_geometry(vertex_count, vertices, index_count, indices, out_geometry);
+}
+
+void renderer_destroy_geometry(geometry *geometry) { state_ptr->backend.destroy_geometry(geometry); }
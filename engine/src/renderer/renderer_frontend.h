@@ -13,6 +13,8 @@ void renderer_on_resize(u16 width, u16 height);
 b8 renderer_draw_frame(render_packet *packet);
 
 void renderer_set_view(mat4 view);
+// Texture the geometry is drawn with, the default texture if 0.
+SAPI void renderer_set_diffuse(texture *diffuse);
 
 void renderer_create_texture(const char *name,
 							 b8 auto_release,
@@ -23,3 +25,34 @@ void renderer_create_texture(const char *name,
 							 b8 has_transparency,
 							 texture *out_texture);
 void renderer_destroy_texture(texture *texture);
+
+// Staging memory a texture's pixels can be written into from any thread before the texture is created from it.
+b8 renderer_create_texture_staging(u64 size, texture_staging *out_staging);
+void renderer_destroy_texture_staging(texture_staging *staging);
+/**
+ * Uploads the staging memory's pixels, which stays owned by the caller. Its level_count levels follow each other
+ * as texture_format_level_size describes. A single RGBA8 level gets the rest of its mip chain generated.
+ */
+void renderer_create_texture_from_staging(const char *name,
+										  b8 auto_release,
+										  u32 width,
+										  u32 height,
+										  i32 channel_count,
+										  texture_format format,
+										  u32 level_count,
+										  const texture_staging *staging,
+										  b8 has_transparency,
+										  texture *out_texture);
+// Whether the device can sample textures of this format. RGBA8 always is.
+b8 renderer_texture_format_supported(texture_format format);
+
+/**
+ * Uploads a triangle list into the renderer's shared vertex and index buffers, the arrays stay owned by the caller.
+ * @returns False if the buffers have no room left for it.
+ */
+b8 renderer_create_geometry(u32 vertex_count,
+							const vertex_3d *vertices,
+							u32 index_count,
+							const u32 *indices,
+							geometry *out_geometry);
+void renderer_destroy_geometry(geometry *geometry);
@@ -29,9 +29,18 @@ typedef struct object_uniform_object {
 typedef struct geometry_render_data {
 	u32 object_id;
 	mat4 model;
+	geometry *geometry;
 	texture *textures[TEXTURES_PER_GEOMETRY];
 } geometry_render_data;
 
+// Host-visible memory a texture's pixels are written into before they are uploaded. Stays mapped until destroyed,
+// so it can be filled from any thread.
+typedef struct texture_staging {
+	u64 size;
+	void *pixels;
+	void *internal_data;
+} texture_staging;
+
 typedef struct renderer_backend {
 	u64 frame_number;
 
@@ -56,6 +65,27 @@ typedef struct renderer_backend {
 						   b8 has_transparency,
 						   texture *out_texture);
 	void (*destroy_texture)(texture *texture);
+
+	b8 (*create_texture_staging)(u64 size, texture_staging *out_staging);
+	void (*destroy_texture_staging)(texture_staging *staging);
+	void (*create_texture_from_staging)(const char *name,
+										b8 auto_release,
+										u32 width,
+										u32 height,
+										i32 channel_count,
+										texture_format format,
+										u32 level_count,
+										const texture_staging *staging,
+										b8 has_transparency,
+										texture *out_texture);
+	b8 (*texture_format_supported)(texture_format format);
+
+	b8 (*create_geometry)(u32 vertex_count,
+						  const vertex_3d *vertices,
+						  u32 index_count,
+						  const u32 *indices,
+						  geometry *out_geometry);
+	void (*destroy_geometry)(geometry *geometry);
 } renderer_backend;
 
 typedef struct render_packet {
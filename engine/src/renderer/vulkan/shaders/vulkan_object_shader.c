@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "vulkan_object_shader.h"
 
 #include "renderer/vulkan/vulkan_buffer.h"
@@ -6,11 +8,12 @@
 
 #include "core/logger.h"
 #include "core/smemory.h"
+#include "core/sstring.h"
 #include "math/smath.h"
 
 #define BUILTIN_SHADER_NAME_OBJECT "Builtin.ObjectShader"
 
-b8 vulkan_object_shader_create(vulkan_context *context, vulkan_object_shader *out_shader) {
+static b8 create_shader_modules(vulkan_context *context, vulkan_shader_stage *stages) {
 	char stage_type_strings[OBJECT_SHADER_STAGE_COUNT][5]        = {"vert", "frag"};
 	VkShaderStageFlagBits stage_types[OBJECT_SHADER_STAGE_COUNT] = {VK_SHADER_STAGE_VERTEX_BIT,
 																	VK_SHADER_STAGE_FRAGMENT_BIT};
@@ -21,13 +24,21 @@ b8 vulkan_object_shader_create(vulkan_context *context, vulkan_object_shader *ou
 								  stage_type_strings[i],
 								  stage_types[i],
 								  i,
-								  out_shader->stages)) {
+								  stages)) {
 			SERROR("Unable to create %s shader module for '%s'.", stage_type_strings[i], BUILTIN_SHADER_NAME_OBJECT);
+			for (u32 j = 0; j < i; ++j) { shader_module_destroy(context, j, stages); }
 			return false;
 		}
 	}
 
-	// Pipeline creation
+	return true;
+}
+
+// Builds the pipeline from the given stages. Descriptor set layouts must already exist.
+static b8 create_pipeline(vulkan_context *context,
+						  vulkan_object_shader *shader,
+						  vulkan_shader_stage *stages,
+						  vulkan_pipeline *out_pipeline) {
 	VkViewport viewport = {
 		.x        = 0.0f,
 		.y        = (f32)context->framebuffer_height,
@@ -77,10 +88,34 @@ b8 vulkan_object_shader_create(vulkan_context *context, vulkan_object_shader *ou
 	// NOTE: Should match the number of shader->stages.
 	VkPipelineShaderStageCreateInfo stage_create_infos[OBJECT_SHADER_STAGE_COUNT];
 	szero_memory(stage_create_infos, sizeof(stage_create_infos));
-	for (u32 i = 0; i < OBJECT_SHADER_STAGE_COUNT; ++i) {
-		stage_create_infos[i] = out_shader->stages[i].shader_stage_create_info;
+	for (u32 i = 0; i < OBJECT_SHADER_STAGE_COUNT; ++i) { stage_create_infos[i] = stages[i].shader_stage_create_info; }
+
+	VkDescriptorSetLayout layouts[] = {shader->global_descriptor_set_layout, shader->object_descriptor_set_layout};
+	u32 descriptor_set_layout_count = sizeof(layouts) / sizeof(VkDescriptorSetLayout);
+
+	if (!vulkan_graphics_pipeline_create(context,
+										 &context->main_render_pass,
+										 attribute_count,
+										 attribute_descriptions,
+										 descriptor_set_layout_count,
+										 layouts,
+										 OBJECT_SHADER_STAGE_COUNT,
+										 stage_create_infos,
+										 viewport,
+										 scissor,
+										 false,
+										 out_pipeline)) {
+		SERROR("Failed to load graphics pipeline for object shader.");
+		vulkan_pipeline_destroy(context, out_pipeline);
+		return false;
 	}
 
+	return true;
+}
+
+b8 vulkan_object_shader_create(vulkan_context *context, vulkan_object_shader *out_shader) {
+	if (!create_shader_modules(context, out_shader->stages)) { return false; }
+
 	// Global Descriptors
 	VkDescriptorSetLayoutBinding global_ubo_layout_binding = {
 		.binding            = 0,
@@ -170,25 +205,7 @@ b8 vulkan_object_shader_create(vulkan_context *context, vulkan_object_shader *ou
 									context->allocator,
 									&out_shader->object_descriptor_pool));
 
-	VkDescriptorSetLayout layouts[] = {out_shader->global_descriptor_set_layout,
-									   out_shader->object_descriptor_set_layout};
-	u32 descriptor_set_layout_count = sizeof(layouts) / sizeof(VkDescriptorSetLayout);
-
-	if (!vulkan_graphics_pipeline_create(context,
-										 &context->main_render_pass,
-										 attribute_count,
-										 attribute_descriptions,
-										 descriptor_set_layout_count,
-										 layouts,
-										 OBJECT_SHADER_STAGE_COUNT,
-										 stage_create_infos,
-										 viewport,
-										 scissor,
-										 false,
-										 &out_shader->pipeline)) {
-		SERROR("Failed to load graphics pipeline for object shader.");
-		return false;
-	}
+	if (!create_pipeline(context, out_shader, out_shader->stages, &out_shader->pipeline)) { return false; }
 
 	if (!vulkan_buffer_create(context,
 							  sizeof(global_uniform_object) * DISPLAY_BUFFER_COUNT,
@@ -230,6 +247,30 @@ b8 vulkan_object_shader_create(vulkan_context *context, vulkan_object_shader *ou
 	return true;
 }
 
+b8 vulkan_object_shader_reload(vulkan_context *context, vulkan_object_shader *shader) {
+	vulkan_shader_stage stages[OBJECT_SHADER_STAGE_COUNT];
+	szero_memory(stages, sizeof(stages));
+	if (!create_shader_modules(context, stages)) { return false; }
+
+	vulkan_pipeline pipeline = {0};
+	if (!create_pipeline(context, shader, stages, &pipeline)) {
+		for (u32 i = 0; i < OBJECT_SHADER_STAGE_COUNT; ++i) { shader_module_destroy(context, i, stages); }
+		return false;
+	}
+
+	// Swapped only once everything built, so a broken shader leaves the old one running.
+	vulkan_pipeline_destroy(context, &shader->pipeline);
+	for (u32 i = 0; i < OBJECT_SHADER_STAGE_COUNT; ++i) { shader_module_destroy(context, i, shader->stages); }
+	scopy_memory(shader->stages, stages, sizeof(stages));
+	shader->pipeline = pipeline;
+	return true;
+}
+
+b8 vulkan_object_shader_uses_asset(u64 name_hash) {
+	return name_hash == STRING_HASH_LITERAL("shaders/" BUILTIN_SHADER_NAME_OBJECT ".vert.spv")
+		|| name_hash == STRING_HASH_LITERAL("shaders/" BUILTIN_SHADER_NAME_OBJECT ".frag.spv");
+}
+
 void vulkan_object_shader_destroy(vulkan_context *context, vulkan_object_shader *shader) {
 	VkDevice logical_device = context->device.logical_device;
 
@@ -368,8 +409,11 @@ void vulkan_object_shader_update_object(vulkan_context *context,
 	for (u32 sampler_index = 0; sampler_index < sampler_count; ++sampler_index) {
 		texture *t                 = data.textures[sampler_index];
 		u32 *descriptor_generation = &object_state->descriptor_states[descriptor_index].generations[image_index];
+		u32 *descriptor_id         = &object_state->descriptor_states[descriptor_index].ids[image_index];
 
-		if (t && (*descriptor_generation != t->generation || *descriptor_generation == INVALID_ID)) {
+		if (t
+			&& (*descriptor_id != t->id || *descriptor_generation != t->generation
+				|| *descriptor_generation == INVALID_ID)) {
 			vulkan_texture_data *internal_data = t->internal_data;
 
 			image_infos[sampler_index].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -388,7 +432,10 @@ void vulkan_object_shader_update_object(vulkan_context *context,
 			descriptor_writes[descriptor_count] = descriptor;
 			descriptor_count++;
 
-			if (t->generation != INVALID_ID) { *descriptor_generation = t->generation; }
+			if (t->generation != INVALID_ID) {
+				*descriptor_generation = t->generation;
+				*descriptor_id         = t->id;
+			}
 
 			descriptor_index++;
 		}
@@ -418,6 +465,7 @@ b8 vulkan_object_shader_acquire_resources(vulkan_context *context, vulkan_object
 	for (u32 i = 0; i < VULKAN_OBJECT_SHADER_DESCRIPTOR_COUNT; ++i) {
 		for (u32 j = 0; j < DISPLAY_BUFFER_COUNT; ++j) {
 			object_state->descriptor_states[i].generations[j] = INVALID_ID;
+			object_state->descriptor_states[i].ids[j]         = INVALID_ID;
 		}
 	}
 
@@ -457,6 +505,7 @@ void vulkan_object_shader_release_resources(vulkan_context *context, vulkan_obje
 	for (u32 i = 0; i < VULKAN_OBJECT_SHADER_DESCRIPTOR_COUNT; ++i) {
 		for (u32 j = 0; j < DISPLAY_BUFFER_COUNT; ++j) {
 			object_state->descriptor_states[i].generations[j] = INVALID_ID;
+			object_state->descriptor_states[i].ids[j]         = INVALID_ID;
 		}
 	}
 
@@ -7,6 +7,12 @@ b8 vulkan_object_shader_create(vulkan_context *context, vulkan_object_shader *ou
 
 void vulkan_object_shader_destroy(vulkan_context *context, vulkan_object_shader *shader);
 
+// Rebuilds the shader modules and pipeline from the current SPIR-V. The device must be idle.
+b8 vulkan_object_shader_reload(vulkan_context *context, vulkan_object_shader *shader);
+
+// Whether the asset with this name hash is one of the shader's stages, see EVENT_CODE_ASSET_CHANGED.
+b8 vulkan_object_shader_uses_asset(u64 name_hash);
+
 void vulkan_object_shader_use(vulkan_context *context, vulkan_object_shader *shader);
 
 void vulkan_object_shader_update_global_state(vulkan_context *context, vulkan_object_shader *shader, f32 delta_time);
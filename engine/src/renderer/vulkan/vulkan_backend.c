@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "vulkan_backend.h"
 
 #include "defines.h"
@@ -15,6 +17,7 @@
 
 #include "core/application.h"
 #include "core/asserts.h"
+#include "core/event.h"
 #include "core/logger.h"
 #include "core/smemory.h"
 #include "core/sstring.h"
@@ -23,6 +26,9 @@
 
 #include "containers/darray.h"
 
+#include "resources/block_compression.h"
+#include "resources/mipmap.h"
+
 // Shaders
 #include "shaders/vulkan_object_shader.h"
 
@@ -43,6 +49,8 @@ void create_command_buffers(renderer_backend *backend);
 void regenerate_framebuffers(renderer_backend *backend, vulkan_swapchain *swapchain, vulkan_render_pass *render_pass);
 b8 recreate_swapchain(renderer_backend *backend);
 
+b8 on_asset_changed(u16 code, void *sender, void *listener_instance, event_context data);
+
 void upload_data_range(vulkan_context *context,
 					   VkCommandPool pool,
 					   VkFence fence,
@@ -50,7 +58,7 @@ void upload_data_range(vulkan_context *context,
 					   vulkan_buffer *buffer,
 					   u64 offset,
 					   u64 size,
-					   void *data);
+					   const void *data);
 
 b8 vulkan_renderer_backend_initialize(renderer_backend *backend, const char *application_name) {
 	// Function pointers
@@ -229,72 +237,20 @@ b8 vulkan_renderer_backend_initialize(renderer_backend *backend, const char *app
 		SERROR("Error loading built-in shader.");
 		return false;
 	}
+	if (!event_register(EVENT_CODE_ASSET_CHANGED, &context, on_asset_changed)) {
+		SWARN("Couldn't listen for asset changes, shaders won't be hot reloaded.");
+	}
 
 	create_buffers(&context);
 
 	SINFO("Vulkan renderer initialized successfully.");
 
 	// WARN: temporary test code
-	const u32 vert_count = 4;
-	vertex_3d verts[vert_count];
-	szero_memory(verts, sizeof(vertex_3d) * vert_count);
-
-	const f32 f = 10.0f;
-
-	verts[0].position.x           = -0.5f * f;
-	verts[0].position.y           = -0.5f * f;
-	verts[0].texture_coordinate.x = 0.0f;
-	verts[0].texture_coordinate.y = 0.0f;
-
-	verts[1].position.x           = 0.5f * f;
-	verts[1].position.y           = 0.5f * f;
-	verts[1].texture_coordinate.x = 1.0f;
-	verts[1].texture_coordinate.y = 1.0f;
-
-	verts[2].position.x           = -0.5f * f;
-	verts[2].position.y           = 0.5f * f;
-	verts[2].texture_coordinate.x = 0.0f;
-	verts[2].texture_coordinate.y = 1.0f;
-
-	verts[3].position.x           = 0.5f * f;
-	verts[3].position.y           = -0.5f * f;
-	verts[3].texture_coordinate.x = 1.0f;
-	verts[3].texture_coordinate.y = 0.0f;
-
-	const u32 index_count = 6;
-	u32 indices[index_count];
-	indices[0] = 0;
-	indices[1] = 1;
-	indices[2] = 2;
-	indices[3] = 0;
-	indices[4] = 3;
-	indices[5] = 1;
-
-	upload_data_range(&context,
-					  context.device.graphics_command_pool,
-					  0,
-					  context.device.graphics_queue,
-					  &context.object_vertex_buffer,
-					  0,
-					  sizeof(vertex_3d) * vert_count,
-					  verts);
-	upload_data_range(&context,
-					  context.device.graphics_command_pool,
-					  0,
-					  context.device.graphics_queue,
-					  &context.object_index_buffer,
-					  0,
-					  sizeof(u32) * index_count,
-					  indices);
-
 	u32 object_id = 0;
 	if (!vulkan_object_shader_acquire_resources(&context, &context.object_shader, &object_id)) {
 		SERROR("Failed to acquire shader resources.");
 		return false;
 	}
-
-	SDEBUG("Uploaded vertex data.");
-
 	// WARN: end temporary test code
 
 	return true;
@@ -305,9 +261,15 @@ void vulkan_renderer_backend_shutdown(renderer_backend *backend) {
 
 	vkDeviceWaitIdle(context.device.logical_device);
 
+	event_unregister(EVENT_CODE_ASSET_CHANGED, &context, on_asset_changed);
+
 	SINFO("Destroying object buffers...");
 	vulkan_buffer_destroy(&context, &context.object_vertex_buffer);
 	vulkan_buffer_destroy(&context, &context.object_index_buffer);
+	darray_destroy(context.free_vertex_ranges);
+	context.free_vertex_ranges = 0;
+	darray_destroy(context.free_index_ranges);
+	context.free_index_ranges = 0;
 
 	SINFO("Destroying object shader...");
 	vulkan_object_shader_destroy(&context, &context.object_shader);
@@ -573,22 +535,27 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend *backend, f32 delta_time)
 }
 
 void vulkan_renderer_update_object(geometry_render_data data) {
+	if (!data.geometry || !data.geometry->internal_data) { return; }
+
 	vulkan_object_shader_update_object(&context, &context.object_shader, data);
 
 	// WARN: temporary test code
 	vulkan_object_shader_use(&context, &context.object_shader);
+	// WARN: end temporary test code
 
 	vulkan_command_buffer *command_buffer = &context.graphics_command_buffers[context.image_index];
+	vulkan_geometry_data *buffer_data     = data.geometry->internal_data;
 
 	VkDeviceSize offsets[1];
-	offsets[0] = 0;
+	offsets[0] = buffer_data->vertices.offset;
 	vkCmdBindVertexBuffers(command_buffer->handle, 0, 1, &context.object_vertex_buffer.handle, (VkDeviceSize *)offsets);
 
-	vkCmdBindIndexBuffer(command_buffer->handle, context.object_index_buffer.handle, 0, VK_INDEX_TYPE_UINT32);
-
-	vkCmdDrawIndexed(command_buffer->handle, 6, 1, 0, 0, 0);
+	vkCmdBindIndexBuffer(command_buffer->handle,
+						 context.object_index_buffer.handle,
+						 buffer_data->indices.offset,
+						 VK_INDEX_TYPE_UINT32);
 
-	// WARN: end temporary test code
+	vkCmdDrawIndexed(command_buffer->handle, data.geometry->index_count, 1, 0, 0, 0);
 }
 
 VKAPI_ATTR VkBool32 VKAPI_CALL vk_debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
@@ -598,21 +565,24 @@ VKAPI_ATTR VkBool32 VKAPI_CALL vk_debug_callback(VkDebugUtilsMessageSeverityFlag
 	(void)user_data;
 	(void)message_types;
 
+	// Validation messages go to their own category, so they can be made verbose without the rest of the renderer.
+	log_level level;
 	switch (message_severity) {
 		default:
 		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-			SERROR(callback_data->pMessage);
+			level = LOG_LEVEL_ERROR;
 			break;
 		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-			SWARN(callback_data->pMessage);
+			level = LOG_LEVEL_WARN;
 			break;
 		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-			SINFO(callback_data->pMessage);
+			level = LOG_LEVEL_INFO;
 			break;
 		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-			STRACE(callback_data->pMessage);
+			level = LOG_LEVEL_TRACE;
 			break;
 	}
+	SLOG(LOG_CATEGORY_VULKAN, level, "%s", callback_data->pMessage);
 	return VK_FALSE;
 }
 
@@ -736,6 +706,25 @@ b8 recreate_swapchain(renderer_backend *backend) {
 	return true;
 }
 
+// Hot reload. Only what was built from the changed file is rebuilt.
+b8 on_asset_changed(u16 code, void *sender, void *listener_instance, event_context data) {
+	(void)code;
+	(void)sender;
+	(void)listener_instance;
+
+	if (vulkan_object_shader_uses_asset(data.data.u64[0])) {
+		vkDeviceWaitIdle(context.device.logical_device);
+		if (vulkan_object_shader_reload(&context, &context.object_shader)) {
+			SINFO("Object shader reloaded.");
+		} else {
+			SERROR("Object shader reload failed, the previous version stays in use.");
+		}
+	}
+
+	// Other systems may own assets with the same name.
+	return false;
+}
+
 b8 create_buffers(vulkan_context *context) {
 	VkMemoryPropertyFlagBits memory_property_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
@@ -750,7 +739,8 @@ b8 create_buffers(vulkan_context *context) {
 		SERROR("Error creating vertex buffer.");
 		return false;
 	}
-	context->geometry_vertex_offset = 0;
+	context->free_vertex_ranges = darray_create(vulkan_buffer_range);
+	darray_push(context->free_vertex_ranges, ((vulkan_buffer_range){.offset = 0, .size = vertex_buffer_size}));
 
 	const u64 index_buffer_size = MEBIBYTES(sizeof(u32));
 	if (!vulkan_buffer_create(context,
@@ -763,7 +753,8 @@ b8 create_buffers(vulkan_context *context) {
 		SERROR("Error creating index buffer.");
 		return false;
 	}
-	context->geometry_index_offset = 0;
+	context->free_index_ranges = darray_create(vulkan_buffer_range);
+	darray_push(context->free_index_ranges, ((vulkan_buffer_range){.offset = 0, .size = index_buffer_size}));
 
 	return true;
 }
@@ -775,7 +766,7 @@ void upload_data_range(vulkan_context *context,
 					   vulkan_buffer *buffer,
 					   u64 offset,
 					   u64 size,
-					   void *data) {
+					   const void *data) {
 	VkBufferUsageFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 	vulkan_buffer staging;
 	vulkan_buffer_create(context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, flags, true, &staging);
@@ -795,6 +786,85 @@ void vulkan_renderer_create_texture(const char *name,
 									const u8 *pixels,
 									b8 has_transparency,
 									texture *out_texture) {
+	texture_staging staging;
+	u64 image_size = (u64)width * height * (u32)channel_count;
+	if (!vulkan_renderer_create_texture_staging(image_size, &staging)) {
+		SERROR("Unable to create texture staging buffer.");
+		return;
+	}
+
+	scopy_memory(staging.pixels, pixels, image_size);
+	vulkan_renderer_create_texture_from_staging(name,
+												auto_release,
+												width,
+												height,
+												channel_count,
+												TEXTURE_FORMAT_RGBA8,
+												1,
+												&staging,
+												has_transparency,
+												out_texture);
+	vulkan_renderer_destroy_texture_staging(&staging);
+}
+
+b8 vulkan_renderer_create_texture_staging(u64 size, texture_staging *out_staging) {
+	vulkan_buffer *buffer = sallocate(sizeof(vulkan_buffer), MEMORY_TAG_RENDERER);
+
+	VkBufferUsageFlags buffer_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	VkMemoryPropertyFlags memory_property_flags =
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	if (!vulkan_buffer_create(&context, size, buffer_usage, memory_property_flags, true, buffer)) {
+		sfree(buffer, sizeof(vulkan_buffer), MEMORY_TAG_RENDERER);
+		return false;
+	}
+
+	// Coherent memory, so writes made before the upload is submitted need no flush.
+	out_staging->size          = size;
+	out_staging->pixels        = vulkan_buffer_lock_memory(&context, buffer, 0, size, 0);
+	out_staging->internal_data = buffer;
+	return true;
+}
+
+void vulkan_renderer_destroy_texture_staging(texture_staging *staging) {
+	vulkan_buffer *buffer = staging->internal_data;
+	vulkan_buffer_unlock_memory(&context, buffer);
+	vulkan_buffer_destroy(&context, buffer);
+	sfree(buffer, sizeof(vulkan_buffer), MEMORY_TAG_RENDERER);
+	szero_memory(staging, sizeof(texture_staging));
+}
+
+static VkFormat texture_format_to_vulkan(texture_format format) {
+	switch (format) {
+		case TEXTURE_FORMAT_BC1:
+			return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case TEXTURE_FORMAT_BC3:
+			return VK_FORMAT_BC3_UNORM_BLOCK;
+		case TEXTURE_FORMAT_BC7:
+			return VK_FORMAT_BC7_UNORM_BLOCK;
+		default:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+b8 vulkan_renderer_texture_format_supported(texture_format format) {
+	if (format == TEXTURE_FORMAT_RGBA8) { return true; }
+	if (format >= TEXTURE_FORMAT_COUNT || !context.device.features.textureCompressionBC) { return false; }
+
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(context.device.physical_device, texture_format_to_vulkan(format), &properties);
+	return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+void vulkan_renderer_create_texture_from_staging(const char *name,
+												 b8 auto_release,
+												 u32 width,
+												 u32 height,
+												 i32 channel_count,
+												 texture_format format,
+												 u32 level_count,
+												 const texture_staging *staging,
+												 b8 has_transparency,
+												 texture *out_texture) {
 	(void)name;
 	(void)auto_release;
 
@@ -803,28 +873,29 @@ void vulkan_renderer_create_texture(const char *name,
 	out_texture->channel_count = (u8)channel_count;
 	out_texture->generation    = INVALID_ID;
 
-	out_texture->internal_data = sallocate(sizeof(vulkan_texture_data), MEMORY_TAG_TEXTURE);
-	vulkan_texture_data *data  = out_texture->internal_data;
-	VkDeviceSize image_size    = width * height * (u32)channel_count;
-
-	VkFormat image_format = VK_FORMAT_R8G8B8A8_UNORM;
+	out_texture->internal_data    = sallocate(sizeof(vulkan_texture_data), MEMORY_TAG_TEXTURE);
+	vulkan_texture_data *data     = out_texture->internal_data;
+	vulkan_buffer *staging_buffer = staging->internal_data;
 
-	VkBufferUsageFlags buffer_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-	VkMemoryPropertyFlags memory_property_flags =
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-	vulkan_buffer staging_buffer;
-	vulkan_buffer_create(&context, image_size, buffer_usage, memory_property_flags, true, &staging_buffer);
+	VkFormat image_format = texture_format_to_vulkan(format);
+	// A lone uncompressed level gets the rest of its chain blitted, cooked textures bring their own.
+	b8 generate_mips = format == TEXTURE_FORMAT_RGBA8 && level_count == 1;
+	u32 mip_levels   = level_count;
+	if (generate_mips) { mip_levels = vulkan_image_mip_level_count(&context, image_format, width, height); }
 
-	vulkan_buffer_load_data(&context, &staging_buffer, 0, image_size, 0, pixels);
+	// Block compressed formats can't be rendered to.
+	VkImageUsageFlags usage =
+		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	if (!texture_format_is_compressed(format)) { usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; }
 
 	vulkan_image_create(&context,
 						VK_IMAGE_TYPE_2D,
 						width,
 						height,
+						mip_levels,
 						image_format,
 						VK_IMAGE_TILING_OPTIMAL,
-						VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
-							| VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+						usage,
 						VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 						true,
 						VK_IMAGE_ASPECT_COLOR_BIT,
@@ -842,19 +913,29 @@ void vulkan_renderer_create_texture(const char *name,
 								   VK_IMAGE_LAYOUT_UNDEFINED,
 								   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-	vulkan_image_copy_from_buffer(&context, &data->image, staging_buffer.handle, &temp_buffer);
+	u64 level_offset = 0;
+	for (u32 level = 0; level < level_count; ++level) {
+		VkBuffer buffer = staging_buffer->handle;
+		vulkan_image_copy_from_buffer(&context, &data->image, buffer, level_offset, level, &temp_buffer);
+		level_offset += texture_format_level_size(format,
+												  mip_level_dimension(width, level),
+												  mip_level_dimension(height, level));
+	}
 
-	vulkan_image_transition_layout(&context,
-								   &temp_buffer,
-								   &data->image,
-								   image_format,
-								   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-								   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	// The smaller levels are filtered from the first in the same submission.
+	if (generate_mips && mip_levels > 1) {
+		vulkan_image_generate_mipmaps(&context, &temp_buffer, &data->image);
+	} else {
+		vulkan_image_transition_layout(&context,
+									   &temp_buffer,
+									   &data->image,
+									   image_format,
+									   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+									   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
 
 	vulkan_command_buffer_end_single_use(&context, pool, &temp_buffer, queue);
 
-	vulkan_buffer_destroy(&context, &staging_buffer);
-
 	VkSamplerCreateInfo sampler_info = {
 		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
 		// TODO: These filters should be configurable.
@@ -872,7 +953,7 @@ void vulkan_renderer_create_texture(const char *name,
 		.mipmapMode              = VK_SAMPLER_MIPMAP_MODE_LINEAR,
 		.mipLodBias              = 0.0f,
 		.minLod                  = 0.0f,
-		.maxLod                  = 0.0f,
+		.maxLod                  = (f32)mip_levels,
 	};
 
 	VkResult result = vkCreateSampler(context.device.logical_device, &sampler_info, context.allocator, &data->sampler);
@@ -898,3 +979,105 @@ void vulkan_renderer_destroy_texture(texture *texture) {
 	sfree(texture->internal_data, sizeof(vulkan_texture_data), MEMORY_TAG_TEXTURE);
 	szero_memory(texture, sizeof(struct texture));
 }
+
+static void remove_range(vulkan_buffer_range *ranges, u64 index) {
+	u64 count     = darray_length(ranges);
+	ranges[index] = ranges[count - 1];
+	darray_length_set(ranges, count - 1);
+}
+
+// Takes size bytes from the first free range large enough. @returns False if none is.
+static b8 allocate_range(vulkan_buffer_range *free_ranges, u64 size, vulkan_buffer_range *out_range) {
+	for (u64 i = 0; i < darray_length(free_ranges); ++i) {
+		vulkan_buffer_range *range = &free_ranges[i];
+		if (range->size < size) { continue; }
+
+		out_range->offset = range->offset;
+		out_range->size   = size;
+		range->offset    += size;
+		range->size      -= size;
+		if (range->size == 0) { remove_range(free_ranges, i); }
+		return true;
+	}
+	return false;
+}
+
+// Gives a range back, merged with the free ranges either side of it so the buffer doesn't fragment.
+static void free_range(vulkan_buffer_range **free_ranges, vulkan_buffer_range range) {
+	vulkan_buffer_range *ranges = *free_ranges;
+	u64 i                       = 0;
+	while (i < darray_length(ranges)) {
+		if (ranges[i].offset + ranges[i].size == range.offset) {
+			range.offset  = ranges[i].offset;
+			range.size   += ranges[i].size;
+			remove_range(ranges, i);
+		} else if (range.offset + range.size == ranges[i].offset) {
+			range.size += ranges[i].size;
+			remove_range(ranges, i);
+		} else {
+			i++;
+		}
+	}
+	darray_push(*free_ranges, range);
+}
+
+b8 vulkan_renderer_create_geometry(u32 vertex_count,
+								   const vertex_3d *vertices,
+								   u32 index_count,
+								   const u32 *indices,
+								   geometry *out_geometry) {
+	if (vertex_count == 0 || !vertices || index_count == 0 || !indices) {
+		SERROR("vulkan_renderer_create_geometry - Geometry needs vertices and indices.");
+		return false;
+	}
+
+	vulkan_geometry_data data;
+	if (!allocate_range(context.free_vertex_ranges, sizeof(vertex_3d) * vertex_count, &data.vertices)) {
+		SERROR("vulkan_renderer_create_geometry - No room for %u vertices in the vertex buffer.", vertex_count);
+		return false;
+	}
+	if (!allocate_range(context.free_index_ranges, sizeof(u32) * index_count, &data.indices)) {
+		SERROR("vulkan_renderer_create_geometry - No room for %u indices in the index buffer.", index_count);
+		free_range(&context.free_vertex_ranges, data.vertices);
+		return false;
+	}
+
+	VkCommandPool pool = context.device.graphics_command_pool;
+	VkQueue queue      = context.device.graphics_queue;
+	upload_data_range(&context,
+					  pool,
+					  0,
+					  queue,
+					  &context.object_vertex_buffer,
+					  data.vertices.offset,
+					  data.vertices.size,
+					  vertices);
+	upload_data_range(&context,
+					  pool,
+					  0,
+					  queue,
+					  &context.object_index_buffer,
+					  data.indices.offset,
+					  data.indices.size,
+					  indices);
+
+	out_geometry->internal_data = sallocate(sizeof(vulkan_geometry_data), MEMORY_TAG_RENDERER);
+	scopy_memory(out_geometry->internal_data, &data, sizeof(vulkan_geometry_data));
+	out_geometry->vertex_count = vertex_count;
+	out_geometry->index_count  = index_count;
+	out_geometry->generation++;
+	return true;
+}
+
+void vulkan_renderer_destroy_geometry(geometry *geometry) {
+	// Frames in flight may still draw from its ranges.
+	vkDeviceWaitIdle(context.device.logical_device);
+
+	vulkan_geometry_data *data = geometry->internal_data;
+	if (data) {
+		free_range(&context.free_vertex_ranges, data->vertices);
+		free_range(&context.free_index_ranges, data->indices);
+		sfree(data, sizeof(vulkan_geometry_data), MEMORY_TAG_RENDERER);
+	}
+	szero_memory(geometry, sizeof(struct geometry));
+}
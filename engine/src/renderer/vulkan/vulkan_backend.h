@@ -21,3 +21,24 @@ void vulkan_renderer_create_texture(const char *name,
 									b8 has_transparency,
 									texture *out_texture);
 void vulkan_renderer_destroy_texture(texture *texture);
+
+b8 vulkan_renderer_create_texture_staging(u64 size, texture_staging *out_staging);
+void vulkan_renderer_destroy_texture_staging(texture_staging *staging);
+void vulkan_renderer_create_texture_from_staging(const char *name,
+												 b8 auto_release,
+												 u32 width,
+												 u32 height,
+												 i32 channel_count,
+												 texture_format format,
+												 u32 level_count,
+												 const texture_staging *staging,
+												 b8 has_transparency,
+												 texture *out_texture);
+b8 vulkan_renderer_texture_format_supported(texture_format format);
+
+b8 vulkan_renderer_create_geometry(u32 vertex_count,
+								   const vertex_3d *vertices,
+								   u32 index_count,
+								   const u32 *indices,
+								   geometry *out_geometry);
+void vulkan_renderer_destroy_geometry(geometry *geometry);
@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "vulkan_buffer.h"
 
 #include "vulkan_command_buffer.h"
@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "vulkan_device.h"
 
 #include "core/logger.h"
@@ -76,6 +78,8 @@ b8 vulkan_device_create(vulkan_context *context) {
 	VkPhysicalDeviceFeatures device_features = {};
 	device_features.samplerAnisotropy        = VK_TRUE; // Request anisotropy
 	device_features.geometryShader           = VK_TRUE; // Request geometryShader
+	// Cooked textures are only uploaded in BC formats when the device reports them.
+	device_features.textureCompressionBC = context->device.features.textureCompressionBC;
 
 	const char *extension_names = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
 
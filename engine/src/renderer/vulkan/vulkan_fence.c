@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "vulkan_fence.h"
 
 #include "core/logger.h"
@@ -1,14 +1,18 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "vulkan_image.h"
 
 #include "vulkan_device.h"
 
 #include "core/logger.h"
+#include "resources/mipmap.h"
 #include <vulkan/vulkan_core.h>
 
 void vulkan_image_create(vulkan_context *context,
 						 VkImageType image_type,
 						 u32 width,
 						 u32 height,
+						 u32 mip_levels,
 						 VkFormat format,
 						 VkImageTiling tiling,
 						 VkImageUsageFlags usage,
@@ -19,8 +23,9 @@ void vulkan_image_create(vulkan_context *context,
 	(void)image_type;
 
 	// Copy params
-	out_image->width  = width;
-	out_image->height = height;
+	out_image->width      = width;
+	out_image->height     = height;
+	out_image->mip_levels = mip_levels;
 
 	VkImageCreateInfo image_create_info = {
 		.sType     = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
@@ -31,7 +36,7 @@ void vulkan_image_create(vulkan_context *context,
 				.height = height,
 				.depth  = 1, // TODO: Make configurable
 			},
-		.mipLevels     = 4, // TODO: Support mip-mapping
+		.mipLevels     = mip_levels,
 		.arrayLayers   = 1, // TODO: Support image layers
 		.format        = format,
 		.tiling        = tiling,
@@ -89,7 +94,7 @@ void vulkan_image_view_create(vulkan_context *context,
 
 				// TODO: Make configurable.
 				.baseMipLevel   = 0,
-				.levelCount     = 1,
+				.levelCount     = image->mip_levels,
 				.baseArrayLayer = 0,
 				.layerCount     = 1,
 			},
@@ -117,7 +122,7 @@ void vulkan_image_transition_layout(vulkan_context *context,
 			{
 				.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
 				.baseMipLevel   = 0,
-				.levelCount     = 1,
+				.levelCount     = image->mip_levels,
 				.baseArrayLayer = 0,
 				.layerCount     = 1,
 			},
@@ -161,26 +166,28 @@ void vulkan_image_transition_layout(vulkan_context *context,
 void vulkan_image_copy_from_buffer(vulkan_context *context,
 								   vulkan_image *image,
 								   VkBuffer buffer,
+								   u64 buffer_offset,
+								   u32 mip_level,
 								   vulkan_command_buffer *command_buffer) {
 	(void)context;
 
 	VkBufferImageCopy region = {
-		.bufferOffset      = 0,
+		.bufferOffset      = buffer_offset,
 		.bufferRowLength   = 0,
 		.bufferImageHeight = 0,
 
 		.imageSubresource =
 			{
 				.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-				.mipLevel       = 0,
+				.mipLevel       = mip_level,
 				.baseArrayLayer = 0,
 				.layerCount     = 1,
 			},
 
 		.imageExtent =
 			{
-				.width  = image->width,
-				.height = image->height,
+				.width  = mip_level_dimension(image->width, mip_level),
+				.height = mip_level_dimension(image->height, mip_level),
 				.depth  = 1,
 			},
 	};
@@ -193,6 +200,123 @@ void vulkan_image_copy_from_buffer(vulkan_context *context,
 						   &region);
 }
 
+u32 vulkan_image_mip_level_count(vulkan_context *context, VkFormat format, u32 width, u32 height) {
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(context->device.physical_device, format, &properties);
+	// Every level is blitted from the one before, so the format has to be both a source and a destination.
+	VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+								  | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	if ((properties.optimalTilingFeatures & required) != required) {
+		SWARN("Format %d does not support linear blits, textures using it won't have mipmaps.", format);
+		return 1;
+	}
+	return mip_level_count(width, height);
+}
+
+void vulkan_image_generate_mipmaps(vulkan_context *context,
+								   vulkan_command_buffer *command_buffer,
+								   vulkan_image *image) {
+	VkImageMemoryBarrier barrier = {
+		.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.srcQueueFamilyIndex = context->device.graphics_queue_index,
+		.dstQueueFamilyIndex = context->device.graphics_queue_index,
+		.image               = image->handle,
+		.subresourceRange =
+			{
+				.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+				.levelCount     = 1,
+				.baseArrayLayer = 0,
+				.layerCount     = 1,
+			},
+	};
+
+	i32 level_width  = (i32)image->width;
+	i32 level_height = (i32)image->height;
+	for (u32 level = 1; level < image->mip_levels; ++level) {
+		// The previous level is complete, read it for this one.
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask                 = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(command_buffer->handle,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 0,
+							 0,
+							 VK_NULL_HANDLE,
+							 0,
+							 VK_NULL_HANDLE,
+							 1,
+							 &barrier);
+
+		i32 next_width   = SMAX(1, level_width / 2);
+		i32 next_height  = SMAX(1, level_height / 2);
+		VkImageBlit blit = {
+			.srcSubresource =
+				{
+					.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel       = level - 1,
+					.baseArrayLayer = 0,
+					.layerCount     = 1,
+				},
+			.srcOffsets = {{0, 0, 0}, {level_width, level_height, 1}},
+			.dstSubresource =
+				{
+					.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel       = level,
+					.baseArrayLayer = 0,
+					.layerCount     = 1,
+				},
+			.dstOffsets = {{0, 0, 0}, {next_width, next_height, 1}},
+		};
+		vkCmdBlitImage(command_buffer->handle,
+					   image->handle,
+					   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					   image->handle,
+					   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					   1,
+					   &blit,
+					   VK_FILTER_LINEAR);
+
+		// Done with as a source, hand it to the shaders.
+		barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(command_buffer->handle,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+							 0,
+							 0,
+							 VK_NULL_HANDLE,
+							 0,
+							 VK_NULL_HANDLE,
+							 1,
+							 &barrier);
+
+		level_width  = next_width;
+		level_height = next_height;
+	}
+
+	// The last level was only ever written.
+	barrier.subresourceRange.baseMipLevel = image->mip_levels - 1;
+	barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(command_buffer->handle,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						 0,
+						 0,
+						 VK_NULL_HANDLE,
+						 0,
+						 VK_NULL_HANDLE,
+						 1,
+						 &barrier);
+}
+
 void vulkan_image_destroy(vulkan_context *context, vulkan_image *image) {
 	if (image->view) {
 		vkDestroyImageView(context->device.logical_device, image->view, context->allocator);
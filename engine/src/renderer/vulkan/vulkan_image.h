@@ -6,6 +6,7 @@ void vulkan_image_create(vulkan_context *context,
 						 VkImageType image_type,
 						 u32 width,
 						 u32 height,
+						 u32 mip_levels,
 						 VkFormat format,
 						 VkImageTiling tiling,
 						 VkImageUsageFlags usage,
@@ -26,9 +27,24 @@ void vulkan_image_transition_layout(vulkan_context *context,
 									VkImageLayout old_layout,
 									VkImageLayout new_layout);
 
+// Copies one mip level, tightly packed at buffer_offset, into the image.
 void vulkan_image_copy_from_buffer(vulkan_context *context,
 								   vulkan_image *image,
 								   VkBuffer buffer,
+								   u64 buffer_offset,
+								   u32 mip_level,
 								   vulkan_command_buffer *command_buffer);
 
+// Levels in a full mip chain for an image this size, or 1 if the format can't be blitted with linear filtering.
+u32 vulkan_image_mip_level_count(vulkan_context *context, VkFormat format, u32 width, u32 height);
+
+/**
+ * Fills every mip level after the first by blitting each from the one before, then transitions the whole image to
+ * VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. Level 0 must hold the pixels and every level be in
+ * VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL.
+ */
+void vulkan_image_generate_mipmaps(vulkan_context *context,
+								   vulkan_command_buffer *command_buffer,
+								   vulkan_image *image);
+
 void vulkan_image_destroy(vulkan_context *context, vulkan_image *image);
@@ -1,9 +1,12 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "vulkan_shader_module.h"
 
 #include "core/filesystem.h"
 #include "core/logger.h"
 #include "core/smemory.h"
 #include "core/sstring.h"
+#include "resources/pack.h"
 
 b8 shader_module_create(vulkan_context *context,
 						char const *name,
@@ -12,28 +15,20 @@ b8 shader_module_create(vulkan_context *context,
 						u32 stage_index,
 						vulkan_shader_stage *shader_stages) {
 	char file_name[512];
-	string_format(file_name, "assets/shaders/%s.%s.spv", name, type_str);
+	string_format_n(file_name, sizeof(file_name), "shaders/%s.%s.spv", name, type_str);
 
 	szero_memory(&shader_stages[stage_index].create_info, sizeof(VkShaderModuleCreateInfo));
 	shader_stages[stage_index].create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 
-	file_handle handle;
-	if (!filesystem_open(file_name, FILE_MODE_READ, true, &handle)) {
+	// SPIR-V is read straight from the mapping, vkCreateShaderModule copies what it needs.
+	file_view view;
+	if (!asset_map(file_name, &view)) {
 		SERROR("Unable to open file: %s.", file_name);
 		return false;
 	}
 
-	u64 size        = 0;
-	u8 *file_buffer = 0;
-	if (!filesystem_read_all_bytes(&handle, &file_buffer, &size)) {
-		SERROR("Unable to read shader module: %s.", file_name);
-		return false;
-	}
-
-	shader_stages[stage_index].create_info.codeSize = size;
-	shader_stages[stage_index].create_info.pCode    = (u32 *)file_buffer;
-
-	filesystem_close(&handle);
+	shader_stages[stage_index].create_info.codeSize = view.size;
+	shader_stages[stage_index].create_info.pCode    = (const u32 *)view.data;
 
 	VK_CHECK(vkCreateShaderModule(context->device.logical_device,
 								  &shader_stages[stage_index].create_info,
@@ -48,10 +43,7 @@ b8 shader_module_create(vulkan_context *context,
 		.pName  = "main",
 	};
 
-	if (file_buffer) {
-		sfree(file_buffer, sizeof(u8) * size, MEMORY_TAG_STRING);
-		file_buffer = 0;
-	}
+	asset_unmap(&view);
 
 	return true;
 }
@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
 #include "vulkan_swapchain.h"
 
 #include "vulkan_device.h"
@@ -210,6 +212,7 @@ void create(vulkan_context *context, u32 width, u32 height, b8 use_old_swapchain
 						VK_IMAGE_TYPE_2D,
 						swapchain_extent.width,
 						swapchain_extent.height,
+						1,
 						context->device.depth_format,
 						VK_IMAGE_TILING_OPTIMAL,
 						VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
@@ -25,6 +25,12 @@ typedef struct vulkan_buffer {
 	u32 memory_property_flags;
 } vulkan_buffer;
 
+// A range of bytes in a vulkan_buffer.
+typedef struct vulkan_buffer_range {
+	u64 offset;
+	u64 size;
+} vulkan_buffer_range;
+
 typedef struct vulkan_swapchain_support_info {
 	VkSurfaceCapabilitiesKHR capabilities;
 	u32 format_count;
@@ -64,6 +70,7 @@ typedef struct vulkan_image {
 	VkImageView view;
 	u32 width;
 	u32 height;
+	u32 mip_levels;
 } vulkan_image;
 
 typedef enum vulkan_render_pass_state {
@@ -141,6 +148,8 @@ typedef struct vulkan_pipeline {
 
 typedef struct vulkan_descriptor_state {
 	u32 generations[DISPLAY_BUFFER_COUNT];
+	// Texture ids, so swapping in a different texture with the same generation still updates the descriptor.
+	u32 ids[DISPLAY_BUFFER_COUNT];
 } vulkan_descriptor_state;
 
 typedef struct vulkan_object_shader_object_state {
@@ -220,12 +229,19 @@ typedef struct vulkan_context {
 
 	vulkan_object_shader object_shader;
 
-	u64 geometry_vertex_offset;
-	u64 geometry_index_offset;
+	// darrays of the parts of the object buffers no geometry uses, in no particular order.
+	vulkan_buffer_range *free_vertex_ranges;
+	vulkan_buffer_range *free_index_ranges;
 
 	i32 (*find_memory_index)(u32 type_filter, u32 property_flags);
 } vulkan_context;
 
+// Where a geometry's vertices and indices live in the object buffers.
+typedef struct vulkan_geometry_data {
+	vulkan_buffer_range vertices;
+	vulkan_buffer_range indices;
+} vulkan_geometry_data;
+
 typedef struct vulkan_texture_data {
 	vulkan_image image;
 	VkSampler sampler;
@@ -0,0 +1,836 @@
+#include "block_compression.h"
+
+#include <math.h>
+#include <string.h>
+
+// Power iterations for a block's principal axis, it converges quickly for 16 texels.
+#define AXIS_ITERATIONS 8
+// Least squares passes over the endpoints once indices are chosen.
+#define REFINE_ITERATIONS 2
+
+static inline i32 clamp_i32(i32 value, i32 min, i32 max) { return value < min ? min : (value > max ? max : value); }
+
+u64 texture_format_level_size(texture_format format, u32 width, u32 height) {
+	u64 blocks = (u64)((width + 3) / 4) * ((height + 3) / 4);
+	switch (format) {
+		case TEXTURE_FORMAT_BC1: return blocks * 8;
+		case TEXTURE_FORMAT_BC3:
+		case TEXTURE_FORMAT_BC7: return blocks * 16;
+		default: return (u64)width * height * 4;
+	}
+}
+
+/**
+ * Mean and unit length principal axis of the used texels' first channel_count channels, by power iteration on
+ * their covariance. The axis is left at zero for blocks of a single colour.
+ */
+static void principal_axis(const u8 *texels, const b8 *used, u32 channel_count, f32 mean[4], f32 axis[4]) {
+	f32 count = 0;
+	for (u32 c = 0; c < 4; ++c) { mean[c] = axis[c] = 0; }
+	for (u32 i = 0; i < 16; ++i) {
+		if (!used[i]) { continue; }
+		for (u32 c = 0; c < channel_count; ++c) { mean[c] += texels[i * 4 + c]; }
+		count += 1.0f;
+	}
+	if (count == 0) { return; }
+	for (u32 c = 0; c < channel_count; ++c) { mean[c] /= count; }
+
+	f32 covariance[4][4] = {{0}};
+	f32 min[4]           = {255, 255, 255, 255};
+	f32 max[4]           = {0};
+	for (u32 i = 0; i < 16; ++i) {
+		if (!used[i]) { continue; }
+		for (u32 a = 0; a < channel_count; ++a) {
+			f32 da = texels[i * 4 + a] - mean[a];
+			for (u32 b = a; b < channel_count; ++b) { covariance[a][b] += da * (texels[i * 4 + b] - mean[b]); }
+			min[a] = SMIN(min[a], texels[i * 4 + a]);
+			max[a] = SMAX(max[a], texels[i * 4 + a]);
+		}
+	}
+	for (u32 a = 0; a < channel_count; ++a) {
+		for (u32 b = 0; b < a; ++b) { covariance[a][b] = covariance[b][a]; }
+	}
+
+	// The bounding box's diagonal is a good first guess, and never orthogonal to the answer in practice.
+	f32 vector[4] = {0};
+	for (u32 c = 0; c < channel_count; ++c) { vector[c] = max[c] - min[c]; }
+	for (u32 iteration = 0; iteration < AXIS_ITERATIONS; ++iteration) {
+		f32 next[4] = {0};
+		f32 largest = 0;
+		for (u32 a = 0; a < channel_count; ++a) {
+			for (u32 b = 0; b < channel_count; ++b) { next[a] += covariance[a][b] * vector[b]; }
+			f32 magnitude = next[a] < 0 ? -next[a] : next[a];
+			largest       = SMAX(largest, magnitude);
+		}
+		if (largest < 1e-6f) { return; }
+		for (u32 c = 0; c < channel_count; ++c) { vector[c] = next[c] / largest; }
+	}
+
+	f32 length = 0;
+	for (u32 c = 0; c < channel_count; ++c) { length += vector[c] * vector[c]; }
+	length = sqrtf(length);
+	for (u32 c = 0; c < channel_count; ++c) { axis[c] = vector[c] / length; }
+}
+
+// Where the used texels fall along the axis, relative to the mean.
+static void project_extents(const u8 *texels,
+							const b8 *used,
+							u32 channel_count,
+							const f32 mean[4],
+							const f32 axis[4],
+							f32 *out_min,
+							f32 *out_max) {
+	*out_min = 0;
+	*out_max = 0;
+	for (u32 i = 0; i < 16; ++i) {
+		if (!used[i]) { continue; }
+		f32 t = 0;
+		for (u32 c = 0; c < channel_count; ++c) { t += (texels[i * 4 + c] - mean[c]) * axis[c]; }
+		*out_min = SMIN(*out_min, t);
+		*out_max = SMAX(*out_max, t);
+	}
+}
+
+/**
+ * Least squares endpoints for the chosen indices: minimises the sum of |w0 * e0 + w1 * e1 - texel|^2 where
+ * weights[index] is w0 and w1 = 1 - w0. @returns False if the system is degenerate, e.g. a single index used.
+ */
+static b8 refine_endpoints(const u8 *texels,
+						   const b8 *used,
+						   const u8 *indices,
+						   const f32 *weights,
+						   u32 channel_count,
+						   f32 e0[4],
+						   f32 e1[4]) {
+	f32 aa = 0, ab = 0, bb = 0;
+	f32 ap[4] = {0}, bp[4] = {0};
+	for (u32 i = 0; i < 16; ++i) {
+		if (!used[i]) { continue; }
+		f32 a = weights[indices[i]];
+		f32 b = 1.0f - a;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (u32 c = 0; c < channel_count; ++c) {
+			ap[c] += a * texels[i * 4 + c];
+			bp[c] += b * texels[i * 4 + c];
+		}
+	}
+
+	f32 determinant = aa * bb - ab * ab;
+	if (determinant < 1e-6f && determinant > -1e-6f) { return false; }
+	for (u32 c = 0; c < channel_count; ++c) {
+		e0[c] = (bb * ap[c] - ab * bp[c]) / determinant;
+		e1[c] = (aa * bp[c] - ab * ap[c]) / determinant;
+	}
+	return true;
+}
+
+// Picks the nearest of palette_count entries for every used texel. @returns The summed squared error.
+static u32 choose_indices(const u8 *texels,
+						  const b8 *used,
+						  u32 channel_count,
+						  const i32 (*palette)[4],
+						  u32 palette_count,
+						  u8 *out_indices) {
+	u32 total = 0;
+	for (u32 i = 0; i < 16; ++i) {
+		if (!used[i]) { continue; }
+		u32 best       = 0;
+		u32 best_error = 0xFFFFFFFFU;
+		for (u32 p = 0; p < palette_count; ++p) {
+			u32 error = 0;
+			for (u32 c = 0; c < channel_count; ++c) {
+				i32 d = (i32)texels[i * 4 + c] - palette[p][c];
+				error += (u32)(d * d);
+			}
+			if (error < best_error) {
+				best_error = error;
+				best       = p;
+			}
+		}
+		out_indices[i] = (u8)best;
+		total += best_error;
+	}
+	return total;
+}
+
+// ------------------------------------------
+// BC1 colour
+// ------------------------------------------
+
+static u16 pack_565(const f32 colour[3]) {
+	i32 r = clamp_i32((i32)(colour[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+	i32 g = clamp_i32((i32)(colour[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+	i32 b = clamp_i32((i32)(colour[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+	return (u16)((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(u16 packed, i32 out[4]) {
+	i32 r  = (packed >> 11) & 31;
+	i32 g  = (packed >> 5) & 63;
+	i32 b  = packed & 31;
+	out[0] = (r << 3) | (r >> 2);
+	out[1] = (g << 2) | (g >> 4);
+	out[2] = (b << 3) | (b >> 2);
+	out[3] = 255;
+}
+
+// Palette as decoders see it. In 3 colour mode the 4th entry is transparent black and never picked for colour.
+static void bc1_palette(u16 c0, u16 c1, b8 four_colours, i32 palette[4][4]) {
+	unpack_565(c0, palette[0]);
+	unpack_565(c1, palette[1]);
+	for (u32 c = 0; c < 3; ++c) {
+		if (four_colours) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+		} else {
+			palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = four_colours ? 255 : 0;
+}
+
+typedef struct bc1_candidate {
+	u16 c0;
+	u16 c1;
+	u8 indices[16];
+	u32 error;
+} bc1_candidate;
+
+static void bc1_evaluate(const u8 *texels,
+						 const b8 *used,
+						 b8 four_colours,
+						 const f32 e0[3],
+						 const f32 e1[3],
+						 bc1_candidate *out) {
+	out->c0 = pack_565(e0);
+	out->c1 = pack_565(e1);
+	i32 palette[4][4];
+	bc1_palette(out->c0, out->c1, four_colours, palette);
+	out->error = choose_indices(texels, used, 3, (const i32(*)[4])palette, four_colours ? 4 : 3, out->indices);
+}
+
+/**
+ * For blocks of a single colour 565 alone is too coarse, so pick each channel's endpoints for the 2/3 blend that
+ * lands closest to it, with every texel on index 2.
+ */
+static void bc1_solid_candidate(const u8 *texels, const b8 *used, const u8 colour[3], bc1_candidate *out) {
+	i32 endpoints[2][3];
+	for (u32 c = 0; c < 3; ++c) {
+		i32 bits    = c == 1 ? 6 : 5;
+		i32 max     = (1 << bits) - 1;
+		i32 nearest = (colour[c] * max + 127) / 255;
+		i32 best    = 0x7FFFFFFF;
+		for (i32 q0 = SMAX(nearest - 2, 0); q0 <= SMIN(nearest + 2, max); ++q0) {
+			for (i32 q1 = SMAX(nearest - 2, 0); q1 <= SMIN(nearest + 2, max); ++q1) {
+				i32 x0    = (q0 << (8 - bits)) | (q0 >> (2 * bits - 8));
+				i32 x1    = (q1 << (8 - bits)) | (q1 >> (2 * bits - 8));
+				i32 error = (2 * x0 + x1 + 1) / 3 - colour[c];
+				error     = error < 0 ? -error : error;
+				if (error < best) {
+					best            = error;
+					endpoints[0][c] = q0;
+					endpoints[1][c] = q1;
+				}
+			}
+		}
+	}
+
+	out->c0 = (u16)((endpoints[0][0] << 11) | (endpoints[0][1] << 5) | endpoints[0][2]);
+	out->c1 = (u16)((endpoints[1][0] << 11) | (endpoints[1][1] << 5) | endpoints[1][2]);
+	i32 palette[4][4];
+	bc1_palette(out->c0, out->c1, true, palette);
+	out->error = 0;
+	for (u32 i = 0; i < 16; ++i) {
+		out->indices[i] = 2;
+		for (u32 c = 0; c < 3; ++c) {
+			i32 d = (i32)texels[i * 4 + c] - palette[2][c];
+			out->error += used[i] ? (u32)(d * d) : 0;
+		}
+	}
+}
+
+/**
+ * Encodes the colour half of BC1 and BC3. With punch_through, texels with alpha under 128 become transparent
+ * black in 3 colour mode, otherwise the block is always written in 4 colour mode, as BC3 requires.
+ */
+static void encode_colour_block(const u8 texels[64], b8 punch_through, u8 out_block[8]) {
+	b8 used[16];
+	b8 transparent = false;
+	for (u32 i = 0; i < 16; ++i) {
+		used[i] = !punch_through || texels[i * 4 + 3] >= 128;
+		transparent |= !used[i];
+	}
+	b8 four_colours = !transparent;
+
+	f32 mean[4], axis[4], min, max;
+	principal_axis(texels, used, 3, mean, axis);
+	project_extents(texels, used, 3, mean, axis, &min, &max);
+
+	// Inset the extremes a little, they are rarely worth an endpoint of their own.
+	f32 inset = (max - min) / 16.0f;
+	f32 e0[4], e1[4];
+	for (u32 c = 0; c < 3; ++c) {
+		e0[c] = mean[c] + axis[c] * (max - inset);
+		e1[c] = mean[c] + axis[c] * (min + inset);
+	}
+
+	bc1_candidate best;
+	bc1_evaluate(texels, used, four_colours, e0, e1, &best);
+	if (four_colours && best.error > 0 && axis[0] == 0 && axis[1] == 0 && axis[2] == 0) {
+		bc1_candidate solid;
+		bc1_solid_candidate(texels, used, texels, &solid);
+		if (solid.error < best.error) { best = solid; }
+	}
+
+	// Decoders weigh endpoint 0 by these for each index.
+	static const f32 four_weights[4]  = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+	static const f32 three_weights[4] = {1.0f, 0.0f, 0.5f, 0.0f};
+	for (u32 iteration = 0; iteration < REFINE_ITERATIONS && best.error > 0; ++iteration) {
+		const f32 *weights = four_colours ? four_weights : three_weights;
+		if (!refine_endpoints(texels, used, best.indices, weights, 3, e0, e1)) { break; }
+		bc1_candidate candidate;
+		bc1_evaluate(texels, used, four_colours, e0, e1, &candidate);
+		if (candidate.error >= best.error) { break; }
+		best = candidate;
+	}
+
+	// The order of the endpoints selects the mode: c0 > c1 for 4 colours, c0 <= c1 for 3.
+	u16 c0 = best.c0;
+	u16 c1 = best.c1;
+	if (four_colours && c0 < c1) {
+		c0 = best.c1;
+		c1 = best.c0;
+		// 0 and 1 swap, and so do the thirds between them.
+		for (u32 i = 0; i < 16; ++i) { best.indices[i] ^= 1; }
+	} else if (four_colours && c0 == c1) {
+		// Can't be 4 colour, but every texel can take endpoint 0 in either mode.
+		for (u32 i = 0; i < 16; ++i) { best.indices[i] = 0; }
+	} else if (!four_colours && c0 > c1) {
+		c0 = best.c1;
+		c1 = best.c0;
+		for (u32 i = 0; i < 16; ++i) {
+			if (best.indices[i] < 2) { best.indices[i] ^= 1; }
+		}
+	}
+
+	u32 bits = 0;
+	for (u32 i = 0; i < 16; ++i) {
+		u32 index = used[i] ? best.indices[i] : 3;
+		bits |= index << (i * 2);
+	}
+	out_block[0] = (u8)(c0 & 0xFF);
+	out_block[1] = (u8)(c0 >> 8);
+	out_block[2] = (u8)(c1 & 0xFF);
+	out_block[3] = (u8)(c1 >> 8);
+	out_block[4] = (u8)(bits & 0xFF);
+	out_block[5] = (u8)((bits >> 8) & 0xFF);
+	out_block[6] = (u8)((bits >> 16) & 0xFF);
+	out_block[7] = (u8)(bits >> 24);
+}
+
+void bc1_compress_block(const u8 texels[64], u8 out_block[8]) { encode_colour_block(texels, true, out_block); }
+
+// ------------------------------------------
+// BC3 alpha
+// ------------------------------------------
+
+// a0 > a1 interpolates 8 values, otherwise 6 plus exact 0 and 255.
+static void alpha_palette(i32 a0, i32 a1, i32 palette[8]) {
+	palette[0] = a0;
+	palette[1] = a1;
+	if (a0 > a1) {
+		for (i32 i = 2; i < 8; ++i) { palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7; }
+	} else {
+		for (i32 i = 2; i < 6; ++i) { palette[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5; }
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+static u32 alpha_indices(const u8 texels[64], i32 a0, i32 a1, u8 indices[16]) {
+	i32 palette[8];
+	alpha_palette(a0, a1, palette);
+	u32 total = 0;
+	for (u32 i = 0; i < 16; ++i) {
+		u32 best_error = 0xFFFFFFFFU;
+		for (u32 p = 0; p < 8; ++p) {
+			i32 d     = (i32)texels[i * 4 + 3] - palette[p];
+			u32 error = (u32)(d * d);
+			if (error < best_error) {
+				best_error = error;
+				indices[i] = (u8)p;
+			}
+		}
+		total += best_error;
+	}
+	return total;
+}
+
+static void encode_alpha_block(const u8 texels[64], u8 out_block[8]) {
+	i32 min = 255, max = 0;
+	// Extremes ignoring exact 0 and 255, which the 6 value mode has for free.
+	i32 inner_min = 255, inner_max = 0;
+	for (u32 i = 0; i < 16; ++i) {
+		i32 a = texels[i * 4 + 3];
+		min   = SMIN(min, a);
+		max   = SMAX(max, a);
+		if (a != 0 && a != 255) {
+			inner_min = SMIN(inner_min, a);
+			inner_max = SMAX(inner_max, a);
+		}
+	}
+
+	u8 indices[16];
+	i32 a0    = max;
+	i32 a1    = min;
+	u32 error = alpha_indices(texels, a0, a1, indices);
+	if (error > 0 && inner_min <= inner_max) {
+		u8 six_indices[16];
+		u32 six_error = alpha_indices(texels, inner_min, inner_max, six_indices);
+		if (six_error < error) {
+			a0 = inner_min;
+			a1 = inner_max;
+			memcpy(indices, six_indices, sizeof(indices));
+		}
+	}
+
+	out_block[0] = (u8)a0;
+	out_block[1] = (u8)a1;
+	u64 bits     = 0;
+	for (u32 i = 0; i < 16; ++i) { bits |= (u64)indices[i] << (i * 3); }
+	for (u32 i = 0; i < 6; ++i) { out_block[2 + i] = (u8)(bits >> (i * 8)); }
+}
+
+void bc3_compress_block(const u8 texels[64], u8 out_block[16]) {
+	encode_alpha_block(texels, out_block);
+	encode_colour_block(texels, false, out_block + 8);
+}
+
+// ------------------------------------------
+// BC7 modes 1, 6 and 7
+// ------------------------------------------
+
+// Partitions of the closest line fits the two subset modes are encoded with, out of 64.
+#define BC7_PARTITION_CANDIDATES 4
+// Mode 6 error under which the two subset modes aren't tried, a mean squared error of 4 over every channel.
+#define BC7_SINGLE_SUBSET_ERROR (16 * 4 * 4)
+
+// Interpolation weights for 2, 3 and 4-bit indices, out of 64.
+static const i32 bc7_weights_2[4]  = {0, 21, 43, 64};
+static const i32 bc7_weights_3[8]  = {0, 9, 18, 27, 37, 46, 55, 64};
+static const i32 bc7_weights_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Texels in subset 1 of each two subset partition, bit i for texel i.
+static const u16 bc7_partitions[64] = {
+	0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8,
+	0xFF00, 0xFFF0, 0xF000, 0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110,
+	0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C, 0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696,
+	0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660, 0x0272, 0x04E4, 0x4E40, 0x2720,
+	0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22};
+
+// Subset 1's anchor texel in each partition, subset 0's is always texel 0.
+static const u8 bc7_anchors[64] = {15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+								   15, 2,  8,  2,  2,  8,  8,  15, 2,  8,  2,  2,  8,  8,  2,  2,
+								   15, 15, 6,  8,  2,  8,  15, 15, 2,  8,  2,  2,  2,  15, 15, 6,
+								   6,  2,  6,  8,  15, 15, 2,  2,  15, 15, 15, 15, 15, 2,  2,  15};
+
+typedef struct bc7_mode {
+	u32 number;
+	u32 subset_count;
+	// 3 for modes without alpha, which decodes as 255.
+	u32 channel_count;
+	u32 endpoint_bits;
+	// The two endpoints of a subset share one low bit instead of having one each.
+	b8 shared_p_bit;
+	u32 index_bits;
+	const i32 *weights;
+} bc7_mode;
+
+// Two RGB subsets with 3-bit indices, for opaque blocks that don't fit a single line.
+static const bc7_mode bc7_mode_1 = {1, 2, 3, 6, true, 3, bc7_weights_3};
+// One RGBA subset with 4-bit indices, the most precise along a single line.
+static const bc7_mode bc7_mode_6 = {6, 1, 4, 7, false, 4, bc7_weights_4};
+// Two RGBA subsets with 2-bit indices.
+static const bc7_mode bc7_mode_7 = {7, 2, 4, 5, false, 2, bc7_weights_2};
+
+typedef struct bc7_subset {
+	// Endpoints without their low bits, and the low bits.
+	i32 endpoints[2][4];
+	u32 p_bits[2];
+	u32 error;
+} bc7_subset;
+
+typedef struct bc7_candidate {
+	const bc7_mode *mode;
+	u32 partition;
+	bc7_subset subsets[2];
+	u8 indices[16];
+	u32 error;
+} bc7_candidate;
+
+static u32 bc7_subset_of(const bc7_mode *mode, u32 partition, u32 texel) {
+	return mode->subset_count == 1 ? 0 : (u32)(bc7_partitions[partition] >> texel) & 1;
+}
+
+// An endpoint and its low bit as decoders expand them to 8 bits.
+static i32 bc7_expand(i32 endpoint, u32 p_bit, u32 endpoint_bits) {
+	u32 bits  = endpoint_bits + 1;
+	i32 value = (endpoint << 1) | (i32)p_bit;
+	return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+/**
+ * The palette lies along a line, so each used texel's index is estimated from its projection onto it and only the
+ * neighbouring indices are compared. @returns The summed squared error.
+ */
+static u32 bc7_choose_indices(const u8 texels[64],
+							  const b8 used[16],
+							  u32 channel_count,
+							  const i32 expanded[2][4],
+							  const i32 (*palette)[4],
+							  u32 palette_count,
+							  u8 indices[16]) {
+	i32 direction[4];
+	i32 length_squared = 0;
+	for (u32 c = 0; c < channel_count; ++c) {
+		direction[c] = expanded[1][c] - expanded[0][c];
+		length_squared += direction[c] * direction[c];
+	}
+
+	i32 last  = (i32)palette_count - 1;
+	u32 total = 0;
+	for (u32 i = 0; i < 16; ++i) {
+		if (!used[i]) { continue; }
+		i32 estimate = 0;
+		if (length_squared > 0) {
+			i32 dot = 0;
+			for (u32 c = 0; c < channel_count; ++c) {
+				dot += ((i32)texels[i * 4 + c] - expanded[0][c]) * direction[c];
+			}
+			estimate = clamp_i32((dot * last + length_squared / 2) / length_squared, 0, last);
+		}
+
+		u32 best_error = 0xFFFFFFFFU;
+		for (i32 candidate = SMAX(estimate - 1, 0); candidate <= SMIN(estimate + 1, last); ++candidate) {
+			u32 error = 0;
+			for (u32 c = 0; c < channel_count; ++c) {
+				i32 d = (i32)texels[i * 4 + c] - palette[candidate][c];
+				error += (u32)(d * d);
+			}
+			if (error < best_error) {
+				best_error = error;
+				indices[i] = (u8)candidate;
+			}
+		}
+		total += best_error;
+	}
+	return total;
+}
+
+// Quantizes the endpoints e0 and e1 to the mode and picks the used texels' indices for them.
+static void bc7_evaluate_subset(const u8 texels[64],
+								const b8 used[16],
+								const bc7_mode *mode,
+								b8 opaque,
+								const f32 e0[4],
+								const f32 e1[4],
+								bc7_subset *out,
+								u8 indices[16]) {
+	out->error = 0xFFFFFFFFU;
+	// Each endpoint's low bit is shared by its channels, so try the combinations. Opaque blocks keep them set in
+	// modes with alpha so it stays exactly 255.
+	u32 first_p_bit = opaque && mode->channel_count == 4 ? 1 : 0;
+	f32 scale       = (f32)((1U << (mode->endpoint_bits + 1)) - 1) / 255.0f;
+	i32 max         = (1 << mode->endpoint_bits) - 1;
+	u32 count       = 1U << mode->index_bits;
+	for (u32 p0 = first_p_bit; p0 < 2; ++p0) {
+		for (u32 p1 = first_p_bit; p1 < 2; ++p1) {
+			// A shared low bit only has the combinations where both match.
+			if (mode->shared_p_bit && p1 != p0) { continue; }
+			bc7_subset candidate;
+			candidate.p_bits[0] = p0;
+			candidate.p_bits[1] = p1;
+			i32 expanded[2][4];
+			for (u32 c = 0; c < mode->channel_count; ++c) {
+				candidate.endpoints[0][c] = clamp_i32((i32)((e0[c] * scale - (f32)p0) * 0.5f + 0.5f), 0, max);
+				candidate.endpoints[1][c] = clamp_i32((i32)((e1[c] * scale - (f32)p1) * 0.5f + 0.5f), 0, max);
+				expanded[0][c]            = bc7_expand(candidate.endpoints[0][c], p0, mode->endpoint_bits);
+				expanded[1][c]            = bc7_expand(candidate.endpoints[1][c], p1, mode->endpoint_bits);
+			}
+
+			i32 palette[16][4];
+			for (u32 i = 0; i < count; ++i) {
+				i32 w0 = 64 - mode->weights[i];
+				i32 w1 = mode->weights[i];
+				for (u32 c = 0; c < mode->channel_count; ++c) {
+					palette[i][c] = (w0 * expanded[0][c] + w1 * expanded[1][c] + 32) >> 6;
+				}
+			}
+			u8 candidate_indices[16];
+			candidate.error = bc7_choose_indices(texels,
+												 used,
+												 mode->channel_count,
+												 (const i32(*)[4])expanded,
+												 (const i32(*)[4])palette,
+												 count,
+												 candidate_indices);
+			if (candidate.error < out->error) {
+				*out = candidate;
+				for (u32 i = 0; i < 16; ++i) {
+					if (used[i]) { indices[i] = candidate_indices[i]; }
+				}
+			}
+		}
+	}
+}
+
+// Fits the used texels' endpoints along their principal axis, then refines them for the indices they get.
+static void bc7_fit_subset(const u8 texels[64],
+						   const b8 used[16],
+						   const bc7_mode *mode,
+						   b8 opaque,
+						   bc7_subset *out,
+						   u8 indices[16]) {
+	f32 mean[4], axis[4], min, max;
+	principal_axis(texels, used, mode->channel_count, mean, axis);
+	project_extents(texels, used, mode->channel_count, mean, axis, &min, &max);
+	f32 e0[4], e1[4];
+	for (u32 c = 0; c < mode->channel_count; ++c) {
+		e0[c] = mean[c] + axis[c] * min;
+		e1[c] = mean[c] + axis[c] * max;
+	}
+	bc7_evaluate_subset(texels, used, mode, opaque, e0, e1, out, indices);
+
+	f32 weights[16];
+	for (u32 i = 0; i < (1U << mode->index_bits); ++i) { weights[i] = (f32)(64 - mode->weights[i]) / 64.0f; }
+	for (u32 iteration = 0; iteration < REFINE_ITERATIONS && out->error > 0; ++iteration) {
+		if (!refine_endpoints(texels, used, indices, weights, mode->channel_count, e0, e1)) { break; }
+		bc7_subset candidate;
+		u8 candidate_indices[16];
+		bc7_evaluate_subset(texels, used, mode, opaque, e0, e1, &candidate, candidate_indices);
+		if (candidate.error >= out->error) { break; }
+		*out = candidate;
+		for (u32 i = 0; i < 16; ++i) {
+			if (used[i]) { indices[i] = candidate_indices[i]; }
+		}
+	}
+}
+
+static void bc7_fit(const u8 texels[64], b8 opaque, const bc7_mode *mode, u32 partition, bc7_candidate *out) {
+	out->mode      = mode;
+	out->partition = partition;
+	out->error     = 0;
+	for (u32 s = 0; s < mode->subset_count; ++s) {
+		b8 used[16];
+		for (u32 i = 0; i < 16; ++i) { used[i] = bc7_subset_of(mode, partition, i) == s; }
+		bc7_fit_subset(texels, used, mode, opaque, &out->subsets[s], out->indices);
+		out->error += out->subsets[s].error;
+	}
+}
+
+// Sums over a set of texels that make up their covariance.
+typedef struct texel_moments {
+	i32 count;
+	i32 sums[4];
+	// Only entries with a <= b are kept.
+	i32 products[4][4];
+} texel_moments;
+
+static void add_texel_moments(texel_moments *moments, const u8 *texel, i32 sign) {
+	moments->count += sign;
+	for (u32 a = 0; a < 4; ++a) {
+		moments->sums[a] += sign * texel[a];
+		for (u32 b = a; b < 4; ++b) { moments->products[a][b] += sign * texel[a] * texel[b]; }
+	}
+}
+
+/**
+ * Squared distance of the texels from the best line through them, what is left of their variance once the
+ * largest eigenvalue's share is taken out. Power iteration undershoots that eigenvalue slightly, which is plenty
+ * to rank partitions by.
+ */
+static f32 line_fit_error(const texel_moments *moments) {
+	if (moments->count == 0) { return 0; }
+
+	f32 covariance[4][4];
+	f32 trace  = 0;
+	u32 widest = 0;
+	for (u32 a = 0; a < 4; ++a) {
+		for (u32 b = a; b < 4; ++b) {
+			covariance[a][b] = (f32)moments->products[a][b]
+							 - (f32)moments->sums[a] * (f32)moments->sums[b] / (f32)moments->count;
+			covariance[b][a] = covariance[a][b];
+		}
+		trace += covariance[a][a];
+		if (covariance[a][a] > covariance[widest][widest]) { widest = a; }
+	}
+	if (trace < 1e-6f) { return 0; }
+
+	// The widest channel's row leans towards the principal axis already.
+	f32 vector[4];
+	for (u32 c = 0; c < 4; ++c) { vector[c] = covariance[widest][c]; }
+	f32 eigenvalue = 0;
+	for (u32 iteration = 0; iteration < AXIS_ITERATIONS / 2; ++iteration) {
+		f32 next[4]        = {0};
+		f32 length_squared = 0, dot = 0;
+		for (u32 a = 0; a < 4; ++a) {
+			for (u32 b = 0; b < 4; ++b) { next[a] += covariance[a][b] * vector[b]; }
+			length_squared += vector[a] * vector[a];
+			dot += vector[a] * next[a];
+		}
+		if (length_squared < 1e-12f) { break; }
+		eigenvalue = dot / length_squared;
+		f32 scale  = 1.0f / sqrtf(length_squared);
+		for (u32 c = 0; c < 4; ++c) { vector[c] = next[c] * scale; }
+	}
+	return trace - eigenvalue;
+}
+
+// The partitions whose two subsets each lie closest to a line, best first.
+static void bc7_rank_partitions(const u8 texels[64], u32 out_partitions[BC7_PARTITION_CANDIDATES]) {
+	f32 errors[BC7_PARTITION_CANDIDATES];
+	for (u32 k = 0; k < BC7_PARTITION_CANDIDATES; ++k) {
+		errors[k]         = INFINITY;
+		out_partitions[k] = 0;
+	}
+
+	texel_moments block;
+	memset(&block, 0, sizeof(block));
+	for (u32 i = 0; i < 16; ++i) { add_texel_moments(&block, texels + i * 4, 1); }
+
+	for (u32 partition = 0; partition < 64; ++partition) {
+		// Subset 0 is what's left of the block once subset 1 is taken out.
+		texel_moments first  = block;
+		texel_moments second = {0};
+		for (u32 i = 0; i < 16; ++i) {
+			if (!((bc7_partitions[partition] >> i) & 1)) { continue; }
+			add_texel_moments(&first, texels + i * 4, -1);
+			add_texel_moments(&second, texels + i * 4, 1);
+		}
+		f32 error = line_fit_error(&first) + line_fit_error(&second);
+		for (u32 k = 0; k < BC7_PARTITION_CANDIDATES; ++k) {
+			if (error >= errors[k]) { continue; }
+			for (u32 j = BC7_PARTITION_CANDIDATES - 1; j > k; --j) {
+				errors[j]         = errors[j - 1];
+				out_partitions[j] = out_partitions[j - 1];
+			}
+			errors[k]         = error;
+			out_partitions[k] = partition;
+			break;
+		}
+	}
+}
+
+typedef struct bit_writer {
+	u8 *data;
+	u32 position;
+} bit_writer;
+
+// Least significant bit first, into zeroed memory.
+static void write_bits(bit_writer *writer, u32 value, u32 count) {
+	for (u32 i = 0; i < count; ++i, ++writer->position) {
+		if ((value >> i) & 1) { writer->data[writer->position >> 3] |= (u8)(1U << (writer->position & 7)); }
+	}
+}
+
+static void bc7_write_block(bc7_candidate *block, u8 out_block[16]) {
+	const bc7_mode *mode = block->mode;
+	u32 anchors[2]       = {0, mode->subset_count == 2 ? bc7_anchors[block->partition] : 0};
+	u32 last_index       = (1U << mode->index_bits) - 1;
+
+	// Each subset's anchor index is stored without its top bit, so it must be in the lower half.
+	for (u32 s = 0; s < mode->subset_count; ++s) {
+		if (block->indices[anchors[s]] <= last_index / 2) { continue; }
+		bc7_subset *subset = &block->subsets[s];
+		for (u32 c = 0; c < mode->channel_count; ++c) {
+			i32 endpoint            = subset->endpoints[0][c];
+			subset->endpoints[0][c] = subset->endpoints[1][c];
+			subset->endpoints[1][c] = endpoint;
+		}
+		u32 p_bit         = subset->p_bits[0];
+		subset->p_bits[0] = subset->p_bits[1];
+		subset->p_bits[1] = p_bit;
+		for (u32 i = 0; i < 16; ++i) {
+			if (bc7_subset_of(mode, block->partition, i) == s) {
+				block->indices[i] = (u8)(last_index - block->indices[i]);
+			}
+		}
+	}
+
+	memset(out_block, 0, 16);
+	bit_writer writer = {out_block, 0};
+	// The mode is the position of the first set bit.
+	write_bits(&writer, 1U << mode->number, mode->number + 1);
+	if (mode->subset_count == 2) { write_bits(&writer, block->partition, 6); }
+	for (u32 c = 0; c < mode->channel_count; ++c) {
+		for (u32 s = 0; s < mode->subset_count; ++s) {
+			write_bits(&writer, (u32)block->subsets[s].endpoints[0][c], mode->endpoint_bits);
+			write_bits(&writer, (u32)block->subsets[s].endpoints[1][c], mode->endpoint_bits);
+		}
+	}
+	for (u32 s = 0; s < mode->subset_count; ++s) {
+		write_bits(&writer, block->subsets[s].p_bits[0], 1);
+		if (!mode->shared_p_bit) { write_bits(&writer, block->subsets[s].p_bits[1], 1); }
+	}
+	for (u32 i = 0; i < 16; ++i) {
+		b8 anchor = i == anchors[0] || i == anchors[1];
+		write_bits(&writer, block->indices[i], mode->index_bits - (anchor ? 1 : 0));
+	}
+}
+
+void bc7_compress_block(const u8 texels[64], u8 out_block[16]) {
+	b8 opaque = true;
+	for (u32 i = 0; i < 16; ++i) { opaque &= texels[i * 4 + 3] == 255; }
+
+	bc7_candidate best;
+	bc7_fit(texels, opaque, &bc7_mode_6, 0, &best);
+
+	// Blocks whose colours don't lie along one line, noise and edges, do better split into two subsets.
+	if (best.error > BC7_SINGLE_SUBSET_ERROR) {
+		u32 partitions[BC7_PARTITION_CANDIDATES];
+		bc7_rank_partitions(texels, partitions);
+		for (u32 k = 0; k < BC7_PARTITION_CANDIDATES; ++k) {
+			bc7_candidate candidate;
+			if (opaque) {
+				bc7_fit(texels, opaque, &bc7_mode_1, partitions[k], &candidate);
+				if (candidate.error < best.error) { best = candidate; }
+			}
+			bc7_fit(texels, opaque, &bc7_mode_7, partitions[k], &candidate);
+			if (candidate.error < best.error) { best = candidate; }
+		}
+	}
+
+	bc7_write_block(&best, out_block);
+}
+
+void block_compress(texture_format format, const u8 *pixels, u32 width, u32 height, u8 *dest) {
+	if (format == TEXTURE_FORMAT_RGBA8) {
+		memcpy(dest, pixels, (u64)width * height * 4);
+		return;
+	}
+
+	u32 block_size = format == TEXTURE_FORMAT_BC1 ? 8 : 16;
+	u8 texels[64];
+	for (u32 block_y = 0; block_y < height; block_y += 4) {
+		for (u32 block_x = 0; block_x < width; block_x += 4) {
+			for (u32 y = 0; y < 4; ++y) {
+				u32 row = SMIN(block_y + y, height - 1);
+				for (u32 x = 0; x < 4; ++x) {
+					u32 column = SMIN(block_x + x, width - 1);
+					memcpy(texels + (y * 4 + x) * 4, pixels + ((u64)row * width + column) * 4, 4);
+				}
+			}
+
+			switch (format) {
+				case TEXTURE_FORMAT_BC1: bc1_compress_block(texels, dest); break;
+				case TEXTURE_FORMAT_BC3: bc3_compress_block(texels, dest); break;
+				default: bc7_compress_block(texels, dest); break;
+			}
+			dest += block_size;
+		}
+	}
+}
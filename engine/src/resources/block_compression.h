@@ -0,0 +1,28 @@
+#pragma once
+
+#include "resource_types.h"
+
+// Bytes of one level of a texture of this size, blocks of the compressed formats are padded out to 4x4 texels.
+SAPI u64 texture_format_level_size(texture_format format, u32 width, u32 height);
+
+SINLINE b8 texture_format_is_compressed(texture_format format) { return format != TEXTURE_FORMAT_RGBA8; }
+
+/**
+ * Encodes 4x4 RGBA8 texels, row by row, into one block. The encoders fit endpoints along the block's principal
+ * axis and refine them by least squares once indices are chosen, which is meant for offline cooking rather than
+ * for compressing at load time. Nothing is allocated or logged, blocks can be encoded from any thread.
+ * BC1 switches to its 3 colour mode with transparent black for blocks that have texels with alpha under 128.
+ */
+SAPI void bc1_compress_block(const u8 texels[64], u8 out_block[8]);
+SAPI void bc3_compress_block(const u8 texels[64], u8 out_block[16]);
+/**
+ * Picks per block between mode 6, one RGBA subset with 4-bit indices, and the two subset modes 1 (opaque RGB,
+ * 3-bit indices) and 7 (RGBA, 2-bit indices) over the partitions that split the block best, by their error.
+ */
+SAPI void bc7_compress_block(const u8 texels[64], u8 out_block[16]);
+
+/**
+ * Compresses a whole RGBA8 image into dest, texture_format_level_size(format, width, height) bytes of blocks row
+ * by row. Blocks over the image's edge repeat its last row and column.
+ */
+SAPI void block_compress(texture_format format, const u8 *pixels, u32 width, u32 height, u8 *dest);
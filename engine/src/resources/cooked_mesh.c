@@ -0,0 +1,56 @@
+#include "cooked_mesh.h"
+
+#include "core/smemory.h"
+#include "mesh_loader.h"
+
+b8 cooked_mesh_parse(const void *data, u64 size, cooked_mesh *out_mesh) {
+	szero_memory(out_mesh, sizeof(cooked_mesh));
+	if (size < sizeof(cooked_mesh_header)) { return false; }
+
+	const cooked_mesh_header *header = data;
+	b8 header_valid = header->magic == COOKED_MESH_MAGIC && header->version == COOKED_MESH_VERSION
+				   && header->vertex_count > 0 && header->index_count > 0 && header->index_count % 3 == 0;
+	if (!header_valid) { return false; }
+
+	u64 vertices_size = (u64)header->vertex_count * sizeof(vertex_3d);
+	u64 indices_size  = (u64)header->index_count * sizeof(u32);
+	if (sizeof(cooked_mesh_header) + vertices_size + indices_size != size) { return false; }
+
+	// An index past the vertices would read outside the vertex buffer range the mesh is given.
+	const u8 *bytes    = data;
+	const u32 *indices = (const u32 *)(bytes + sizeof(cooked_mesh_header) + vertices_size);
+	for (u32 i = 0; i < header->index_count; ++i) {
+		if (indices[i] >= header->vertex_count) { return false; }
+	}
+
+	out_mesh->header   = header;
+	out_mesh->vertices = (const vertex_3d *)(bytes + sizeof(cooked_mesh_header));
+	out_mesh->indices  = indices;
+	return true;
+}
+
+b8 cooked_mesh_cook(const char *path, const void *source, u64 source_size, u8 **out_data, u64 *out_size) {
+	mesh_data mesh;
+	if (!mesh_import(path, source, source_size, &mesh)) { return false; }
+	mesh_optimize(&mesh);
+
+	cooked_mesh_header header = {
+		.magic        = COOKED_MESH_MAGIC,
+		.version      = COOKED_MESH_VERSION,
+		.vertex_count = mesh.vertex_count,
+		.index_count  = mesh.index_count,
+	};
+	u64 vertices_size = sizeof(vertex_3d) * mesh.vertex_count;
+	u64 indices_size  = sizeof(u32) * mesh.index_count;
+	u64 size          = sizeof(cooked_mesh_header) + vertices_size + indices_size;
+
+	u8 *data = sallocate(size, MEMORY_TAG_RESOURCE);
+	scopy_memory(data, &header, sizeof(header));
+	scopy_memory(data + sizeof(header), mesh.vertices, vertices_size);
+	scopy_memory(data + sizeof(header) + vertices_size, mesh.indices, indices_size);
+	mesh_data_destroy(&mesh);
+
+	*out_data = data;
+	*out_size = size;
+	return true;
+}
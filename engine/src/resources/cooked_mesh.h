@@ -0,0 +1,42 @@
+#pragma once
+
+#include "mesh.h"
+
+/**
+ * Cooked mesh layout, everything little-endian:
+ *   cooked_mesh_header
+ *   vertex_3d[vertex_count]
+ *   u32[index_count], a triangle list
+ * Both arrays are uploaded to the GPU as they are, cooking has already welded and optimized them.
+ */
+#define COOKED_MESH_MAGIC 0x48534D43U
+#define COOKED_MESH_VERSION 1
+// Bumped when cooking welds or orders meshes differently in the same layout, so the cooker cooks them again.
+#define COOKED_MESH_ENCODER_VERSION 1
+
+// Cooked meshes sit next to their sources, meshes/<name>.cmsh is cooked from meshes/<name>.obj, .gltf or .glb.
+#define COOKED_MESH_EXTENSION ".cmsh"
+
+typedef struct cooked_mesh_header {
+	u32 magic;
+	u32 version;
+	u32 vertex_count;
+	u32 index_count;
+} cooked_mesh_header;
+
+// A validated cooked mesh, pointing into the memory it was parsed from.
+typedef struct cooked_mesh {
+	const cooked_mesh_header *header;
+	const vertex_3d *vertices;
+	const u32 *indices;
+} cooked_mesh;
+
+// @returns False if data isn't a cooked mesh of this version, is corrupt or indexes past its vertices.
+SAPI b8 cooked_mesh_parse(const void *data, u64 size, cooked_mesh *out_mesh);
+
+/**
+ * Imports a mesh source with mesh_import, optimizes it and lays it out as described above.
+ * @param path The source's path, its extension picks the importer.
+ * @param out_data Allocated with MEMORY_TAG_RESOURCE, free it with sfree and *out_size.
+ */
+SAPI b8 cooked_mesh_cook(const char *path, const void *source, u64 source_size, u8 **out_data, u64 *out_size);
@@ -0,0 +1,99 @@
+#include "cooked_texture.h"
+
+#include "block_compression.h"
+#include "core/smemory.h"
+#include "png.h"
+
+static u64 align_up(u64 value) { return (value + COOKED_TEXTURE_ALIGNMENT - 1) & ~(u64)(COOKED_TEXTURE_ALIGNMENT - 1); }
+
+b8 cooked_texture_parse(const void *data, u64 size, cooked_texture *out_texture) {
+	szero_memory(out_texture, sizeof(cooked_texture));
+	if (size < sizeof(cooked_texture_header)) { return false; }
+
+	const cooked_texture_header *header = data;
+	b8 header_valid = header->magic == COOKED_TEXTURE_MAGIC && header->version == COOKED_TEXTURE_VERSION
+				   && header->format < TEXTURE_FORMAT_COUNT && header->width > 0 && header->height > 0
+				   && header->width <= PNG_MAX_DIMENSION && header->height <= PNG_MAX_DIMENSION
+				   && header->level_count > 0 && header->level_count <= mip_level_count(header->width, header->height);
+	if (!header_valid) { return false; }
+
+	u64 table_end = sizeof(cooked_texture_header) + (u64)header->level_count * sizeof(cooked_texture_level);
+	if (table_end > size) { return false; }
+
+	const cooked_texture_level *levels = (const cooked_texture_level *)((const u8 *)data + sizeof(*header));
+	for (u32 i = 0; i < header->level_count; ++i) {
+		u64 expected = texture_format_level_size(header->format,
+												 mip_level_dimension(header->width, i),
+												 mip_level_dimension(header->height, i));
+		if (levels[i].size != expected || levels[i].offset < table_end || levels[i].offset > size
+			|| levels[i].size > size - levels[i].offset) {
+			return false;
+		}
+	}
+
+	out_texture->header = header;
+	out_texture->levels = levels;
+	out_texture->data   = data;
+	return true;
+}
+
+b8 cooked_texture_cook(const u8 *pixels,
+					   u32 width,
+					   u32 height,
+					   b8 has_transparency,
+					   texture_format format,
+					   mip_filter filter,
+					   u32 level_count,
+					   u8 **out_data,
+					   u64 *out_size) {
+	u32 full_chain = mip_level_count(width, height);
+	if (level_count == 0 || level_count > full_chain) { level_count = full_chain; }
+	if (width == 0 || height == 0 || format >= TEXTURE_FORMAT_COUNT || level_count > COOKED_TEXTURE_MAX_LEVELS) {
+		return false;
+	}
+
+	cooked_texture_header header = {
+		.magic            = COOKED_TEXTURE_MAGIC,
+		.version          = COOKED_TEXTURE_VERSION,
+		.width            = width,
+		.height           = height,
+		.format           = format,
+		.level_count      = level_count,
+		.has_transparency = has_transparency ? 1 : 0,
+	};
+	cooked_texture_level levels[COOKED_TEXTURE_MAX_LEVELS];
+	u64 offset = align_up(sizeof(cooked_texture_header) + (u64)level_count * sizeof(cooked_texture_level));
+	for (u32 i = 0; i < level_count; ++i) {
+		u32 level_width  = mip_level_dimension(width, i);
+		u32 level_height = mip_level_dimension(height, i);
+		levels[i].offset = offset;
+		levels[i].size   = texture_format_level_size(format, level_width, level_height);
+		offset           = align_up(offset + levels[i].size);
+	}
+
+	// Every level is filtered from the uncompressed one above it, then compressed on its own.
+	u64 chain_size   = mip_chain_size(width, height, level_count);
+	u64 scratch_size = mip_scratch_size(width, height);
+	u8 *chain        = sallocate(chain_size, MEMORY_TAG_RESOURCE);
+	void *scratch    = sallocate(scratch_size, MEMORY_TAG_RESOURCE);
+	scopy_memory(chain, pixels, (u64)width * height * 4);
+	mip_generate_chain(chain, width, height, level_count, filter, scratch);
+
+	u8 *data = sallocate(offset, MEMORY_TAG_RESOURCE);
+	scopy_memory(data, &header, sizeof(header));
+	scopy_memory(data + sizeof(header), levels, (u64)level_count * sizeof(cooked_texture_level));
+
+	const u8 *level = chain;
+	for (u32 i = 0; i < level_count; ++i) {
+		u32 level_width  = mip_level_dimension(width, i);
+		u32 level_height = mip_level_dimension(height, i);
+		block_compress(format, level, level_width, level_height, data + levels[i].offset);
+		level += (u64)level_width * level_height * 4;
+	}
+
+	sfree(scratch, scratch_size, MEMORY_TAG_RESOURCE);
+	sfree(chain, chain_size, MEMORY_TAG_RESOURCE);
+	*out_data = data;
+	*out_size = offset;
+	return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "mipmap.h"
+#include "resource_types.h"
+
+/**
+ * Cooked texture layout, everything little-endian:
+ *   cooked_texture_header
+ *   cooked_texture_level[level_count], level 0 first
+ *   level data, each starting on a COOKED_TEXTURE_ALIGNMENT boundary
+ * Levels hold RGBA8 rows or rows of 4x4 blocks as texture_format_level_size describes, ready to be copied to
+ * the GPU as they are.
+ */
+#define COOKED_TEXTURE_MAGIC 0x58455443U
+#define COOKED_TEXTURE_VERSION 1
+// Bumped when cooking makes different levels in the same layout, a better block encoder or mip filter, so the
+// cooker knows textures cooked before need cooking again.
+#define COOKED_TEXTURE_ENCODER_VERSION 2
+#define COOKED_TEXTURE_ALIGNMENT 16
+// A full chain of the largest image png_read_info accepts.
+#define COOKED_TEXTURE_MAX_LEVELS 15
+
+// Cooked textures sit next to their sources, textures/<name>.ctex is cooked from textures/<name>.png.
+#define COOKED_TEXTURE_EXTENSION ".ctex"
+
+typedef struct cooked_texture_header {
+	u32 magic;
+	u32 version;
+	u32 width;
+	u32 height;
+	// A texture_format.
+	u32 format;
+	u32 level_count;
+	u8 has_transparency;
+	u8 reserved[7];
+} cooked_texture_header;
+
+typedef struct cooked_texture_level {
+	u64 offset;
+	u64 size;
+} cooked_texture_level;
+
+// A validated cooked texture, pointing into the memory it was parsed from.
+typedef struct cooked_texture {
+	const cooked_texture_header *header;
+	const cooked_texture_level *levels;
+	const u8 *data;
+} cooked_texture;
+
+// @returns False if data isn't a cooked texture of this version or is corrupt.
+SAPI b8 cooked_texture_parse(const void *data, u64 size, cooked_texture *out_texture);
+
+/**
+ * Cooks an RGBA8 image offline: generates its mip chain with filter, compresses every level to format and lays
+ * them out as described above.
+ * @param level_count Levels to keep, 0 for a full chain.
+ * @param out_data Allocated with MEMORY_TAG_RESOURCE, free it with sfree and *out_size.
+ */
+SAPI b8 cooked_texture_cook(const u8 *pixels,
+							u32 width,
+							u32 height,
+							b8 has_transparency,
+							texture_format format,
+							mip_filter filter,
+							u32 level_count,
+							u8 **out_data,
+							u64 *out_size);
@@ -0,0 +1,229 @@
+#include "json.h"
+
+#include "containers/darray.h"
+#include "core/smemory.h"
+#include "core/sstring.h"
+
+#include <string.h>
+
+typedef struct json_parser {
+	const char *text;
+	u64 length;
+	u64 position;
+	u32 depth;
+	// darray
+	json_token *tokens;
+	// darray
+	u32 *elements;
+	// darray, element token indices of the arrays still being parsed, innermost last.
+	u32 *open_elements;
+} json_parser;
+
+static b8 parse_value(json_parser *p);
+
+static void skip_whitespace(json_parser *p) {
+	while (p->position < p->length) {
+		char c = p->text[p->position];
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r') { return; }
+		p->position++;
+	}
+}
+
+static b8 peek(json_parser *p, char c) { return p->position < p->length && p->text[p->position] == c; }
+
+static b8 is_digit(char c) { return c >= '0' && c <= '9'; }
+
+static u32 push_token(json_parser *p, json_type type, u64 start) {
+	json_token token = {.type = type, .start = (u32)start};
+	darray_push(p->tokens, token);
+	return (u32)darray_length(p->tokens) - 1;
+}
+
+// Closes the token at index, everything pushed since belongs to it.
+static void end_token(json_parser *p, u32 index, u64 end) {
+	p->tokens[index].length = (u32)(end - p->tokens[index].start);
+	p->tokens[index].next   = (u32)darray_length(p->tokens);
+}
+
+static b8 parse_string(json_parser *p) {
+	if (!peek(p, '"')) { return false; }
+	u32 index = push_token(p, JSON_TYPE_STRING, ++p->position);
+	while (p->position < p->length) {
+		char c = p->text[p->position];
+		if (c == '"') {
+			end_token(p, index, p->position++);
+			return true;
+		}
+		if ((u8)c < 0x20) { return false; }
+		p->position += c == '\\' ? 2 : 1;
+	}
+	return false;
+}
+
+static b8 skip_digits(json_parser *p) {
+	u64 start = p->position;
+	while (p->position < p->length && is_digit(p->text[p->position])) { p->position++; }
+	return p->position > start;
+}
+
+static b8 parse_number(json_parser *p) {
+	u32 index = push_token(p, JSON_TYPE_NUMBER, p->position);
+	if (peek(p, '-')) { p->position++; }
+	if (!skip_digits(p)) { return false; }
+	if (peek(p, '.')) {
+		p->position++;
+		if (!skip_digits(p)) { return false; }
+	}
+	if (peek(p, 'e') || peek(p, 'E')) {
+		p->position++;
+		if (peek(p, '+') || peek(p, '-')) { p->position++; }
+		if (!skip_digits(p)) { return false; }
+	}
+	end_token(p, index, p->position);
+	return true;
+}
+
+static b8 parse_literal(json_parser *p, const char *literal, json_type type) {
+	u64 length = string_length(literal);
+	if (p->length - p->position < length || memcmp(p->text + p->position, literal, length) != 0) { return false; }
+	u32 index = push_token(p, type, p->position);
+	p->position += length;
+	end_token(p, index, p->position);
+	return true;
+}
+
+// Arrays and objects, close is the bracket that ends them.
+static b8 parse_container(json_parser *p, json_type type, char close) {
+	if (++p->depth > JSON_MAX_DEPTH) { return false; }
+	u32 index      = push_token(p, type, p->position++);
+	u64 first_open = darray_length(p->open_elements);
+
+	skip_whitespace(p);
+	if (!peek(p, close)) {
+		for (;;) {
+			skip_whitespace(p);
+			if (type == JSON_TYPE_OBJECT) {
+				if (!parse_string(p)) { return false; }
+				skip_whitespace(p);
+				if (!peek(p, ':')) { return false; }
+				p->position++;
+				skip_whitespace(p);
+			}
+			u32 child = (u32)darray_length(p->tokens);
+			if (!parse_value(p)) { return false; }
+			p->tokens[index].child_count++;
+			if (type == JSON_TYPE_ARRAY) { darray_push(p->open_elements, child); }
+
+			skip_whitespace(p);
+			if (!peek(p, ',')) { break; }
+			p->position++;
+		}
+		if (!peek(p, close)) { return false; }
+	}
+
+	// Nested arrays have been moved over already, so this one's elements are the last ones open.
+	if (type == JSON_TYPE_ARRAY) {
+		p->tokens[index].first_element = (u32)darray_length(p->elements);
+		for (u64 i = first_open; i < darray_length(p->open_elements); ++i) {
+			darray_push(p->elements, p->open_elements[i]);
+		}
+		darray_length_set(p->open_elements, first_open);
+	}
+	end_token(p, index, ++p->position);
+	p->depth--;
+	return true;
+}
+
+static b8 parse_value(json_parser *p) {
+	if (p->position >= p->length) { return false; }
+	switch (p->text[p->position]) {
+		case '{':
+			return parse_container(p, JSON_TYPE_OBJECT, '}');
+		case '[':
+			return parse_container(p, JSON_TYPE_ARRAY, ']');
+		case '"':
+			return parse_string(p);
+		case 't':
+			return parse_literal(p, "true", JSON_TYPE_BOOLEAN);
+		case 'f':
+			return parse_literal(p, "false", JSON_TYPE_BOOLEAN);
+		case 'n':
+			return parse_literal(p, "null", JSON_TYPE_NULL);
+		default:
+			return parse_number(p);
+	}
+}
+
+b8 json_parse(const char *text, u64 length, json_document *out_document) {
+	szero_memory(out_document, sizeof(json_document));
+	// Token offsets are 32 bit.
+	if (length > 0xFFFFFFFFULL) { return false; }
+
+	json_parser p = {.text          = text,
+					 .length        = length,
+					 .tokens        = darray_create(json_token),
+					 .elements      = darray_create(u32),
+					 .open_elements = darray_create(u32)};
+	skip_whitespace(&p);
+	b8 valid = parse_value(&p);
+	skip_whitespace(&p);
+	darray_destroy(p.open_elements);
+	if (!valid || p.position != p.length) {
+		darray_destroy(p.tokens);
+		darray_destroy(p.elements);
+		return false;
+	}
+
+	out_document->text        = text;
+	out_document->tokens      = p.tokens;
+	out_document->token_count = (u32)darray_length(p.tokens);
+	out_document->elements    = p.elements;
+	return true;
+}
+
+void json_destroy(json_document *document) {
+	if (document->tokens) { darray_destroy(document->tokens); }
+	if (document->elements) { darray_destroy(document->elements); }
+	szero_memory(document, sizeof(json_document));
+}
+
+u32 json_object_get(const json_document *document, u32 object, const char *key) {
+	if (object >= document->token_count || document->tokens[object].type != JSON_TYPE_OBJECT) { return INVALID_ID; }
+
+	u32 member = object + 1;
+	for (u32 i = 0; i < document->tokens[object].child_count; ++i) {
+		u32 value = member + 1;
+		if (json_string_equal(document, member, key)) { return value; }
+		member = document->tokens[value].next;
+	}
+	return INVALID_ID;
+}
+
+u32 json_array_get(const json_document *document, u32 array, u32 index) {
+	if (array >= document->token_count || document->tokens[array].type != JSON_TYPE_ARRAY
+		|| index >= document->tokens[array].child_count) {
+		return INVALID_ID;
+	}
+
+	return document->elements[document->tokens[array].first_element + index];
+}
+
+f64 json_number(const json_document *document, u32 token, f64 fallback) {
+	if (token >= document->token_count || document->tokens[token].type != JSON_TYPE_NUMBER) { return fallback; }
+
+	const json_token *t = &document->tokens[token];
+	f64 value;
+	string_view view = {.data = document->text + t->start, .length = t->length};
+	return string_view_to_f64(view, &value) ? value : fallback;
+}
+
+b8 json_boolean(const json_document *document, u32 token, b8 fallback) {
+	if (token >= document->token_count || document->tokens[token].type != JSON_TYPE_BOOLEAN) { return fallback; }
+	return document->text[document->tokens[token].start] == 't';
+}
+
+b8 json_string_equal(const json_document *document, u32 token, const char *str) {
+	if (token >= document->token_count || document->tokens[token].type != JSON_TYPE_STRING) { return false; }
+	const json_token *t = &document->tokens[token];
+	return string_length(str) == t->length && memcmp(document->text + t->start, str, t->length) == 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "defines.h"
+
+typedef enum json_type {
+	JSON_TYPE_NULL,
+	JSON_TYPE_BOOLEAN,
+	JSON_TYPE_NUMBER,
+	JSON_TYPE_STRING,
+	JSON_TYPE_ARRAY,
+	JSON_TYPE_OBJECT,
+} json_type;
+
+// A value of a parsed document. Tokens are stored depth first, an object's members as key and value pairs.
+typedef struct json_token {
+	json_type type;
+	// Bytes of the value in the text, a string's without its quotes. Escapes are left as they are.
+	u32 start;
+	u32 length;
+	// Elements of an array, members of an object.
+	u32 child_count;
+	// Index of the token following this value and everything in it.
+	u32 next;
+	// Arrays only, where their elements' token indices start in json_document.elements.
+	u32 first_element;
+} json_token;
+
+// Tokens point into text, which has to outlive the document.
+typedef struct json_document {
+	const char *text;
+	// darray
+	json_token *tokens;
+	u32 token_count;
+	// darray, the token indices of every array's elements, so they can be looked up without walking the array.
+	u32 *elements;
+} json_document;
+
+// Parses the JSON value in text. Nesting deeper than JSON_MAX_DEPTH is rejected.
+#define JSON_MAX_DEPTH 64
+SAPI b8 json_parse(const char *text, u64 length, json_document *out_document);
+SAPI void json_destroy(json_document *document);
+
+// @returns The value of object's member key, INVALID_ID if object isn't an object or has no such member.
+SAPI u32 json_object_get(const json_document *document, u32 object, const char *key);
+// @returns INVALID_ID if array isn't an array or is too short. Constant time.
+SAPI u32 json_array_get(const json_document *document, u32 array, u32 index);
+// @returns fallback if token is INVALID_ID or isn't a number.
+SAPI f64 json_number(const json_document *document, u32 token, f64 fallback);
+// @returns fallback if token is INVALID_ID or isn't true or false.
+SAPI b8 json_boolean(const json_document *document, u32 token, b8 fallback);
+SAPI b8 json_string_equal(const json_document *document, u32 token, const char *str);
@@ -0,0 +1,354 @@
+#include "mesh.h"
+
+#include "core/smemory.h"
+#include "core/sstring.h"
+#include "math/smath.h"
+
+#include <string.h>
+
+void mesh_data_destroy(mesh_data *mesh) {
+	if (mesh->vertices) { sfree(mesh->vertices, sizeof(vertex_3d) * mesh->vertex_count, MEMORY_TAG_RESOURCE); }
+	if (mesh->indices) { sfree(mesh->indices, sizeof(u32) * mesh->index_count, MEMORY_TAG_RESOURCE); }
+	szero_memory(mesh, sizeof(mesh_data));
+}
+
+b8 mesh_weld(const vertex_3d *corners, u32 corner_count, mesh_data *out_mesh) {
+	szero_memory(out_mesh, sizeof(mesh_data));
+	// The hash table below has to stay addressable with 32 bits.
+	if (corner_count == 0 || corner_count % 3 != 0 || corner_count > 0x40000000U) { return false; }
+
+	// Open addressing over at least twice as many slots as corners keeps probes short. Slots hold a vertex + 1.
+	u32 table_size = 1;
+	while (table_size < corner_count * 2) { table_size <<= 1; }
+	u32 *table          = sallocate(sizeof(u32) * table_size, MEMORY_TAG_RESOURCE);
+	vertex_3d *vertices = sallocate(sizeof(vertex_3d) * corner_count, MEMORY_TAG_RESOURCE);
+	u32 *indices        = sallocate(sizeof(u32) * corner_count, MEMORY_TAG_RESOURCE);
+	u32 vertex_count    = 0;
+
+	for (u32 i = 0; i < corner_count; ++i) {
+		u32 slot = (u32)string_hash_n(&corners[i], sizeof(vertex_3d)) & (table_size - 1);
+		while (table[slot] && memcmp(&vertices[table[slot] - 1], &corners[i], sizeof(vertex_3d)) != 0) {
+			slot = (slot + 1) & (table_size - 1);
+		}
+		if (!table[slot]) {
+			vertices[vertex_count] = corners[i];
+			table[slot]            = ++vertex_count;
+		}
+		indices[i] = table[slot] - 1;
+	}
+	sfree(table, sizeof(u32) * table_size, MEMORY_TAG_RESOURCE);
+
+	out_mesh->vertex_count = vertex_count;
+	out_mesh->vertices     = sallocate(sizeof(vertex_3d) * vertex_count, MEMORY_TAG_RESOURCE);
+	out_mesh->index_count  = corner_count;
+	out_mesh->indices      = indices;
+	scopy_memory(out_mesh->vertices, vertices, sizeof(vertex_3d) * vertex_count);
+	sfree(vertices, sizeof(vertex_3d) * corner_count, MEMORY_TAG_RESOURCE);
+	return true;
+}
+
+// Triangles using each vertex, those of vertex v are adjacency[offsets[v]] to adjacency[offsets[v + 1]].
+typedef struct vertex_adjacency {
+	u32 *offsets;
+	u32 *triangles;
+} vertex_adjacency;
+
+static void adjacency_create(const u32 *indices, u32 index_count, u32 vertex_count, vertex_adjacency *out) {
+	out->offsets   = sallocate(sizeof(u32) * (vertex_count + 1), MEMORY_TAG_RESOURCE);
+	out->triangles = sallocate(sizeof(u32) * index_count, MEMORY_TAG_RESOURCE);
+
+	// Counted one slot ahead, so after filling each offset has moved up to where its vertex starts.
+	for (u32 i = 0; i < index_count; ++i) { out->offsets[indices[i] + 1]++; }
+	for (u32 v = 0; v < vertex_count; ++v) { out->offsets[v + 1] += out->offsets[v]; }
+	u32 *cursor = sallocate(sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+	scopy_memory(cursor, out->offsets, sizeof(u32) * vertex_count);
+	for (u32 i = 0; i < index_count; ++i) { out->triangles[cursor[indices[i]]++] = i / 3; }
+	sfree(cursor, sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+}
+
+static void adjacency_destroy(vertex_adjacency *adjacency, u32 index_count, u32 vertex_count) {
+	sfree(adjacency->offsets, sizeof(u32) * (vertex_count + 1), MEMORY_TAG_RESOURCE);
+	sfree(adjacency->triangles, sizeof(u32) * index_count, MEMORY_TAG_RESOURCE);
+}
+
+void mesh_optimize_vertex_cache(u32 *indices, u32 index_count, u32 vertex_count) {
+	const u32 cache_size = MESH_VERTEX_CACHE_SIZE;
+	u32 triangle_count   = index_count / 3;
+	if (triangle_count == 0 || vertex_count == 0) { return; }
+
+	vertex_adjacency adjacency;
+	adjacency_create(indices, index_count, vertex_count, &adjacency);
+	// Triangles not yet emitted that use each vertex.
+	u32 *live = sallocate(sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+	for (u32 v = 0; v < vertex_count; ++v) { live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v]; }
+	// When each vertex last entered the cache, it's still there while time - cache_time <= cache_size.
+	u32 *cache_time = sallocate(sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+	u32 time        = cache_size + 1;
+	b8 *emitted     = sallocate(sizeof(b8) * triangle_count, MEMORY_TAG_RESOURCE);
+	// Vertices of emitted triangles, most recent on top, to resume from when a fan runs out of neighbours.
+	u32 *dead_end     = sallocate(sizeof(u32) * index_count, MEMORY_TAG_RESOURCE);
+	u32 dead_end_size = 0;
+	u32 *output       = sallocate(sizeof(u32) * index_count, MEMORY_TAG_RESOURCE);
+	u32 output_count  = 0;
+	// Vertices before it have no live triangles left.
+	u32 cursor = 0;
+
+	while (cursor < vertex_count && live[cursor] == 0) { cursor++; }
+	u32 fan = cursor;
+	while (fan < vertex_count) {
+		// Emit every remaining triangle around the fanning vertex.
+		u32 fan_start = output_count;
+		for (u32 a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; ++a) {
+			u32 t = adjacency.triangles[a];
+			if (emitted[t]) { continue; }
+			for (u32 k = 0; k < 3; ++k) {
+				u32 v                     = indices[t * 3 + k];
+				output[output_count++]    = v;
+				dead_end[dead_end_size++] = v;
+				live[v]--;
+				if (time - cache_time[v] > cache_size) { cache_time[v] = time++; }
+			}
+			emitted[t] = true;
+		}
+
+		// Fan next around the vertex just emitted that will still be cached once all its triangles are, the
+		// oldest such one so it's used before it's evicted.
+		u32 next          = INVALID_ID;
+		u32 best_priority = 0;
+		for (u32 i = fan_start; i < output_count; ++i) {
+			u32 v = output[i];
+			if (live[v] == 0) { continue; }
+			u32 age      = time - cache_time[v];
+			u32 priority = age + 2 * live[v] <= cache_size ? age + 1 : 1;
+			if (priority > best_priority) {
+				best_priority = priority;
+				next          = v;
+			}
+		}
+
+		// A dead end, resume from a recently used vertex or else the next one with triangles left.
+		while (next == INVALID_ID && dead_end_size > 0) {
+			u32 v = dead_end[--dead_end_size];
+			if (live[v] > 0) { next = v; }
+		}
+		if (next == INVALID_ID) {
+			while (cursor < vertex_count && live[cursor] == 0) { cursor++; }
+			next = cursor;
+		}
+		fan = next;
+	}
+
+	scopy_memory(indices, output, sizeof(u32) * output_count);
+	sfree(output, sizeof(u32) * index_count, MEMORY_TAG_RESOURCE);
+	sfree(dead_end, sizeof(u32) * index_count, MEMORY_TAG_RESOURCE);
+	sfree(emitted, sizeof(b8) * triangle_count, MEMORY_TAG_RESOURCE);
+	sfree(cache_time, sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+	sfree(live, sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+	adjacency_destroy(&adjacency, index_count, vertex_count);
+}
+
+// A FIFO post-transform cache, vertex v is cached while time - cache_time[v] < size.
+typedef struct cache_simulation {
+	u32 *cache_time;
+	u32 time;
+	u32 size;
+} cache_simulation;
+
+static void cache_create(u32 vertex_count, u32 size, cache_simulation *out_cache) {
+	out_cache->cache_time = sallocate(sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+	out_cache->time       = size;
+	out_cache->size       = size;
+}
+
+static void cache_flush(cache_simulation *cache) { cache->time += cache->size; }
+
+// @returns Vertices of the triangle that had to be transformed.
+static u32 cache_triangle(cache_simulation *cache, const u32 *triangle) {
+	u32 misses = 0;
+	for (u32 k = 0; k < 3; ++k) {
+		u32 v = triangle[k];
+		if (cache->time - cache->cache_time[v] >= cache->size) {
+			cache->cache_time[v] = cache->time++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+f32 mesh_average_cache_miss_ratio(const u32 *indices, u32 index_count, u32 vertex_count, u32 cache_size) {
+	u32 triangle_count = index_count / 3;
+	if (triangle_count == 0 || vertex_count == 0 || cache_size == 0) { return 0; }
+
+	cache_simulation cache;
+	cache_create(vertex_count, cache_size, &cache);
+	u32 misses = 0;
+	for (u32 t = 0; t < triangle_count; ++t) { misses += cache_triangle(&cache, &indices[t * 3]); }
+	sfree(cache.cache_time, sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+	return (f32)misses / (f32)triangle_count;
+}
+
+typedef struct cluster_key {
+	f32 key;
+	u32 cluster;
+} cluster_key;
+
+// Clusters by descending key, stable so equal keys keep their order. scratch holds as many keys.
+static void sort_cluster_keys(cluster_key *keys, u32 count, cluster_key *scratch) {
+	for (u32 width = 1; width < count; width *= 2) {
+		for (u32 start = 0; start < count; start += 2 * width) {
+			u32 middle = SMIN(start + width, count);
+			u32 end    = SMIN(start + 2 * width, count);
+			u32 left   = start;
+			u32 right  = middle;
+			for (u32 i = start; i < end; ++i) {
+				b8 take_left = left < middle && (right >= end || keys[left].key >= keys[right].key);
+				scratch[i]   = take_left ? keys[left++] : keys[right++];
+			}
+		}
+		scopy_memory(keys, scratch, sizeof(cluster_key) * count);
+	}
+}
+
+/**
+ * Splits triangles into clusters, returning how many. A triangle missing the cache on all its vertices starts
+ * one, the cache order restarted there. Within those, a cluster also ends wherever its miss ratio so far is
+ * within threshold times the whole run's, restarting the cache there costs little.
+ * @param out_starts Holds triangle_count + 1, receives each cluster's first triangle and then triangle_count.
+ */
+static u32 find_clusters(const u32 *indices, u32 triangle_count, u32 vertex_count, f32 threshold, u32 *out_starts) {
+	cache_simulation cache;
+	cache_create(vertex_count, MESH_VERTEX_CACHE_SIZE, &cache);
+
+	// Hard boundaries, where the order restarted anyway.
+	u32 *hard_starts = sallocate(sizeof(u32) * (triangle_count + 1), MEMORY_TAG_RESOURCE);
+	u32 hard_count   = 0;
+	for (u32 t = 0; t < triangle_count; ++t) {
+		if (cache_triangle(&cache, &indices[t * 3]) == 3 || t == 0) { hard_starts[hard_count++] = t; }
+	}
+	hard_starts[hard_count] = triangle_count;
+
+	// Soft boundaries, each hard cluster is replayed from a cold cache and split where that's cheap.
+	u32 count = 0;
+	for (u32 c = 0; c < hard_count; ++c) {
+		u32 start = hard_starts[c];
+		u32 end   = hard_starts[c + 1];
+
+		cache_flush(&cache);
+		u32 misses = 0;
+		for (u32 t = start; t < end; ++t) { misses += cache_triangle(&cache, &indices[t * 3]); }
+		f32 split_ratio = threshold * (f32)misses / (f32)(end - start);
+
+		cache_flush(&cache);
+		out_starts[count++] = start;
+		u32 cluster_start   = start;
+		misses              = 0;
+		for (u32 t = start; t + 1 < end; ++t) {
+			misses += cache_triangle(&cache, &indices[t * 3]);
+			if ((f32)misses / (f32)(t - cluster_start + 1) <= split_ratio) {
+				cache_flush(&cache);
+				out_starts[count++] = t + 1;
+				cluster_start       = t + 1;
+				misses              = 0;
+			}
+		}
+	}
+	out_starts[count] = triangle_count;
+
+	sfree(hard_starts, sizeof(u32) * (triangle_count + 1), MEMORY_TAG_RESOURCE);
+	sfree(cache.cache_time, sizeof(u32) * vertex_count, MEMORY_TAG_RESOURCE);
+	return count;
+}
+
+void mesh_optimize_overdraw(u32 *indices,
+							u32 index_count,
+							const vertex_3d *vertices,
+							u32 vertex_count,
+							f32 threshold) {
+	u32 triangle_count = index_count / 3;
+	if (triangle_count == 0 || vertex_count == 0) { return; }
+
+	u32 *starts       = sallocate(sizeof(u32) * (triangle_count + 1), MEMORY_TAG_RESOURCE);
+	u32 *triangles    = sallocate(sizeof(u32) * index_count, MEMORY_TAG_RESOURCE);
+	u32 cluster_count = find_clusters(indices, triangle_count, vertex_count, threshold, starts);
+
+	vec3 mesh_centroid = vec3_zero();
+	for (u32 v = 0; v < vertex_count; ++v) { mesh_centroid = vec3_add(mesh_centroid, vertices[v].position); }
+	mesh_centroid = vec3_mul_scalar(mesh_centroid, 1.0f / (f32)vertex_count);
+
+	// Clusters facing away from the middle of the mesh and far out along that direction are drawn first.
+	cluster_key *keys = sallocate(sizeof(cluster_key) * cluster_count, MEMORY_TAG_RESOURCE);
+	for (u32 c = 0; c < cluster_count; ++c) {
+		vec3 centroid = vec3_zero();
+		vec3 normal   = vec3_zero();
+		f32 area      = 0;
+		for (u32 t = starts[c]; t < starts[c + 1]; ++t) {
+			vec3 p0 = vertices[indices[t * 3 + 0]].position;
+			vec3 p1 = vertices[indices[t * 3 + 1]].position;
+			vec3 p2 = vertices[indices[t * 3 + 2]].position;
+			// Twice the triangle's area along its normal, so larger triangles weigh more.
+			vec3 cross        = vec3_cross(vec3_sub(p1, p0), vec3_sub(p2, p0));
+			f32 triangle_area = vec3_length(cross);
+			vec3 triangle_mid = vec3_mul_scalar(vec3_add(vec3_add(p0, p1), p2), 1.0f / 3.0f);
+			centroid          = vec3_add(centroid, vec3_mul_scalar(triangle_mid, triangle_area));
+			normal            = vec3_add(normal, cross);
+			area             += triangle_area;
+		}
+
+		keys[c].cluster   = c;
+		keys[c].key       = 0;
+		f32 normal_length = vec3_length(normal);
+		if (area > 0 && normal_length > 0) {
+			centroid    = vec3_mul_scalar(centroid, 1.0f / area);
+			keys[c].key = vec3_dot(vec3_sub(centroid, mesh_centroid), vec3_mul_scalar(normal, 1.0f / normal_length));
+		}
+	}
+	cluster_key *scratch = sallocate(sizeof(cluster_key) * cluster_count, MEMORY_TAG_RESOURCE);
+	sort_cluster_keys(keys, cluster_count, scratch);
+	sfree(scratch, sizeof(cluster_key) * cluster_count, MEMORY_TAG_RESOURCE);
+
+	u32 written = 0;
+	for (u32 c = 0; c < cluster_count; ++c) {
+		u32 cluster = keys[c].cluster;
+		u32 count   = (starts[cluster + 1] - starts[cluster]) * 3;
+		scopy_memory(triangles + written, indices + starts[cluster] * 3, sizeof(u32) * count);
+		written += count;
+	}
+	scopy_memory(indices, triangles, sizeof(u32) * written);
+
+	sfree(keys, sizeof(cluster_key) * cluster_count, MEMORY_TAG_RESOURCE);
+	sfree(triangles, sizeof(u32) * index_count, MEMORY_TAG_RESOURCE);
+	sfree(starts, sizeof(u32) * (triangle_count + 1), MEMORY_TAG_RESOURCE);
+}
+
+void mesh_optimize_vertex_fetch(mesh_data *mesh) {
+	if (mesh->vertex_count == 0) { return; }
+
+	u32 *remap = sallocate(sizeof(u32) * mesh->vertex_count, MEMORY_TAG_RESOURCE);
+	sset_memory(remap, 0xFF, sizeof(u32) * mesh->vertex_count);
+	u32 vertex_count = 0;
+	for (u32 i = 0; i < mesh->index_count; ++i) {
+		u32 v = mesh->indices[i];
+		if (remap[v] == INVALID_ID) { remap[v] = vertex_count++; }
+		mesh->indices[i] = remap[v];
+	}
+
+	vertex_3d *vertices = sallocate(sizeof(vertex_3d) * vertex_count, MEMORY_TAG_RESOURCE);
+	for (u32 v = 0; v < mesh->vertex_count; ++v) {
+		if (remap[v] != INVALID_ID) { vertices[remap[v]] = mesh->vertices[v]; }
+	}
+
+	sfree(remap, sizeof(u32) * mesh->vertex_count, MEMORY_TAG_RESOURCE);
+	sfree(mesh->vertices, sizeof(vertex_3d) * mesh->vertex_count, MEMORY_TAG_RESOURCE);
+	mesh->vertices     = vertices;
+	mesh->vertex_count = vertex_count;
+}
+
+void mesh_optimize(mesh_data *mesh) {
+	mesh_optimize_vertex_cache(mesh->indices, mesh->index_count, mesh->vertex_count);
+	mesh_optimize_overdraw(mesh->indices,
+						   mesh->index_count,
+						   mesh->vertices,
+						   mesh->vertex_count,
+						   MESH_OVERDRAW_THRESHOLD);
+	mesh_optimize_vertex_fetch(mesh);
+}
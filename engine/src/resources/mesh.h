@@ -0,0 +1,54 @@
+#pragma once
+
+#include "resource_types.h"
+
+// Post-transform cache the vertex cache optimizer orders triangles for, in vertices. Current GPUs batch vertices
+// in groups around this size, tuning for it does well on all of them.
+#define MESH_VERTEX_CACHE_SIZE 16
+// How much mesh_optimize_overdraw may raise the average cache miss ratio to split the mesh into more clusters.
+#define MESH_OVERDRAW_THRESHOLD 1.05f
+
+// An indexed triangle list, both arrays allocated with MEMORY_TAG_RESOURCE.
+typedef struct mesh_data {
+	u32 vertex_count;
+	vertex_3d *vertices;
+	u32 index_count;
+	u32 *indices;
+} mesh_data;
+
+SAPI void mesh_data_destroy(mesh_data *mesh);
+
+/**
+ * Turns a triangle soup into an indexed mesh, corners with bitwise identical vertices share one vertex.
+ * @param corner_count A multiple of 3, each three corners are a triangle.
+ */
+SAPI b8 mesh_weld(const vertex_3d *corners, u32 corner_count, mesh_data *out_mesh);
+
+/**
+ * Reorders triangles so vertices are reused while they are still in the post-transform cache, with Tipsify
+ * (Sander et al. 2007, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"). Linear in the
+ * index count and independent of the exact cache size.
+ */
+SAPI void mesh_optimize_vertex_cache(u32 *indices, u32 index_count, u32 vertex_count);
+
+/**
+ * Reorders clusters of triangles from an order mesh_optimize_vertex_cache produced so that those on the outside
+ * of the mesh, which tend to occlude the rest, are drawn first. Clusters are split where the cache order already
+ * restarts, and where splitting keeps the cache miss ratio within threshold times what it was.
+ * @param threshold 1 keeps the cache efficiency as it is, MESH_OVERDRAW_THRESHOLD is a good default.
+ */
+SAPI void mesh_optimize_overdraw(u32 *indices,
+								 u32 index_count,
+								 const vertex_3d *vertices,
+								 u32 vertex_count,
+								 f32 threshold);
+
+// Renumbers vertices in the order triangles first use them, so they are fetched front to back. Unused vertices
+// are dropped.
+SAPI void mesh_optimize_vertex_fetch(mesh_data *mesh);
+
+// Runs the optimizations above in the order they build on each other.
+SAPI void mesh_optimize(mesh_data *mesh);
+
+// Average vertices transformed per triangle with a FIFO cache of cache_size, between 0.5 and 3. Lower is better.
+SAPI f32 mesh_average_cache_miss_ratio(const u32 *indices, u32 index_count, u32 vertex_count, u32 cache_size);
@@ -0,0 +1,615 @@
+#include "mesh_loader.h"
+
+#include "containers/darray.h"
+#include "core/logger.h"
+#include "core/smemory.h"
+#include "core/sstring.h"
+#include "json.h"
+#include "math/smath.h"
+
+#include <string.h>
+
+static b8 is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Words of a line, split on spaces and tabs.
+static string_view next_word(string_view *line) {
+	u64 start = 0;
+	while (start < line->length && is_space(line->data[start])) { start++; }
+	u64 end = start;
+	while (end < line->length && !is_space(line->data[end])) { end++; }
+	string_view word = string_view_substring(*line, start, end - start);
+	*line            = string_view_substring(*line, end, line->length - end);
+	return word;
+}
+
+static b8 read_floats(string_view *line, u32 count, f32 *out_values) {
+	for (u32 i = 0; i < count; ++i) {
+		f64 value;
+		if (!string_view_to_f64(next_word(line), &value)) { return false; }
+		out_values[i] = (f32)value;
+	}
+	return true;
+}
+
+// OBJ indices count from 1, negative ones back from the last element read so far.
+static b8 resolve_obj_index(string_view text, u64 count, u64 *out_index) {
+	f64 value;
+	if (!string_view_to_f64(text, &value) || value == 0 || value != (f64)(i64)value) { return false; }
+	i64 index = value > 0 ? (i64)value - 1 : (i64)count + (i64)value;
+	if (index < 0 || (u64)index >= count) { return false; }
+	*out_index = (u64)index;
+	return true;
+}
+
+// A face corner is position[/texture_coordinate[/normal]].
+static b8 read_obj_corner(string_view word, vec3 *positions, vec2 *texture_coordinates, vertex_3d *out) {
+	u64 slash = 0;
+	while (slash < word.length && word.data[slash] != '/') { slash++; }
+
+	u64 position;
+	if (!resolve_obj_index(string_view_substring(word, 0, slash), darray_length(positions), &position)) {
+		return false;
+	}
+	out->position           = positions[position];
+	out->texture_coordinate = vec2_zero();
+
+	string_view rest = string_view_substring(word, slash + 1, word.length);
+	u64 end          = 0;
+	while (end < rest.length && rest.data[end] != '/') { end++; }
+	if (slash < word.length && end > 0) {
+		u64 texture_coordinate;
+		if (!resolve_obj_index(string_view_substring(rest, 0, end),
+							   darray_length(texture_coordinates),
+							   &texture_coordinate)) {
+			return false;
+		}
+		out->texture_coordinate = texture_coordinates[texture_coordinate];
+	}
+	return true;
+}
+
+b8 mesh_import_obj(const void *data, u64 size, mesh_data *out_mesh) {
+	szero_memory(out_mesh, sizeof(mesh_data));
+	vec3 *positions           = darray_create(vec3);
+	vec2 *texture_coordinates = darray_create(vec2);
+	vertex_3d *corners        = darray_create(vertex_3d);
+
+	const char *text = data;
+	u64 position     = 0;
+	u64 line_number  = 0;
+	b8 success       = true;
+	while (success && position < size) {
+		u64 end = position;
+		while (end < size && text[end] != '\n') { end++; }
+		string_view line = {.data = text + position, .length = end - position};
+		position         = end + 1;
+		line_number++;
+
+		string_view keyword = next_word(&line);
+		if (string_view_equal(keyword, string_view_create("v"))) {
+			vec3 p;
+			success = read_floats(&line, 3, p.elements);
+			darray_push(positions, p);
+		} else if (string_view_equal(keyword, string_view_create("vt"))) {
+			vec2 t;
+			success = read_floats(&line, 2, t.elements);
+			t.y     = 1.0f - t.y;
+			darray_push(texture_coordinates, t);
+		} else if (string_view_equal(keyword, string_view_create("f"))) {
+			// Fanned out from the first corner.
+			vertex_3d first, previous, current;
+			szero_memory(&first, sizeof(vertex_3d));
+			szero_memory(&previous, sizeof(vertex_3d));
+			u32 corner_count = 0;
+			for (string_view word = next_word(&line); success && word.length > 0; word = next_word(&line)) {
+				success = read_obj_corner(word, positions, texture_coordinates, &current);
+				if (success && corner_count >= 2) {
+					darray_push(corners, first);
+					darray_push(corners, previous);
+					darray_push(corners, current);
+				}
+				if (corner_count++ == 0) { first = current; }
+				previous = current;
+			}
+			success = success && corner_count >= 3;
+		}
+	}
+
+	if (!success) {
+		SERROR("mesh_import_obj - Line %llu is malformed.", line_number);
+	} else if (!mesh_weld(corners, (u32)darray_length(corners), out_mesh)) {
+		SERROR("mesh_import_obj - No faces to import.");
+		success = false;
+	}
+
+	darray_destroy(corners);
+	darray_destroy(texture_coordinates);
+	darray_destroy(positions);
+	return success;
+}
+
+// Binary glTF: a 12 byte header, then chunks of u32 length, u32 type and data padded to 4 bytes.
+#define GLB_MAGIC 0x46546C67U
+#define GLB_CHUNK_JSON 0x4E4F534AU
+#define GLB_CHUNK_BIN 0x004E4942U
+// Nodes nest at most this deep, which bounds the recursion walking them.
+#define GLTF_MAX_NODE_DEPTH 64
+
+typedef enum gltf_component_type {
+	GLTF_COMPONENT_BYTE           = 5120,
+	GLTF_COMPONENT_UNSIGNED_BYTE  = 5121,
+	GLTF_COMPONENT_SHORT          = 5122,
+	GLTF_COMPONENT_UNSIGNED_SHORT = 5123,
+	GLTF_COMPONENT_UNSIGNED_INT   = 5125,
+	GLTF_COMPONENT_FLOAT          = 5126,
+} gltf_component_type;
+
+#define GLTF_MODE_TRIANGLES 4
+
+typedef struct gltf_buffer {
+	const u8 *data;
+	u64 size;
+	// Decoded from a data URI, freed with the import.
+	b8 owned;
+} gltf_buffer;
+
+typedef struct gltf_accessor {
+	const u8 *data;
+	u32 count;
+	u32 stride;
+	u32 component_type;
+	u32 component_count;
+	b8 normalized;
+} gltf_accessor;
+
+typedef struct gltf_import {
+	json_document json;
+	u32 buffer_count;
+	gltf_buffer *buffers;
+	// darray
+	vertex_3d *corners;
+	// Indexed like the nodes array. Nodes form trees, one reached twice is shared or part of a cycle.
+	u32 node_count;
+	b8 *visited_nodes;
+} gltf_import;
+
+// @returns fallback if token is INVALID_ID, INVALID_ID if it isn't a whole number that fits.
+static u32 to_u32(const json_document *json, u32 token, u32 fallback) {
+	if (token == INVALID_ID) { return fallback; }
+	f64 value = json_number(json, token, -1);
+	return value >= 0 && value < (f64)INVALID_ID && value == (f64)(u32)value ? (u32)value : INVALID_ID;
+}
+
+static u32 get_u32(const json_document *json, u32 object, const char *key, u32 fallback) {
+	return to_u32(json, json_object_get(json, object, key), fallback);
+}
+
+static u32 get_element(const gltf_import *import, const char *array, u32 index) {
+	return json_array_get(&import->json, json_object_get(&import->json, 0, array), index);
+}
+
+static u32 component_size(u32 component_type) {
+	switch (component_type) {
+		case GLTF_COMPONENT_BYTE:
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return 1;
+		case GLTF_COMPONENT_SHORT:
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+			return 2;
+		case GLTF_COMPONENT_UNSIGNED_INT:
+		case GLTF_COMPONENT_FLOAT:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+static u32 component_count(const json_document *json, u32 type) {
+	static const char *types[] = {"SCALAR", "VEC2", "VEC3", "VEC4"};
+	for (u32 i = 0; i < 4; ++i) {
+		if (json_string_equal(json, type, types[i])) { return i + 1; }
+	}
+	return 0;
+}
+
+static u8 base64_value(char c) {
+	if (c >= 'A' && c <= 'Z') { return (u8)(c - 'A'); }
+	if (c >= 'a' && c <= 'z') { return (u8)(c - 'a' + 26); }
+	if (c >= '0' && c <= '9') { return (u8)(c - '0' + 52); }
+	if (c == '+') { return 62; }
+	if (c == '/') { return 63; }
+	return 0xFF;
+}
+
+// Backslashes are skipped, JSON may escape the slashes.
+static b8 base64_decode(string_view text, gltf_buffer *out_buffer) {
+	u64 digit_count = 0;
+	for (u64 i = 0; i < text.length && text.data[i] != '='; ++i) {
+		if (text.data[i] == '\\') { continue; }
+		if (base64_value(text.data[i]) == 0xFF) { return false; }
+		digit_count++;
+	}
+
+	u64 size  = digit_count * 6 / 8;
+	u8 *data  = sallocate(SMAX(size, 1), MEMORY_TAG_RESOURCE);
+	u32 bits  = 0;
+	u32 count = 0;
+	u64 out   = 0;
+	for (u64 i = 0; i < text.length && text.data[i] != '=' && out < size; ++i) {
+		if (text.data[i] == '\\') { continue; }
+		bits = (bits << 6) | base64_value(text.data[i]);
+		count += 6;
+		if (count >= 8) {
+			count -= 8;
+			data[out++] = (u8)(bits >> count);
+		}
+	}
+
+	out_buffer->data  = data;
+	out_buffer->size  = size;
+	out_buffer->owned = true;
+	return true;
+}
+
+static b8 load_buffers(gltf_import *import, const u8 *binary_chunk, u64 binary_size) {
+	const json_document *json = &import->json;
+	u32 buffers               = json_object_get(json, 0, "buffers");
+	import->buffer_count      = buffers == INVALID_ID ? 0 : json->tokens[buffers].child_count;
+	if (import->buffer_count == 0) { return true; }
+	import->buffers = sallocate(sizeof(gltf_buffer) * import->buffer_count, MEMORY_TAG_RESOURCE);
+
+	for (u32 i = 0; i < import->buffer_count; ++i) {
+		u32 buffer      = json_array_get(json, buffers, i);
+		u32 byte_length = get_u32(json, buffer, "byteLength", INVALID_ID);
+		u32 uri         = json_object_get(json, buffer, "uri");
+		gltf_buffer *b  = &import->buffers[i];
+
+		if (uri == INVALID_ID) {
+			// Only the first buffer of a .glb may leave out its URI, it's the binary chunk.
+			if (i != 0 || !binary_chunk) {
+				SERROR("mesh_import_gltf - Buffer %u has no data.", i);
+				return false;
+			}
+			b->data = binary_chunk;
+			b->size = binary_size;
+		} else {
+			const json_token *t = &json->tokens[uri];
+			string_view text    = {.data = json->text + t->start, .length = t->length};
+			u64 marker          = 0;
+			while (marker + 8 <= text.length && memcmp(text.data + marker, ";base64,", 8) != 0) { marker++; }
+			if (t->length < 5 || memcmp(text.data, "data:", 5) != 0 || marker + 8 > text.length) {
+				SERROR("mesh_import_gltf - Buffer %u is an external file, only embedded buffers are read. Export the "
+					   "model as .glb.",
+					   i);
+				return false;
+			}
+			if (!base64_decode(string_view_substring(text, marker + 8, text.length), b)) {
+				SERROR("mesh_import_gltf - Buffer %u is not valid base64.", i);
+				return false;
+			}
+		}
+
+		if (byte_length == INVALID_ID || b->size < byte_length) {
+			SERROR("mesh_import_gltf - Buffer %u is shorter than its byteLength.", i);
+			return false;
+		}
+	}
+	return true;
+}
+
+static b8 read_accessor(const gltf_import *import, u32 index, gltf_accessor *out_accessor) {
+	const json_document *json = &import->json;
+	u32 accessor              = get_element(import, "accessors", index);
+	u32 view                  = get_element(import, "bufferViews", get_u32(json, accessor, "bufferView", INVALID_ID));
+	if (accessor == INVALID_ID || view == INVALID_ID) { return false; }
+
+	u32 buffer = get_u32(json, view, "buffer", INVALID_ID);
+	if (buffer >= import->buffer_count) { return false; }
+
+	out_accessor->count           = get_u32(json, accessor, "count", INVALID_ID);
+	out_accessor->component_type  = get_u32(json, accessor, "componentType", INVALID_ID);
+	out_accessor->component_count = component_count(json, json_object_get(json, accessor, "type"));
+	out_accessor->normalized      = json_boolean(json, json_object_get(json, accessor, "normalized"), false);
+	u32 element_size = component_size(out_accessor->component_type) * out_accessor->component_count;
+	if (out_accessor->count == INVALID_ID || out_accessor->count == 0 || element_size == 0) { return false; }
+
+	u64 view_offset      = get_u32(json, view, "byteOffset", 0);
+	u64 view_length      = get_u32(json, view, "byteLength", INVALID_ID);
+	u64 accessor_offset  = get_u32(json, accessor, "byteOffset", 0);
+	out_accessor->stride = get_u32(json, view, "byteStride", element_size);
+	if (view_offset == INVALID_ID || view_length == INVALID_ID || accessor_offset == INVALID_ID
+		|| out_accessor->stride == INVALID_ID || out_accessor->stride < element_size) {
+		return false;
+	}
+
+	// Everything the accessor reads has to lie in its view, and the view in its buffer.
+	const gltf_buffer *b = &import->buffers[buffer];
+	u64 last_element_end = accessor_offset + (u64)out_accessor->stride * (out_accessor->count - 1) + element_size;
+	if (view_offset + view_length > b->size || last_element_end > view_length) { return false; }
+
+	out_accessor->data = b->data + view_offset + accessor_offset;
+	return true;
+}
+
+static f32 read_component(const gltf_accessor *accessor, u32 element, u32 component) {
+	u32 size    = component_size(accessor->component_type);
+	const u8 *p = accessor->data + (u64)accessor->stride * element + size * component;
+	switch (accessor->component_type) {
+		case GLTF_COMPONENT_FLOAT: {
+			f32 value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return accessor->normalized ? (f32)*p / 255.0f : (f32)*p;
+		case GLTF_COMPONENT_BYTE:
+			return accessor->normalized ? SMAX((f32)(i8)*p / 127.0f, -1.0f) : (f32)(i8)*p;
+		case GLTF_COMPONENT_UNSIGNED_SHORT: {
+			u16 value;
+			memcpy(&value, p, sizeof(value));
+			return accessor->normalized ? (f32)value / 65535.0f : (f32)value;
+		}
+		case GLTF_COMPONENT_SHORT: {
+			i16 value;
+			memcpy(&value, p, sizeof(value));
+			return accessor->normalized ? SMAX((f32)value / 32767.0f, -1.0f) : (f32)value;
+		}
+		default:
+			return 0;
+	}
+}
+
+static u32 read_index(const gltf_accessor *accessor, u32 element) {
+	const u8 *p = accessor->data + (u64)accessor->stride * element;
+	switch (accessor->component_type) {
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return *p;
+		case GLTF_COMPONENT_UNSIGNED_SHORT: {
+			u16 value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+		default: {
+			u32 value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+	}
+}
+
+static b8 import_primitive(gltf_import *import, u32 primitive, mat4 transform, b8 mirrored) {
+	const json_document *json = &import->json;
+	if (get_u32(json, primitive, "mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES) {
+		SWARN("mesh_import_gltf - Skipping a primitive that isn't a triangle list.");
+		return true;
+	}
+
+	u32 attributes = json_object_get(json, primitive, "attributes");
+	gltf_accessor positions, texture_coordinates, indices;
+	if (!read_accessor(import, get_u32(json, attributes, "POSITION", INVALID_ID), &positions)
+		|| positions.component_type != GLTF_COMPONENT_FLOAT || positions.component_count != 3) {
+		SERROR("mesh_import_gltf - A primitive has no valid POSITION attribute.");
+		return false;
+	}
+
+	u32 texture_coordinate_index = get_u32(json, attributes, "TEXCOORD_0", INVALID_ID);
+	b8 has_texture_coordinates   = texture_coordinate_index != INVALID_ID;
+	if (has_texture_coordinates
+		&& (!read_accessor(import, texture_coordinate_index, &texture_coordinates)
+			|| texture_coordinates.component_count != 2 || texture_coordinates.count < positions.count)) {
+		SERROR("mesh_import_gltf - A primitive's TEXCOORD_0 attribute is invalid.");
+		return false;
+	}
+
+	u32 indices_index = get_u32(json, primitive, "indices", INVALID_ID);
+	b8 indexed        = indices_index != INVALID_ID;
+	if (indexed
+		&& (!read_accessor(import, indices_index, &indices) || indices.component_count != 1
+			|| indices.component_type == GLTF_COMPONENT_FLOAT || indices.component_type == GLTF_COMPONENT_BYTE
+			|| indices.component_type == GLTF_COMPONENT_SHORT)) {
+		SERROR("mesh_import_gltf - A primitive's indices are invalid.");
+		return false;
+	}
+
+	u32 corner_count = indexed ? indices.count : positions.count;
+	for (u32 i = 0; i + 2 < corner_count; i += 3) {
+		vertex_3d triangle[3];
+		for (u32 k = 0; k < 3; ++k) {
+			u32 v = indexed ? read_index(&indices, i + k) : i + k;
+			if (v >= positions.count) {
+				SERROR("mesh_import_gltf - A primitive indexes past its vertices.");
+				return false;
+			}
+			vec3 p = {{read_component(&positions, v, 0), read_component(&positions, v, 1),
+					   read_component(&positions, v, 2)}};
+			triangle[k].position           = vec3_transform(p, transform);
+			triangle[k].texture_coordinate = vec2_zero();
+			if (has_texture_coordinates) {
+				triangle[k].texture_coordinate.x = read_component(&texture_coordinates, v, 0);
+				triangle[k].texture_coordinate.y = read_component(&texture_coordinates, v, 1);
+			}
+		}
+		// A mirroring transform turns the winding around, turn it back.
+		darray_push(import->corners, triangle[0]);
+		darray_push(import->corners, triangle[mirrored ? 2 : 1]);
+		darray_push(import->corners, triangle[mirrored ? 1 : 2]);
+	}
+	return true;
+}
+
+static b8 import_mesh(gltf_import *import, u32 index, mat4 transform) {
+	u32 mesh = get_element(import, "meshes", index);
+	if (mesh == INVALID_ID) {
+		SERROR("mesh_import_gltf - Mesh %u doesn't exist.", index);
+		return false;
+	}
+
+	// The sign of the determinant of the upper 3x3.
+	const f32 *m = transform.data;
+	f32 determinant = m[0] * (m[5] * m[10] - m[6] * m[9]) - m[1] * (m[4] * m[10] - m[6] * m[8])
+					+ m[2] * (m[4] * m[9] - m[5] * m[8]);
+
+	u32 primitives = json_object_get(&import->json, mesh, "primitives");
+	for (u32 i = 0; i < (primitives == INVALID_ID ? 0 : import->json.tokens[primitives].child_count); ++i) {
+		if (!import_primitive(import, json_array_get(&import->json, primitives, i), transform, determinant < 0)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static b8 read_numbers(const json_document *json, u32 array, u32 count, f32 *out_values) {
+	if (array == INVALID_ID) { return true; }
+	if (json->tokens[array].type != JSON_TYPE_ARRAY || json->tokens[array].child_count != count) { return false; }
+	for (u32 i = 0; i < count; ++i) { out_values[i] = (f32)json_number(json, json_array_get(json, array, i), 0); }
+	return true;
+}
+
+// glTF matrices are column-major for column vectors, which lays them out exactly like mat4.
+static b8 node_transform(const json_document *json, u32 node, mat4 *out_transform) {
+	*out_transform = mat4_identity();
+	if (json_object_get(json, node, "matrix") != INVALID_ID) {
+		return read_numbers(json, json_object_get(json, node, "matrix"), 16, out_transform->data);
+	}
+
+	vec3 translation = vec3_zero();
+	quat rotation    = quat_identity();
+	vec3 scale       = vec3_one();
+	if (!read_numbers(json, json_object_get(json, node, "translation"), 3, translation.elements)
+		|| !read_numbers(json, json_object_get(json, node, "rotation"), 4, rotation.elements)
+		|| !read_numbers(json, json_object_get(json, node, "scale"), 3, scale.elements)) {
+		return false;
+	}
+	// Scale, then rotate, then translate. quat_to_mat4 is laid out for column vectors.
+	mat4 rotation_matrix = mat4_transposed(quat_to_mat4(rotation));
+	*out_transform       = mat4_mul(mat4_mul(mat4_scale(scale), rotation_matrix), mat4_translation(translation));
+	return true;
+}
+
+static b8 import_node(gltf_import *import, u32 index, mat4 parent, u32 depth) {
+	const json_document *json = &import->json;
+	u32 node                  = get_element(import, "nodes", index);
+	mat4 local;
+	if (node == INVALID_ID || depth > GLTF_MAX_NODE_DEPTH || import->visited_nodes[index]
+		|| !node_transform(json, node, &local)) {
+		SERROR("mesh_import_gltf - Node %u is invalid, nested too deep or has more than one parent.", index);
+		return false;
+	}
+	import->visited_nodes[index] = true;
+
+	// Applied to the node's vertices before its parents' transforms.
+	mat4 transform = mat4_mul(local, parent);
+	u32 mesh       = get_u32(json, node, "mesh", INVALID_ID);
+	if (mesh != INVALID_ID && !import_mesh(import, mesh, transform)) { return false; }
+
+	u32 children = json_object_get(json, node, "children");
+	for (u32 i = 0; i < (children == INVALID_ID ? 0 : json->tokens[children].child_count); ++i) {
+		u32 child = to_u32(json, json_array_get(json, children, i), INVALID_ID);
+		if (!import_node(import, child, transform, depth + 1)) { return false; }
+	}
+	return true;
+}
+
+static b8 import_scene(gltf_import *import) {
+	const json_document *json = &import->json;
+	u32 scene                 = get_element(import, "scenes", get_u32(json, 0, "scene", 0));
+	if (scene == INVALID_ID) {
+		u32 meshes = json_object_get(json, 0, "meshes");
+		for (u32 i = 0; i < (meshes == INVALID_ID ? 0 : json->tokens[meshes].child_count); ++i) {
+			if (!import_mesh(import, i, mat4_identity())) { return false; }
+		}
+		return true;
+	}
+
+	u32 all_nodes         = json_object_get(json, 0, "nodes");
+	import->node_count    = all_nodes == INVALID_ID ? 0 : json->tokens[all_nodes].child_count;
+	import->visited_nodes = sallocate(SMAX(import->node_count, 1), MEMORY_TAG_RESOURCE);
+	szero_memory(import->visited_nodes, SMAX(import->node_count, 1));
+
+	b8 success = true;
+	u32 nodes  = json_object_get(json, scene, "nodes");
+	for (u32 i = 0; success && i < (nodes == INVALID_ID ? 0 : json->tokens[nodes].child_count); ++i) {
+		u32 node = to_u32(json, json_array_get(json, nodes, i), INVALID_ID);
+		success  = import_node(import, node, mat4_identity(), 0);
+	}
+
+	sfree(import->visited_nodes, SMAX(import->node_count, 1), MEMORY_TAG_RESOURCE);
+	import->visited_nodes = 0;
+	return success;
+}
+
+static b8 read_u32(const u8 *data, u64 size, u64 offset, u32 *out_value) {
+	if (offset + sizeof(u32) > size) { return false; }
+	memcpy(out_value, data + offset, sizeof(u32));
+	return true;
+}
+
+b8 mesh_import_gltf(const void *data, u64 size, mesh_data *out_mesh) {
+	szero_memory(out_mesh, sizeof(mesh_data));
+	const u8 *bytes  = data;
+	const char *text = data;
+	u64 text_size    = size;
+	const u8 *binary = 0;
+	u64 binary_size  = 0;
+
+	u32 magic = 0;
+	if (read_u32(bytes, size, 0, &magic) && magic == GLB_MAGIC) {
+		u32 version, length, json_length, json_type, binary_length, binary_type;
+		if (!read_u32(bytes, size, 4, &version) || !read_u32(bytes, size, 8, &length) || version != 2
+			|| length > size || !read_u32(bytes, length, 12, &json_length) || !read_u32(bytes, length, 16, &json_type)
+			|| json_type != GLB_CHUNK_JSON || 20 + (u64)json_length > length) {
+			SERROR("mesh_import_gltf - Not a valid glTF 2.0 binary.");
+			return false;
+		}
+		text      = (const char *)bytes + 20;
+		text_size = json_length;
+
+		// The binary chunk is optional.
+		u64 binary_offset = 20 + (((u64)json_length + 3) & ~3ULL);
+		if (read_u32(bytes, length, binary_offset, &binary_length)
+			&& read_u32(bytes, length, binary_offset + 4, &binary_type) && binary_type == GLB_CHUNK_BIN
+			&& binary_offset + 8 + binary_length <= length) {
+			binary      = bytes + binary_offset + 8;
+			binary_size = binary_length;
+		}
+	}
+
+	gltf_import import;
+	szero_memory(&import, sizeof(gltf_import));
+	if (!json_parse(text, text_size, &import.json) || import.json.tokens[0].type != JSON_TYPE_OBJECT) {
+		SERROR("mesh_import_gltf - The JSON is malformed.");
+		json_destroy(&import.json);
+		return false;
+	}
+
+	import.corners = darray_create(vertex_3d);
+	b8 success     = load_buffers(&import, binary, binary_size) && import_scene(&import);
+	if (success && !mesh_weld(import.corners, (u32)darray_length(import.corners), out_mesh)) {
+		SERROR("mesh_import_gltf - No triangles to import.");
+		success = false;
+	}
+
+	for (u32 i = 0; i < import.buffer_count; ++i) {
+		gltf_buffer *b = &import.buffers[i];
+		if (b->owned) { sfree((void *)b->data, SMAX(b->size, 1), MEMORY_TAG_RESOURCE); }
+	}
+	if (import.buffers) { sfree(import.buffers, sizeof(gltf_buffer) * import.buffer_count, MEMORY_TAG_RESOURCE); }
+	darray_destroy(import.corners);
+	json_destroy(&import.json);
+	return success;
+}
+
+static b8 ends_with(const char *str, const char *suffix) {
+	u64 length        = string_length(str);
+	u64 suffix_length = string_length(suffix);
+	return length >= suffix_length && string_equal(str + length - suffix_length, suffix);
+}
+
+b8 mesh_import(const char *path, const void *data, u64 size, mesh_data *out_mesh) {
+	if (ends_with(path, ".obj")) { return mesh_import_obj(data, size, out_mesh); }
+	if (ends_with(path, ".gltf") || ends_with(path, ".glb")) { return mesh_import_gltf(data, size, out_mesh); }
+
+	szero_memory(out_mesh, sizeof(mesh_data));
+	SERROR("mesh_import - '%s' is not a mesh format that can be imported.", path);
+	return false;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "mesh.h"
+
+/**
+ * Reads the triangles of a Wavefront OBJ held in memory. Only v, vt and f lines are read, faces with more than
+ * three corners become fans. Texture coordinates are flipped to the renderer's top-left origin.
+ * The result is welded, not yet optimized.
+ */
+SAPI b8 mesh_import_obj(const void *data, u64 size, mesh_data *out_mesh);
+
+/**
+ * Reads the triangle meshes of a glTF 2.0 model held in memory, either binary (.glb) or JSON with its buffers
+ * embedded as data URIs. Meshes are placed by the node transforms of the default scene, or taken as they are
+ * without one. Only POSITION and TEXCOORD_0 are read. The result is welded, not yet optimized.
+ */
+SAPI b8 mesh_import_gltf(const void *data, u64 size, mesh_data *out_mesh);
+
+// Picks the importer by the extension path ends in: .obj, .gltf or .glb.
+SAPI b8 mesh_import(const char *path, const void *data, u64 size, mesh_data *out_mesh);
@@ -0,0 +1,226 @@
+#include "mipmap.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#define MIP_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+// Source texels each output texel of MIP_FILTER_KAISER is weighed from, per axis.
+#define KAISER_TAPS 8
+// Window shape, higher trades sharpness for less ringing.
+#define KAISER_ALPHA 4.0f
+#define MIP_PI 3.14159265358979323846f
+
+// One RGBA texel as floats, so both Kaiser passes share their loops with and without SSE2.
+#if defined(MIP_SSE2)
+typedef __m128 texel;
+
+static inline texel texel_zero() { return _mm_setzero_ps(); }
+static inline texel texel_load(const f32 *p) { return _mm_loadu_ps(p); }
+static inline void texel_store(f32 *p, texel t) { _mm_storeu_ps(p, t); }
+static inline texel texel_madd(texel acc, texel t, f32 weight) {
+	return _mm_add_ps(acc, _mm_mul_ps(t, _mm_set1_ps(weight)));
+}
+
+static inline texel texel_load_u8(const u8 *p) {
+	i32 bytes;
+	memcpy(&bytes, p, 4);
+	__m128i zero = _mm_setzero_si128();
+	__m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+	return _mm_cvtepi32_ps(wide);
+}
+
+// Rounds to nearest and saturates, the sinc lobes can overshoot either way.
+static inline void texel_store_u8(u8 *p, texel t) {
+	__m128i wide = _mm_cvtps_epi32(t);
+	wide         = _mm_packs_epi32(wide, wide);
+	i32 bytes    = _mm_cvtsi128_si32(_mm_packus_epi16(wide, wide));
+	memcpy(p, &bytes, 4);
+}
+#else
+typedef struct texel {
+	f32 c[4];
+} texel;
+
+static inline texel texel_zero() { return (texel){{0}}; }
+static inline texel texel_load(const f32 *p) { return (texel){{p[0], p[1], p[2], p[3]}}; }
+static inline void texel_store(f32 *p, texel t) { memcpy(p, t.c, sizeof(t.c)); }
+static inline texel texel_madd(texel acc, texel t, f32 weight) {
+	for (u32 i = 0; i < 4; ++i) { acc.c[i] += t.c[i] * weight; }
+	return acc;
+}
+
+static inline texel texel_load_u8(const u8 *p) { return (texel){{p[0], p[1], p[2], p[3]}}; }
+
+static inline void texel_store_u8(u8 *p, texel t) {
+	for (u32 i = 0; i < 4; ++i) {
+		f32 value = SMIN(SMAX(t.c[i], 0.0f), 255.0f);
+		p[i]      = (u8)(value + 0.5f);
+	}
+}
+#endif
+
+u32 mip_level_count(u32 width, u32 height) {
+	u32 levels  = 1;
+	u32 largest = SMAX(width, height);
+	while (largest > 1) {
+		largest >>= 1;
+		levels++;
+	}
+	return levels;
+}
+
+u64 mip_chain_size(u32 width, u32 height, u32 level_count) {
+	u64 size = 0;
+	for (u32 level = 0; level < level_count; ++level) {
+		size += (u64)mip_level_dimension(width, level) * mip_level_dimension(height, level) * 4;
+	}
+	return size;
+}
+
+u64 mip_scratch_size(u32 width, u32 height) {
+	// The Kaiser filter's horizontal pass, as floats.
+	return (u64)mip_level_dimension(width, 1) * height * 4 * sizeof(f32);
+}
+
+static void downsample_box(const u8 *src, u32 width, u32 height, u8 *dest) {
+	u32 dest_width  = mip_level_dimension(width, 1);
+	u32 dest_height = mip_level_dimension(height, 1);
+
+	for (u32 y = 0; y < dest_height; ++y) {
+		const u8 *row0 = src + (u64)(2 * y) * width * 4;
+		const u8 *row1 = src + (u64)SMIN(2 * y + 1, height - 1) * width * 4;
+		u8 *out        = dest + (u64)y * dest_width * 4;
+		u32 x          = 0;
+
+#if defined(MIP_SSE2)
+		// Four output texels from eight in each row, widened to 16 bits so the sums are exact.
+		const __m128i zero  = _mm_setzero_si128();
+		const __m128i round = _mm_set1_epi16(2);
+		for (; 2 * x + 8 <= width; x += 4) {
+			__m128i a0 = _mm_loadu_si128((const __m128i *)(row0 + x * 8));
+			__m128i a1 = _mm_loadu_si128((const __m128i *)(row0 + x * 8 + 16));
+			__m128i b0 = _mm_loadu_si128((const __m128i *)(row1 + x * 8));
+			__m128i b1 = _mm_loadu_si128((const __m128i *)(row1 + x * 8 + 16));
+
+			// Vertical sums, two texels to a register.
+			__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+			__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+			__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+			__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+			// Then each texel with its right neighbour.
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+			__m128i hi = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+			lo         = _mm_srli_epi16(_mm_add_epi16(lo, round), 2);
+			hi         = _mm_srli_epi16(_mm_add_epi16(hi, round), 2);
+			_mm_storeu_si128((__m128i *)(out + x * 4), _mm_packus_epi16(lo, hi));
+		}
+#endif
+
+		for (; x < dest_width; ++x) {
+			u32 x0 = 2 * x * 4;
+			u32 x1 = SMIN(2 * x + 1, width - 1) * 4;
+			for (u32 c = 0; c < 4; ++c) {
+				u32 sum        = (u32)row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+				out[x * 4 + c] = (u8)((sum + 2) >> 2);
+			}
+		}
+	}
+}
+
+// Zeroth order modified Bessel function of the first kind, from its power series.
+static f32 bessel_i0(f32 x) {
+	f32 sum            = 1.0f;
+	f32 term           = 1.0f;
+	f32 quarter_square = x * x * 0.25f;
+	for (u32 k = 1; k < 32 && term > sum * 1e-7f; ++k) {
+		term *= quarter_square / (f32)(k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static void kaiser_weights(f32 weights[KAISER_TAPS]) {
+	const f32 radius = KAISER_TAPS / 2;
+	f32 total        = 0;
+	for (u32 i = 0; i < KAISER_TAPS; ++i) {
+		// Distance from the output texel's centre in source texels, never 0 with an even tap count.
+		f32 offset = (f32)i - radius + 0.5f;
+		f32 t      = offset / radius;
+		f32 window = bessel_i0(KAISER_ALPHA * sqrtf(1.0f - t * t)) / bessel_i0(KAISER_ALPHA);
+		// Cut off at the output's Nyquist frequency, half the source's.
+		f32 x      = offset * 0.5f;
+		weights[i] = window * sinf(MIP_PI * x) / (MIP_PI * x);
+		total += weights[i];
+	}
+	for (u32 i = 0; i < KAISER_TAPS; ++i) { weights[i] /= total; }
+}
+
+static inline u32 clamp_tap(i64 index, u32 count) { return (u32)SMIN(SMAX(index, 0), (i64)count - 1); }
+
+// Separable, horizontally into scratch then vertically into dest.
+static void downsample_kaiser(const u8 *src, u32 width, u32 height, u8 *dest, f32 *scratch) {
+	u32 dest_width  = mip_level_dimension(width, 1);
+	u32 dest_height = mip_level_dimension(height, 1);
+	f32 weights[KAISER_TAPS];
+	kaiser_weights(weights);
+
+	for (u32 y = 0; y < height; ++y) {
+		const u8 *row = src + (u64)y * width * 4;
+		f32 *out      = scratch + (u64)y * dest_width * 4;
+		for (u32 x = 0; x < dest_width; ++x) {
+			// Output texel x is centred between source texels 2x and 2x + 1.
+			i64 first = (i64)(2 * x) - (KAISER_TAPS / 2 - 1);
+			texel acc = texel_zero();
+			if (first >= 0 && first + KAISER_TAPS <= width) {
+				const u8 *taps = row + first * 4;
+				for (u32 i = 0; i < KAISER_TAPS; ++i) {
+					acc = texel_madd(acc, texel_load_u8(taps + i * 4), weights[i]);
+				}
+			} else {
+				for (u32 i = 0; i < KAISER_TAPS; ++i) {
+					acc = texel_madd(acc, texel_load_u8(row + clamp_tap(first + i, width) * 4), weights[i]);
+				}
+			}
+			texel_store(out + x * 4, acc);
+		}
+	}
+
+	for (u32 y = 0; y < dest_height; ++y) {
+		const f32 *rows[KAISER_TAPS];
+		i64 first = (i64)(2 * y) - (KAISER_TAPS / 2 - 1);
+		for (u32 i = 0; i < KAISER_TAPS; ++i) {
+			rows[i] = scratch + (u64)clamp_tap(first + i, height) * dest_width * 4;
+		}
+
+		u8 *out = dest + (u64)y * dest_width * 4;
+		for (u32 x = 0; x < dest_width; ++x) {
+			texel acc = texel_zero();
+			for (u32 i = 0; i < KAISER_TAPS; ++i) { acc = texel_madd(acc, texel_load(rows[i] + x * 4), weights[i]); }
+			texel_store_u8(out + x * 4, acc);
+		}
+	}
+}
+
+void mip_downsample(const u8 *src, u32 width, u32 height, mip_filter filter, u8 *dest, void *scratch) {
+	if (filter == MIP_FILTER_KAISER) {
+		downsample_kaiser(src, width, height, dest, scratch);
+	} else {
+		downsample_box(src, width, height, dest);
+	}
+}
+
+void mip_generate_chain(u8 *pixels, u32 width, u32 height, u32 level_count, mip_filter filter, void *scratch) {
+	u8 *level = pixels;
+	for (u32 i = 1; i < level_count; ++i) {
+		u32 level_width  = mip_level_dimension(width, i - 1);
+		u32 level_height = mip_level_dimension(height, i - 1);
+		u8 *next         = level + (u64)level_width * level_height * 4;
+		mip_downsample(level, level_width, level_height, filter, next, scratch);
+		level = next;
+	}
+}
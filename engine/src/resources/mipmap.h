@@ -0,0 +1,33 @@
+#pragma once
+
+#include "defines.h"
+
+typedef enum mip_filter {
+	// 2x2 average, matching what the renderer's blits produce at runtime.
+	MIP_FILTER_BOX,
+	// Kaiser windowed sinc over 8x8 texels. Slower, keeps the smaller levels sharper. Meant for offline cooking.
+	MIP_FILTER_KAISER,
+} mip_filter;
+
+// Levels in a full chain down to 1x1.
+SAPI u32 mip_level_count(u32 width, u32 height);
+// Width or height of a level, never below 1.
+SINLINE u32 mip_level_dimension(u32 dimension, u32 level) { return SMAX(1U, dimension >> level); }
+// Bytes of a chain of RGBA8 levels stored one after another, level 0 first.
+SAPI u64 mip_chain_size(u32 width, u32 height, u32 level_count);
+// Bytes of scratch memory mip_downsample and mip_generate_chain need for an image of this size.
+SAPI u64 mip_scratch_size(u32 width, u32 height);
+
+/**
+ * Halves an RGBA8 image into dest, which holds mip_level_dimension(width, 1) * mip_level_dimension(height, 1)
+ * pixels. Odd dimensions round down like the renderer's mip sizes and the filter clamps at the edges. Nothing
+ * is allocated or logged, so it's safe to call from worker threads.
+ * @param scratch At least mip_scratch_size(width, height) bytes, only used by MIP_FILTER_KAISER.
+ */
+SAPI void mip_downsample(const u8 *src, u32 width, u32 height, mip_filter filter, u8 *dest, void *scratch);
+
+/**
+ * Fills levels 1 to level_count - 1 of a chain laid out as mip_chain_size describes, each from the one before.
+ * @param pixels Level 0 on entry, at least mip_chain_size(width, height, level_count) bytes.
+ */
+SAPI void mip_generate_chain(u8 *pixels, u32 width, u32 height, u32 level_count, mip_filter filter, void *scratch);
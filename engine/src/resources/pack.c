@@ -0,0 +1,259 @@
+#include "pack.h"
+
+#include "core/event.h"
+#include "core/logger.h"
+#include "core/lz.h"
+#include "core/smemory.h"
+#include "core/sstring.h"
+
+// Compressed assets handed out by asset_map at the same time.
+#define MAX_DECOMPRESSED_ASSETS 64
+// Assets changed on disk since startup, read from their loose files instead of the pack.
+#define MAX_CHANGED_ASSETS 256
+
+typedef struct pack_system_state {
+	pack default_pack;
+	b8 has_pack;
+	// Buffers of decompressed assets, freed by asset_unmap.
+	file_view decompressed[MAX_DECOMPRESSED_ASSETS];
+	u32 changed_count;
+	u64 changed_hashes[MAX_CHANGED_ASSETS];
+} pack_system_state;
+
+static pack_system_state *state_ptr;
+
+static b8 pack_validate(const pack *pack, const char *path) {
+	u64 size                  = pack->view.size;
+	const pack_header *header = pack->header;
+
+	if (header->magic != PACK_MAGIC || header->version != PACK_VERSION) {
+		SERROR("pack_open - '%s' is not a pack, or was built by a different version.", path);
+		return false;
+	}
+
+	u64 toc_end = sizeof(pack_header) + (u64)header->entry_count * sizeof(pack_entry);
+	b8 toc_valid = toc_end <= size && header->names_offset >= toc_end && header->names_offset <= size
+				&& header->names_size <= size - header->names_offset;
+	if (!toc_valid) {
+		SERROR("pack_open - '%s' has a truncated table of contents.", path);
+		return false;
+	}
+
+	for (u32 i = 0; i < header->entry_count; ++i) {
+		const pack_entry *entry = &pack->entries[i];
+		b8 payload_valid        = entry->offset <= size && entry->size <= size - entry->offset;
+		b8 name_valid           = (u64)entry->name_offset + entry->name_length < header->names_size
+						&& pack->names[entry->name_offset + entry->name_length] == '\0';
+		b8 sorted               = i == 0 || pack->entries[i - 1].name_hash <= entry->name_hash;
+		// Stored entries keep their size.
+		b8 sizes_valid       = entry->compression != PACK_COMPRESSION_NONE || entry->size == entry->uncompressed_size;
+		b8 compression_valid = entry->compression <= PACK_COMPRESSION_LZ && sizes_valid;
+		if (!payload_valid || !name_valid || !sorted || !compression_valid) {
+			SERROR("pack_open - '%s' has a corrupt entry at index %u.", path, i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+b8 pack_open(const char *path, pack *out_pack) {
+	szero_memory(out_pack, sizeof(pack));
+	if (!filesystem_map(path, &out_pack->view)) { return false; }
+
+	if (out_pack->view.size < sizeof(pack_header)) {
+		SERROR("pack_open - '%s' is too small to be a pack.", path);
+		pack_close(out_pack);
+		return false;
+	}
+
+	const u8 *data    = out_pack->view.data;
+	out_pack->header  = (const pack_header *)data;
+	out_pack->entries = (const pack_entry *)(data + sizeof(pack_header));
+	out_pack->names   = (const char *)(data + out_pack->header->names_offset);
+	if (!pack_validate(out_pack, path)) {
+		pack_close(out_pack);
+		return false;
+	}
+
+	return true;
+}
+
+void pack_close(pack *pack) {
+	filesystem_unmap(&pack->view);
+	szero_memory(pack, sizeof(*pack));
+}
+
+const pack_entry *pack_find(const pack *pack, const char *name) {
+	if (!pack->header) { return 0; }
+
+	u64 length = string_length(name);
+	u64 hash   = string_hash_n(name, length);
+
+	// First entry with name_hash >= hash.
+	u32 low  = 0;
+	u32 high = pack->header->entry_count;
+	while (low < high) {
+		u32 middle = low + (high - low) / 2;
+		if (pack->entries[middle].name_hash < hash) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	// Names sharing a hash sit next to each other.
+	for (u32 i = low; i < pack->header->entry_count && pack->entries[i].name_hash == hash; ++i) {
+		const pack_entry *entry = &pack->entries[i];
+		if (entry->name_length == length && string_equal(pack->names + entry->name_offset, name)) { return entry; }
+	}
+
+	return 0;
+}
+
+b8 pack_entry_view(const pack *pack, const pack_entry *entry, file_view *out_view) {
+	out_view->data = 0;
+	out_view->size = 0;
+
+	if (entry->compression != PACK_COMPRESSION_NONE) {
+		SERROR("pack_entry_view - '%s' is compressed and has to be decompressed.", pack->names + entry->name_offset);
+		return false;
+	}
+
+	out_view->data = (const u8 *)pack->view.data + entry->offset;
+	out_view->size = entry->size;
+	return true;
+}
+
+b8 pack_entry_decompress(const pack *pack, const pack_entry *entry, void *dest) {
+	const u8 *data = (const u8 *)pack->view.data + entry->offset;
+	if (entry->compression == PACK_COMPRESSION_NONE) {
+		scopy_memory(dest, data, entry->size);
+		return true;
+	}
+
+	if (!lz_decompress(data, entry->size, dest, entry->uncompressed_size)) {
+		SERROR("pack_entry_decompress - '%s' is corrupt.", pack->names + entry->name_offset);
+		return false;
+	}
+	return true;
+}
+
+static b8 map_compressed(const pack_entry *entry, file_view *out_view) {
+	u32 slot = MAX_DECOMPRESSED_ASSETS;
+	for (u32 i = 0; i < MAX_DECOMPRESSED_ASSETS; ++i) {
+		if (!state_ptr->decompressed[i].data) {
+			slot = i;
+			break;
+		}
+	}
+	if (slot == MAX_DECOMPRESSED_ASSETS) {
+		SERROR("asset_map - Too many compressed assets mapped at once.");
+		return false;
+	}
+
+	// At least a byte, so the slot is taken even for empty entries.
+	u64 size = SMAX(entry->uncompressed_size, 1);
+	u8 *data = sallocate(size, MEMORY_TAG_RESOURCE);
+	if (!pack_entry_decompress(&state_ptr->default_pack, entry, data)) {
+		sfree(data, size, MEMORY_TAG_RESOURCE);
+		return false;
+	}
+
+	state_ptr->decompressed[slot] = (file_view){data, size};
+	out_view->data                = data;
+	out_view->size                = entry->uncompressed_size;
+	return true;
+}
+
+static b8 is_changed(u64 name_hash) {
+	for (u32 i = 0; i < state_ptr->changed_count; ++i) {
+		if (state_ptr->changed_hashes[i] == name_hash) { return true; }
+	}
+	return false;
+}
+
+static b8 pack_on_asset_changed(u16 code, void *sender, void *listener_instance, event_context context) {
+	(void)code;
+	(void)sender;
+	(void)listener_instance;
+
+	u64 name_hash = context.data.u64[0];
+	if (!is_changed(name_hash) && state_ptr->changed_count < MAX_CHANGED_ASSETS) {
+		state_ptr->changed_hashes[state_ptr->changed_count++] = name_hash;
+	}
+	// Registered before any system that reloads, so they see the new file.
+	return false;
+}
+
+b8 pack_system_initialize(u64 *memory_requirement, void *state, const char *path) {
+	*memory_requirement = sizeof(pack_system_state);
+	if (state == 0) { return true; }
+
+	szero_memory(state, sizeof(pack_system_state));
+	state_ptr = state;
+
+	// Without a pack, assets are read from loose files instead.
+	if (filesystem_exists(path)) {
+		state_ptr->has_pack = pack_open(path, &state_ptr->default_pack);
+		if (!state_ptr->has_pack) { return false; }
+		SINFO("Using asset pack '%s' with %u entries.", path, state_ptr->default_pack.header->entry_count);
+		if (!event_register(EVENT_CODE_ASSET_CHANGED, state_ptr, pack_on_asset_changed)) {
+			SWARN("pack_system_initialize - Not listening for asset changes, edits stay hidden by the pack.");
+		}
+	}
+
+	return true;
+}
+
+void pack_system_shutdown(void *state) {
+	(void)state;
+	if (!state_ptr) { return; }
+
+	for (u32 i = 0; i < MAX_DECOMPRESSED_ASSETS; ++i) {
+		file_view *buffer = &state_ptr->decompressed[i];
+		if (buffer->data) { sfree((void *)buffer->data, buffer->size, MEMORY_TAG_RESOURCE); }
+	}
+	if (state_ptr->has_pack) {
+		event_unregister(EVENT_CODE_ASSET_CHANGED, state_ptr, pack_on_asset_changed);
+		pack_close(&state_ptr->default_pack);
+	}
+	state_ptr = 0;
+}
+
+b8 asset_map(const char *name, file_view *out_view) {
+	if (state_ptr && state_ptr->has_pack && !is_changed(string_hash(name))) {
+		const pack_entry *entry = pack_find(&state_ptr->default_pack, name);
+		if (entry && entry->compression != PACK_COMPRESSION_NONE) { return map_compressed(entry, out_view); }
+		if (entry) { return pack_entry_view(&state_ptr->default_pack, entry, out_view); }
+	}
+
+	// Assets added since the pack was built are still found on disk.
+	char path[512];
+	string_format_n(path, sizeof(path), "assets/%s", name);
+	return filesystem_map(path, out_view);
+}
+
+void asset_unmap(file_view *view) {
+	for (u32 i = 0; state_ptr && view->data && i < MAX_DECOMPRESSED_ASSETS; ++i) {
+		file_view *buffer = &state_ptr->decompressed[i];
+		if (buffer->data == view->data) {
+			sfree((void *)buffer->data, buffer->size, MEMORY_TAG_RESOURCE);
+			buffer->data = 0;
+			view->data   = 0;
+			view->size   = 0;
+			return;
+		}
+	}
+
+	// Views into the pack stay mapped with it.
+	const u8 *pack_data = state_ptr ? state_ptr->default_pack.view.data : 0;
+	const u8 *data      = view->data;
+	if (pack_data && data >= pack_data && data < pack_data + state_ptr->default_pack.view.size) {
+		view->data = 0;
+		view->size = 0;
+		return;
+	}
+
+	filesystem_unmap(view);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/filesystem.h"
+#include "defines.h"
+
+/**
+ * Asset pack layout, everything little-endian:
+ *   pack_header
+ *   pack_entry[entry_count], sorted by name_hash
+ *   names, each terminated, referenced by pack_entry.name_offset
+ *   payloads, each starting on a PACK_ALIGNMENT boundary
+ * Names are paths relative to the assets directory with '/' separators, e.g. "shaders/x.vert.spv".
+ */
+#define PACK_MAGIC 0x4B434150U
+#define PACK_VERSION 1
+#define PACK_ALIGNMENT KIBIBYTES(4)
+
+// Default pack next to the executable, built from the assets directory by asset_packer.
+#define PACK_DEFAULT_PATH "assets.pack"
+
+typedef enum pack_compression {
+	PACK_COMPRESSION_NONE = 0,
+	// An lz_compress stream, see core/lz.h.
+	PACK_COMPRESSION_LZ = 1,
+} pack_compression;
+
+typedef struct pack_header {
+	u32 magic;
+	u32 version;
+	u32 entry_count;
+	u32 reserved;
+	u64 names_offset;
+	u64 names_size;
+} pack_header;
+
+typedef struct pack_entry {
+	// string_hash of the name.
+	u64 name_hash;
+	u64 offset;
+	// Stored size, smaller than uncompressed_size when compressed.
+	u64 size;
+	u64 uncompressed_size;
+	u32 name_offset;
+	u16 name_length;
+	u8 compression;
+	u8 reserved;
+} pack_entry;
+
+// An opened pack. Entries and payloads point into the mapping.
+typedef struct pack {
+	file_view view;
+	const pack_header *header;
+	const pack_entry *entries;
+	const char *names;
+} pack;
+
+// Maps and validates the pack at path.
+SAPI b8 pack_open(const char *path, pack *out_pack);
+SAPI void pack_close(pack *pack);
+
+// Binary search on the name's hash. @returns 0 if the pack has no such entry.
+SAPI const pack_entry *pack_find(const pack *pack, const char *name);
+
+// Zero-copy view of an uncompressed entry's data.
+SAPI b8 pack_entry_view(const pack *pack, const pack_entry *entry, file_view *out_view);
+
+// Decompresses an entry into dest, which holds at least entry->uncompressed_size bytes.
+SAPI b8 pack_entry_decompress(const pack *pack, const pack_entry *entry, void *dest);
+
+b8 pack_system_initialize(u64 *memory_requirement, void *state, const char *path);
+void pack_system_shutdown(void *state);
+
+/**
+ * Maps an asset by its name relative to the assets directory. Served from the default pack when it was found
+ * at startup, otherwise the loose file under assets/ is mapped. Compressed entries are decompressed into a
+ * buffer that lives until asset_unmap. Assets the file watcher reports as changed come from their loose files.
+ */
+SAPI b8 asset_map(const char *name, file_view *out_view);
+SAPI void asset_unmap(file_view *view);
@@ -0,0 +1,765 @@
+#include "png.h"
+
+#include "core/logger.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#define PNG_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+#define PNG_COLOR_GRAY 0
+#define PNG_COLOR_RGB 2
+#define PNG_COLOR_PALETTE 3
+#define PNG_COLOR_GRAY_ALPHA 4
+#define PNG_COLOR_RGBA 6
+
+#define PNG_CHUNK_TYPE(a, b, c, d) (((u32)(a) << 24) | ((u32)(b) << 16) | ((u32)(c) << 8) | (u32)(d))
+#define PNG_CHUNK_IHDR PNG_CHUNK_TYPE('I', 'H', 'D', 'R')
+#define PNG_CHUNK_PLTE PNG_CHUNK_TYPE('P', 'L', 'T', 'E')
+#define PNG_CHUNK_TRNS PNG_CHUNK_TYPE('t', 'R', 'N', 'S')
+#define PNG_CHUNK_IDAT PNG_CHUNK_TYPE('I', 'D', 'A', 'T')
+#define PNG_CHUNK_IEND PNG_CHUNK_TYPE('I', 'E', 'N', 'D')
+
+// Chunk length, type and CRC around the data.
+#define PNG_CHUNK_OVERHEAD 12
+
+// Deflate's history. The window keeps this much output behind the write position and room for a full match in front.
+#define PNG_HISTORY_SIZE KIBIBYTES(32)
+#define PNG_MAX_MATCH 258
+// Chunked match copies write up to this far past a match.
+#define PNG_COPY_SLACK 16
+
+// Codes up to this long decode with a single table lookup, longer ones are rare and searched.
+#define PNG_FAST_BITS 10
+#define PNG_FAST_MASK ((1u << PNG_FAST_BITS) - 1)
+
+static const u8 png_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+static const u16 length_base[29]    = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+									   31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const u8 length_extra[29]    = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+									   2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const u16 distance_base[30]  = {1,    2,    3,    4,    5,    7,    9,     13,    17,    25,
+									   33,   49,   65,   97,   129,  193,  257,   385,   513,   769,
+									   1025, 1537, 2049, 3073, 4097, 6145, 8193,  12289, 16385, 24577};
+static const u8 distance_extra[30]  = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+									   6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const u8 code_length_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+typedef struct huffman {
+	// (length << 9) | symbol for codes of up to PNG_FAST_BITS, indexed by the next bits of input. 0 if longer.
+	u16 fast[1 << PNG_FAST_BITS];
+	// Canonical codes of each length, for the longer ones.
+	u16 first_code[16];
+	u16 first_symbol[16];
+	u32 max_code[17];
+	u16 symbols[288];
+} huffman;
+
+typedef struct png_decoder {
+	// Bit reader over the IDAT chunks, which together form one zlib stream.
+	const u8 *in;
+	const u8 *in_end;
+	const u8 *next_chunk;
+	const u8 *data_end;
+	u64 bits;
+	u32 bit_count;
+	// Zero bytes read past the last IDAT. Refills read ahead, only consuming them is an error.
+	u32 padding;
+
+	// Inflated, still filtered rows. Matches reach back into the history kept at the start.
+	u8 *window;
+	u8 *out;
+	u8 *flush_limit;
+	u8 *row_start;
+
+	u32 width;
+	u32 height;
+	u8 color_type;
+	u8 bit_depth;
+	u32 row;
+	u64 row_bytes;
+	// Bytes per complete pixel, at least 1, which is how far back the filters look.
+	u32 filter_stride;
+	u8 *dest;
+	// Rows are unfiltered straight into dest, otherwise into the row buffers and converted to RGBA from there.
+	b8 direct;
+	u8 *prior;
+	u8 *current;
+
+	u8 palette[256 * 4];
+	b8 has_key;
+	u16 key[3];
+
+	huffman litlen;
+	huffman distance;
+} png_decoder;
+
+static u32 read_be32(const u8 *p) { return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | (u32)p[3]; }
+
+static u16 read_be16(const u8 *p) { return (u16)((p[0] << 8) | p[1]); }
+
+static u64 read_le64(const u8 *p) {
+	u64 value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static u32 channel_count(u8 color_type) {
+	switch (color_type) {
+		case PNG_COLOR_RGB:
+			return 3;
+		case PNG_COLOR_GRAY_ALPHA:
+			return 2;
+		case PNG_COLOR_RGBA:
+			return 4;
+		default:
+			return 1;
+	}
+}
+
+static b8 valid_format(u8 color_type, u8 bit_depth) {
+	switch (color_type) {
+		case PNG_COLOR_GRAY:
+			return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16;
+		case PNG_COLOR_PALETTE:
+			return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8;
+		case PNG_COLOR_RGB:
+		case PNG_COLOR_GRAY_ALPHA:
+		case PNG_COLOR_RGBA:
+			return bit_depth == 8 || bit_depth == 16;
+		default:
+			return false;
+	}
+}
+
+// Row buffers hold an unfiltered row, or a row of zeros above the first one in dest.
+static u64 row_buffer_size(u32 width, u64 row_bytes) { return SMAX(row_bytes, (u64)width * 4); }
+
+static u64 window_size(u64 row_bytes) {
+	// History, a partially inflated row and space to inflate into before the next flush.
+	return PNG_HISTORY_SIZE * 2 + row_bytes + 1 + PNG_MAX_MATCH + PNG_COPY_SLACK;
+}
+
+// Finds the next chunk of data. @returns False at the end or if the chunk doesn't fit in the data.
+static b8 next_chunk(const u8 **p, const u8 *end, u32 *out_type, const u8 **out_data, u32 *out_length) {
+	if (end - *p < PNG_CHUNK_OVERHEAD) { return false; }
+	u32 length = read_be32(*p);
+	if (length > (u64)(end - *p) - PNG_CHUNK_OVERHEAD) { return false; }
+
+	*out_type   = read_be32(*p + 4);
+	*out_data   = *p + 8;
+	*out_length = length;
+	*p += PNG_CHUNK_OVERHEAD + length;
+	return true;
+}
+
+b8 png_read_info(const void *data, u64 size, png_info *out_info) {
+	const u8 *p   = data;
+	const u8 *end = p + size;
+	if (size < sizeof(png_signature) || memcmp(p, png_signature, sizeof(png_signature)) != 0) {
+		SERROR("png_read_info - Not a PNG.");
+		return false;
+	}
+	p += sizeof(png_signature);
+
+	u32 type, length;
+	const u8 *chunk;
+	if (!next_chunk(&p, end, &type, &chunk, &length) || type != PNG_CHUNK_IHDR || length != 13) {
+		SERROR("png_read_info - Missing image header.");
+		return false;
+	}
+
+	out_info->width      = read_be32(chunk);
+	out_info->height     = read_be32(chunk + 4);
+	out_info->bit_depth  = chunk[8];
+	out_info->color_type = chunk[9];
+	if (out_info->width == 0 || out_info->height == 0 || out_info->width > PNG_MAX_DIMENSION
+		|| out_info->height > PNG_MAX_DIMENSION) {
+		SERROR("png_read_info - Unsupported size %ux%u.", out_info->width, out_info->height);
+		return false;
+	}
+	if (!valid_format(out_info->color_type, out_info->bit_depth) || chunk[10] != 0 || chunk[11] != 0) {
+		SERROR("png_read_info - Invalid format.");
+		return false;
+	}
+	if (chunk[12] != 0) {
+		SERROR("png_read_info - Interlaced images are not supported.");
+		return false;
+	}
+
+	b8 has_data                = false;
+	out_info->has_transparency = out_info->color_type == PNG_COLOR_GRAY_ALPHA || out_info->color_type == PNG_COLOR_RGBA;
+	while (next_chunk(&p, end, &type, &chunk, &length) && type != PNG_CHUNK_IEND) {
+		if (type == PNG_CHUNK_IDAT) { has_data = true; }
+		if (type == PNG_CHUNK_TRNS) { out_info->has_transparency = true; }
+	}
+	if (!has_data) {
+		SERROR("png_read_info - No image data.");
+		return false;
+	}
+
+	u64 row_bytes = ((u64)out_info->width * channel_count(out_info->color_type) * out_info->bit_depth + 7) / 8;
+	out_info->scratch_size = window_size(row_bytes) + row_buffer_size(out_info->width, row_bytes) * 2;
+	return true;
+}
+
+// Moves on to the next IDAT chunk's data. They have to follow each other.
+static b8 next_data_chunk(png_decoder *d) {
+	u32 type, length;
+	const u8 *chunk;
+	while (next_chunk(&d->next_chunk, d->data_end, &type, &chunk, &length) && type == PNG_CHUNK_IDAT) {
+		d->in     = chunk;
+		d->in_end = chunk + length;
+		if (length > 0) { return true; }
+	}
+	d->next_chunk = d->data_end;
+	return false;
+}
+
+// Tops the bit buffer up to at least 56 bits. Called with fewer than 64 bits buffered.
+static void refill(png_decoder *d) {
+	if (d->in_end - d->in >= 8) {
+		// Loads whole words, the bytes that didn't fit are loaded again by the next refill.
+		d->bits |= read_le64(d->in) << d->bit_count;
+		d->in += (63 - d->bit_count) >> 3;
+		d->bit_count |= 56;
+		return;
+	}
+
+	while (d->bit_count <= 56) {
+		if (d->in == d->in_end && !next_data_chunk(d)) {
+			d->padding++;
+			d->bit_count += 8;
+			continue;
+		}
+		d->bits |= (u64)*d->in++ << d->bit_count;
+		d->bit_count += 8;
+	}
+}
+
+static u32 take_bits(png_decoder *d, u32 count) {
+	u32 value = (u32)(d->bits & ((1ull << count) - 1));
+	d->bits >>= count;
+	d->bit_count -= count;
+	return value;
+}
+
+static u32 reverse16(u32 v) {
+	v = ((v & 0xAAAA) >> 1) | ((v & 0x5555) << 1);
+	v = ((v & 0xCCCC) >> 2) | ((v & 0x3333) << 2);
+	v = ((v & 0xF0F0) >> 4) | ((v & 0x0F0F) << 4);
+	return ((v & 0xFF00) >> 8) | ((v & 0x00FF) << 8);
+}
+
+static b8 huffman_build(huffman *h, const u8 *lengths, u32 count) {
+	u32 length_count[16] = {0};
+	for (u32 i = 0; i < count; ++i) { length_count[lengths[i]]++; }
+	length_count[0] = 0;
+	memset(h->fast, 0, sizeof(h->fast));
+
+	u32 next_code[16];
+	u32 code   = 0;
+	u32 symbol = 0;
+	for (u32 length = 1; length < 16; ++length) {
+		next_code[length]     = code;
+		h->first_code[length] = (u16)code;
+		h->first_symbol[length] = (u16)symbol;
+		code += length_count[length];
+		// Oversubscribed, incomplete codes are allowed.
+		if (code > (1u << length)) { return false; }
+		h->max_code[length] = code << (16 - length);
+		code <<= 1;
+		symbol += length_count[length];
+	}
+	h->max_code[16] = 0x10000;
+
+	for (u32 i = 0; i < count; ++i) {
+		u32 length = lengths[i];
+		if (length == 0) { continue; }
+
+		h->symbols[next_code[length] - h->first_code[length] + h->first_symbol[length]] = (u16)i;
+		if (length <= PNG_FAST_BITS) {
+			// Deflate packs codes starting at their most significant bit, the table is indexed least significant first.
+			u16 entry = (u16)((length << 9) | i);
+			for (u32 j = reverse16(next_code[length]) >> (16 - length); j < (1u << PNG_FAST_BITS); j += 1u << length) {
+				h->fast[j] = entry;
+			}
+		}
+		next_code[length]++;
+	}
+	return true;
+}
+
+// Needs at least 15 bits buffered. @returns The symbol, or -1 for a code that isn't in the table.
+static i32 huffman_decode(png_decoder *d, const huffman *h) {
+	u32 entry = h->fast[d->bits & PNG_FAST_MASK];
+	if (entry) {
+		take_bits(d, entry >> 9);
+		return (i32)(entry & 511);
+	}
+
+	// Shorter codes sort first, so the length is the first whose range holds the code.
+	u32 code   = reverse16((u32)d->bits & 0xFFFF);
+	u32 length = PNG_FAST_BITS + 1;
+	while (code >= h->max_code[length]) { length++; }
+	if (length == 16) { return -1; }
+
+	take_bits(d, length);
+	return h->symbols[(code >> (16 - length)) - h->first_code[length] + h->first_symbol[length]];
+}
+
+static u8 paeth(u8 a, u8 b, u8 c) {
+	i32 pa = b - c;
+	i32 pb = a - c;
+	i32 pc = pa + pb;
+	pa     = pa < 0 ? -pa : pa;
+	pb     = pb < 0 ? -pb : pb;
+	pc     = pc < 0 ? -pc : pc;
+	if (pa <= pb && pa <= pc) { return a; }
+	return pb <= pc ? b : c;
+}
+
+static b8 unfilter_row(u8 *current, const u8 *prior, const u8 *raw, u64 size, u32 stride, u8 filter) {
+	switch (filter) {
+		case 0:
+			memcpy(current, raw, size);
+			return true;
+		case 1:
+			memcpy(current, raw, stride);
+			for (u64 i = stride; i < size; ++i) { current[i] = (u8)(raw[i] + current[i - stride]); }
+			return true;
+		case 2: {
+			u64 i = 0;
+#if defined(PNG_SSE2)
+			for (; i + 16 <= size; i += 16) {
+				__m128i up = _mm_add_epi8(_mm_loadu_si128((const __m128i *)(raw + i)),
+										  _mm_loadu_si128((const __m128i *)(prior + i)));
+				_mm_storeu_si128((__m128i *)(current + i), up);
+			}
+#endif
+			for (; i < size; ++i) { current[i] = (u8)(raw[i] + prior[i]); }
+			return true;
+		}
+		case 3:
+			for (u64 i = 0; i < stride; ++i) { current[i] = (u8)(raw[i] + (prior[i] >> 1)); }
+			for (u64 i = stride; i < size; ++i) {
+				current[i] = (u8)(raw[i] + ((current[i - stride] + prior[i]) >> 1));
+			}
+			return true;
+		case 4:
+			for (u64 i = 0; i < stride; ++i) { current[i] = (u8)(raw[i] + prior[i]); }
+			for (u64 i = stride; i < size; ++i) {
+				current[i] = (u8)(raw[i] + paeth(current[i - stride], prior[i], prior[i - stride]));
+			}
+			return true;
+		default:
+			return false;
+	}
+}
+
+#if defined(PNG_SSE2)
+static __m128i load4(const u8 *p) {
+	i32 value;
+	memcpy(&value, p, 4);
+	return _mm_cvtsi32_si128(value);
+}
+
+static void store4(u8 *p, __m128i v) {
+	i32 value = _mm_cvtsi128_si32(v);
+	memcpy(p, &value, 4);
+}
+
+static __m128i abs_epi16(__m128i v) { return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v)); }
+
+static __m128i select_epi16(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/**
+ * Unfilters an RGB8 or RGBA8 row straight into RGBA8 dest. Sub, average and paeth depend on the pixel to the left,
+ * so they step a pixel at a time with every channel in a lane. RGB pixels are loaded 4 bytes at a time, the byte
+ * of the next pixel only reaches the alpha lane, which is made opaque when stored.
+ */
+static b8 unfilter_row_rgba_sse2(u8 *dest, const u8 *prior, const u8 *raw, u32 width, u32 stride, u8 filter) {
+	const __m128i zero   = _mm_setzero_si128();
+	const __m128i opaque = stride == 3 ? _mm_cvtsi32_si128((i32)0xFF000000) : zero;
+	__m128i a            = zero;
+
+	switch (filter) {
+		case 0:
+			for (u32 x = 0; x < width; ++x) { store4(dest + x * 4, _mm_or_si128(load4(raw + x * stride), opaque)); }
+			return true;
+		case 1:
+			for (u32 x = 0; x < width; ++x) {
+				a = _mm_add_epi8(a, load4(raw + x * stride));
+				store4(dest + x * 4, _mm_or_si128(a, opaque));
+			}
+			return true;
+		case 2:
+			if (stride == 4) { return unfilter_row(dest, prior, raw, (u64)width * 4, stride, filter); }
+			for (u32 x = 0; x < width; ++x) {
+				store4(dest + x * 4, _mm_or_si128(_mm_add_epi8(load4(raw + x * stride), load4(prior + x * 4)), opaque));
+			}
+			return true;
+		case 3: {
+			const __m128i one = _mm_set1_epi8(1);
+			for (u32 x = 0; x < width; ++x) {
+				__m128i b = load4(prior + x * 4);
+				// _mm_avg_epu8 rounds up, the filter rounds down.
+				__m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+				a               = _mm_add_epi8(load4(raw + x * stride), average);
+				store4(dest + x * 4, _mm_or_si128(a, opaque));
+			}
+			return true;
+		}
+		case 4: {
+			const __m128i low_byte = _mm_set1_epi16(0xFF);
+			__m128i c              = zero;
+			for (u32 x = 0; x < width; ++x) {
+				__m128i b = _mm_unpacklo_epi8(load4(prior + x * 4), zero);
+
+				// Distances from a + b - c to a, b and c.
+				__m128i pa       = _mm_sub_epi16(b, c);
+				__m128i pb       = _mm_sub_epi16(a, c);
+				__m128i pc       = abs_epi16(_mm_add_epi16(pa, pb));
+				pa               = abs_epi16(pa);
+				pb               = abs_epi16(pb);
+				__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+				// Ties go to a, then b.
+				__m128i nearest = select_epi16(_mm_cmpeq_epi16(smallest, pb), b, c);
+				nearest         = select_epi16(_mm_cmpeq_epi16(smallest, pa), a, nearest);
+
+				a = _mm_and_si128(_mm_add_epi16(_mm_unpacklo_epi8(load4(raw + x * stride), zero), nearest), low_byte);
+				c = b;
+				store4(dest + x * 4, _mm_or_si128(_mm_packus_epi16(a, a), opaque));
+			}
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+#endif
+
+// Converts an unfiltered row of any other format to RGBA8.
+static void expand_row(const png_decoder *d, const u8 *row, u8 *dest) {
+	u32 width = d->width;
+	u8 depth  = d->bit_depth;
+
+	switch (d->color_type) {
+		case PNG_COLOR_GRAY:
+		case PNG_COLOR_PALETTE: {
+			b8 palette = d->color_type == PNG_COLOR_PALETTE;
+			// Scales gray up to 8 bits, e.g. 1 bit becomes 0 or 255.
+			u32 scale = palette ? 1 : (depth == 1 ? 255 : depth == 2 ? 85 : depth == 4 ? 17 : 1);
+			for (u32 x = 0; x < width; ++x, dest += 4) {
+				u32 value;
+				if (depth == 16) {
+					value = read_be16(row + x * 2);
+				} else {
+					u32 bit = x * depth;
+					value   = (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1u << depth) - 1);
+				}
+
+				if (palette) {
+					memcpy(dest, d->palette + value * 4, 4);
+					continue;
+				}
+				u8 gray = depth == 16 ? (u8)(value >> 8) : (u8)(value * scale);
+				dest[0] = dest[1] = dest[2] = gray;
+				dest[3]                     = d->has_key && value == d->key[0] ? 0 : 255;
+			}
+			return;
+		}
+		case PNG_COLOR_RGB:
+			for (u32 x = 0; x < width; ++x, dest += 4) {
+				if (depth == 8) {
+					const u8 *p = row + x * 3;
+					dest[0]     = p[0];
+					dest[1]     = p[1];
+					dest[2]     = p[2];
+					dest[3]     = d->has_key && p[0] == d->key[0] && p[1] == d->key[1] && p[2] == d->key[2] ? 0 : 255;
+				} else {
+					const u8 *p = row + x * 6;
+					u16 r = read_be16(p), g = read_be16(p + 2), b = read_be16(p + 4);
+					dest[0] = p[0];
+					dest[1] = p[2];
+					dest[2] = p[4];
+					dest[3] = d->has_key && r == d->key[0] && g == d->key[1] && b == d->key[2] ? 0 : 255;
+				}
+			}
+			return;
+		case PNG_COLOR_GRAY_ALPHA: {
+			u32 step = depth == 8 ? 2 : 4;
+			for (u32 x = 0; x < width; ++x, dest += 4) {
+				const u8 *p = row + x * step;
+				dest[0] = dest[1] = dest[2] = p[0];
+				dest[3]                     = p[step / 2];
+			}
+			return;
+		}
+		default:
+			// RGBA16, RGBA8 never gets here.
+			for (u32 x = 0; x < width; ++x, dest += 4) {
+				const u8 *p = row + x * 8;
+				dest[0]     = p[0];
+				dest[1]     = p[2];
+				dest[2]     = p[4];
+				dest[3]     = p[6];
+			}
+			return;
+	}
+}
+
+// Unfilters the complete rows inflated so far, then slides the window back to make room.
+static b8 flush(png_decoder *d) {
+	u64 stride = d->row_bytes + 1;
+
+	while ((u64)(d->out - d->row_start) >= stride) {
+		if (d->row == d->height) { return false; }
+
+		u64 dest_pitch = (u64)d->width * 4;
+		u8 *dest_row   = d->dest + d->row * dest_pitch;
+		const u8 *raw  = d->row_start + 1;
+		u8 filter      = d->row_start[0];
+		b8 unfiltered;
+		if (d->direct) {
+			// The row above is already in dest, the first one sees zeros.
+			const u8 *prior = d->row ? dest_row - dest_pitch : d->prior;
+#if defined(PNG_SSE2)
+			unfiltered = unfilter_row_rgba_sse2(dest_row, prior, raw, d->width, d->filter_stride, filter);
+#else
+			unfiltered = unfilter_row(dest_row, prior, raw, d->row_bytes, d->filter_stride, filter);
+#endif
+		} else {
+			unfiltered = unfilter_row(d->current, d->prior, raw, d->row_bytes, d->filter_stride, filter);
+			expand_row(d, d->current, dest_row);
+			u8 *swap   = d->prior;
+			d->prior   = d->current;
+			d->current = swap;
+		}
+		if (!unfiltered) { return false; }
+		d->row_start += stride;
+		d->row++;
+	}
+
+	// Keep the history matches may still refer to, and the row that's only partially inflated.
+	u8 *keep = (u64)(d->out - d->window) > PNG_HISTORY_SIZE ? d->out - PNG_HISTORY_SIZE : d->window;
+	keep     = SMIN(keep, d->row_start);
+	memmove(d->window, keep, (u64)(d->out - keep));
+	d->row_start -= keep - d->window;
+	d->out -= keep - d->window;
+	return true;
+}
+
+static b8 inflate_stored(png_decoder *d) {
+	take_bits(d, d->bit_count & 7);
+	if (d->bit_count < 32) { refill(d); }
+	u32 length = take_bits(d, 16);
+	if ((take_bits(d, 16) ^ 0xFFFF) != length) { return false; }
+
+	// Rare in PNGs, so no effort goes into copying them quickly.
+	for (u32 i = 0; i < length; ++i) {
+		if (d->out >= d->flush_limit && !flush(d)) { return false; }
+		if (d->bit_count < 8) { refill(d); }
+		*d->out++ = (u8)take_bits(d, 8);
+	}
+	return true;
+}
+
+static b8 inflate_codes(png_decoder *d, const huffman *litlen, const huffman *distance) {
+	u8 *out = d->out;
+	while (true) {
+		if (out >= d->flush_limit) {
+			d->out = out;
+			if (!flush(d)) { return false; }
+			out = d->out;
+		}
+		// Enough for a length and a distance, codes and extra bits included.
+		if (d->bit_count < 48) { refill(d); }
+
+		i32 symbol = huffman_decode(d, litlen);
+		if (symbol < 256) {
+			if (symbol < 0) { return false; }
+			*out++ = (u8)symbol;
+			continue;
+		}
+		if (symbol == 256) { break; }
+
+		symbol -= 257;
+		if (symbol >= 29) { return false; }
+		u32 length = length_base[symbol] + take_bits(d, length_extra[symbol]);
+
+		symbol = huffman_decode(d, distance);
+		if (symbol < 0 || symbol >= 30) { return false; }
+		u64 offset = distance_base[symbol] + take_bits(d, distance_extra[symbol]);
+		if (offset > (u64)(out - d->window)) { return false; }
+
+		// The flush limit leaves room for a whole match and the chunks overshooting it.
+		const u8 *match = out - offset;
+		if (offset >= 16) {
+			for (u32 i = 0; i < length; i += 16) { memcpy(out + i, match + i, 16); }
+		} else if (offset >= 8) {
+			for (u32 i = 0; i < length; i += 8) { memcpy(out + i, match + i, 8); }
+		} else if (offset == 1) {
+			memset(out, match[0], length);
+		} else {
+			for (u32 i = 0; i < length; ++i) { out[i] = match[i]; }
+		}
+		out += length;
+	}
+
+	d->out = out;
+	return true;
+}
+
+static b8 inflate_dynamic_tables(png_decoder *d) {
+	if (d->bit_count < 14) { refill(d); }
+	u32 litlen_count   = take_bits(d, 5) + 257;
+	u32 distance_count = take_bits(d, 5) + 1;
+	u32 header_count   = take_bits(d, 4) + 4;
+	if (litlen_count > 286 || distance_count > 30) { return false; }
+
+	u8 header_lengths[19] = {0};
+	for (u32 i = 0; i < header_count; ++i) {
+		if (d->bit_count < 3) { refill(d); }
+		header_lengths[code_length_order[i]] = (u8)take_bits(d, 3);
+	}
+	// Code lengths are coded with their own table, which the litlen table is free to be rebuilt over afterwards.
+	if (!huffman_build(&d->litlen, header_lengths, 19)) { return false; }
+
+	u8 lengths[286 + 30];
+	u32 total = litlen_count + distance_count;
+	for (u32 i = 0; i < total;) {
+		if (d->bit_count < 32) { refill(d); }
+		i32 symbol = huffman_decode(d, &d->litlen);
+		if (symbol < 0) { return false; }
+		if (symbol < 16) {
+			lengths[i++] = (u8)symbol;
+			continue;
+		}
+
+		u32 repeat;
+		u8 value = 0;
+		if (symbol == 16) {
+			if (i == 0) { return false; }
+			value  = lengths[i - 1];
+			repeat = 3 + take_bits(d, 2);
+		} else if (symbol == 17) {
+			repeat = 3 + take_bits(d, 3);
+		} else {
+			repeat = 11 + take_bits(d, 7);
+		}
+		if (repeat > total - i) { return false; }
+		memset(lengths + i, value, repeat);
+		i += repeat;
+	}
+
+	// A block has to be able to end.
+	if (lengths[256] == 0) { return false; }
+	return huffman_build(&d->litlen, lengths, litlen_count)
+		&& huffman_build(&d->distance, lengths + litlen_count, distance_count);
+}
+
+static b8 inflate_fixed_tables(png_decoder *d) {
+	u8 lengths[288];
+	memset(lengths, 8, 144);
+	memset(lengths + 144, 9, 112);
+	memset(lengths + 256, 7, 24);
+	memset(lengths + 280, 8, 8);
+	if (!huffman_build(&d->litlen, lengths, 288)) { return false; }
+
+	memset(lengths, 5, 30);
+	return huffman_build(&d->distance, lengths, 30);
+}
+
+static b8 inflate(png_decoder *d) {
+	refill(d);
+	u32 cmf = take_bits(d, 8);
+	u32 flg = take_bits(d, 8);
+	// Deflate, a window of at most 32KiB and no preset dictionary.
+	if ((cmf & 15) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 32)) { return false; }
+
+	b8 final = false;
+	while (!final) {
+		if (d->bit_count < 3) { refill(d); }
+		final     = take_bits(d, 1);
+		u32 type  = take_bits(d, 2);
+		b8 result = false;
+		if (type == 0) {
+			result = inflate_stored(d);
+		} else if (type == 1) {
+			result = inflate_fixed_tables(d) && inflate_codes(d, &d->litlen, &d->distance);
+		} else if (type == 2) {
+			result = inflate_dynamic_tables(d) && inflate_codes(d, &d->litlen, &d->distance);
+		}
+		if (!result) { return false; }
+	}
+
+	// Bits past the end of the data were consumed.
+	if (d->padding * 8 > d->bit_count) { return false; }
+	return flush(d) && d->row == d->height;
+}
+
+b8 png_decode(const void *data, u64 size, const png_info *info, void *dest, void *scratch) {
+	png_decoder d;
+	memset(&d, 0, sizeof(d) - sizeof(d.litlen) - sizeof(d.distance));
+
+	d.width         = info->width;
+	d.height        = info->height;
+	d.color_type    = info->color_type;
+	d.bit_depth     = info->bit_depth;
+	u32 pixel_bits  = channel_count(info->color_type) * info->bit_depth;
+	d.row_bytes     = ((u64)info->width * pixel_bits + 7) / 8;
+	d.filter_stride = SMAX(1, pixel_bits / 8);
+	d.dest          = dest;
+
+	u64 window      = window_size(d.row_bytes);
+	d.window        = scratch;
+	d.out           = d.window;
+	d.row_start     = d.window;
+	d.flush_limit   = d.window + window - PNG_MAX_MATCH - PNG_COPY_SLACK;
+	d.prior         = d.window + window;
+	d.current       = d.prior + row_buffer_size(d.width, d.row_bytes);
+	memset(d.prior, 0, row_buffer_size(d.width, d.row_bytes));
+
+	for (u32 i = 0; i < 256; ++i) { d.palette[i * 4 + 3] = 255; }
+
+	const u8 *p   = (const u8 *)data + sizeof(png_signature);
+	const u8 *end = (const u8 *)data + size;
+	u32 type, length;
+	const u8 *chunk;
+	while (next_chunk(&p, end, &type, &chunk, &length)) {
+		if (type == PNG_CHUNK_PLTE) {
+			for (u32 i = 0; i < SMIN(length / 3, 256); ++i) { memcpy(d.palette + i * 4, chunk + i * 3, 3); }
+		} else if (type == PNG_CHUNK_TRNS) {
+			if (d.color_type == PNG_COLOR_PALETTE) {
+				for (u32 i = 0; i < SMIN(length, 256); ++i) { d.palette[i * 4 + 3] = chunk[i]; }
+			} else {
+				d.has_key = length >= (d.color_type == PNG_COLOR_RGB ? 6u : 2u);
+				for (u32 i = 0; d.has_key && i < (d.color_type == PNG_COLOR_RGB ? 3u : 1u); ++i) {
+					d.key[i] = read_be16(chunk + i * 2);
+				}
+			}
+		} else if (type == PNG_CHUNK_IDAT) {
+			d.in         = chunk;
+			d.in_end     = chunk + length;
+			d.next_chunk = p;
+			d.data_end   = end;
+			break;
+		}
+	}
+	if (!d.in) { return false; }
+
+	// RGBA8 needs no conversion. RGB8 gains its alpha while it's unfiltered, unless a colour is transparent.
+	d.direct = d.color_type == PNG_COLOR_RGBA && d.bit_depth == 8;
+#if defined(PNG_SSE2)
+	d.direct = d.direct || (d.color_type == PNG_COLOR_RGB && d.bit_depth == 8 && !d.has_key);
+#endif
+
+	return inflate(&d);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "defines.h"
+
+// Larger images are rejected, they wouldn't fit in a texture anyway.
+#define PNG_MAX_DIMENSION 16384
+
+typedef struct png_info {
+	u32 width;
+	u32 height;
+	u8 bit_depth;
+	u8 color_type;
+	// The image has an alpha channel or a transparent colour.
+	b8 has_transparency;
+	// Bytes of scratch memory png_decode needs for this image.
+	u64 scratch_size;
+} png_info;
+
+/**
+ * Reads the header of a PNG held in memory. Every colour type and bit depth is supported, interlaced images
+ * are not.
+ * @returns False if data isn't a PNG this decoder handles.
+ */
+SAPI b8 png_read_info(const void *data, u64 size, png_info *out_info);
+
+/**
+ * Decodes the image into dest as width * height RGBA8 pixels, top row first. 16 bit channels keep their high
+ * byte. Rows are inflated through a fixed window in scratch and unfiltered straight into dest, nothing is
+ * allocated, so it's safe to call from worker threads with dest pointing into a texture's staging memory.
+ * Chunk CRCs and the zlib checksum are not verified, corrupt streams fail on their structure instead.
+ * @param scratch At least info->scratch_size bytes.
+ * @returns False if the data is corrupt, dest may then be partially written.
+ */
+SAPI b8 png_decode(const void *data, u64 size, const png_info *info, void *dest, void *scratch);
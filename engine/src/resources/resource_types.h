@@ -2,6 +2,20 @@
 
 #include "math/math_types.inl"
 
+#define TEXTURE_NAME_MAX_LENGTH 256
+
+// How a texture's texels are stored. The block-compressed formats encode 4x4 texels at a time.
+typedef enum texture_format {
+	TEXTURE_FORMAT_RGBA8 = 0,
+	// 8 bytes per block, RGB with optional 1-bit alpha.
+	TEXTURE_FORMAT_BC1 = 1,
+	// 16 bytes per block, BC1's RGB with 8-bit alpha.
+	TEXTURE_FORMAT_BC3 = 2,
+	// 16 bytes per block, RGBA at the best quality of the three.
+	TEXTURE_FORMAT_BC7 = 3,
+	TEXTURE_FORMAT_COUNT
+} texture_format;
+
 typedef struct texture {
 	u32 id;
 	u32 width;
@@ -9,5 +23,18 @@ typedef struct texture {
 	u8 channel_count;
 	b8 has_transparency;
 	u32 generation;
+	char name[TEXTURE_NAME_MAX_LENGTH];
 	void *internal_data;
 } texture;
+
+#define GEOMETRY_NAME_MAX_LENGTH 256
+
+// An indexed triangle list the renderer holds on the GPU.
+typedef struct geometry {
+	u32 id;
+	u32 vertex_count;
+	u32 index_count;
+	u32 generation;
+	char name[GEOMETRY_NAME_MAX_LENGTH];
+	void *internal_data;
+} geometry;
@@ -0,0 +1,241 @@
+#include "texture_loader.h"
+
+#include "core/job_system.h"
+#include "core/logger.h"
+#include "core/smemory.h"
+#include "core/sstring.h"
+#include "mipmap.h"
+#include "pack.h"
+#include "png.h"
+#include "renderer/renderer_frontend.h"
+
+// Everything a load needs between submitting the decode and creating the texture.
+typedef struct texture_load {
+	char name[TEXTURE_NAME_MAX_LENGTH];
+	b8 auto_release;
+	// A PNG described by info, unless stream is set.
+	file_view file;
+	png_info info;
+	void *scratch;
+	// Levels from first_level on are copied out of stream, owned_stream when the load opened it itself.
+	const texture_stream *stream;
+	texture_stream owned_stream;
+	u32 first_level;
+	u32 width;
+	u32 height;
+	texture_format format;
+	u32 level_count;
+	b8 has_transparency;
+	texture_staging staging;
+	texture *out_texture;
+	PFN_on_texture_loaded callback;
+	void *user_data;
+} texture_load;
+
+static void texture_load_destroy(texture_load *load) {
+	if (load->staging.internal_data) { renderer_destroy_texture_staging(&load->staging); }
+	if (load->scratch) { sfree(load->scratch, load->info.scratch_size, MEMORY_TAG_TEXTURE); }
+	asset_unmap(&load->file);
+	texture_stream_close(&load->owned_stream);
+	sfree(load, sizeof(texture_load), MEMORY_TAG_TEXTURE);
+}
+
+static b8 texture_decode_job(void *params) {
+	texture_load *load = *(texture_load **)params;
+	return png_decode(load->file.data, load->file.size, &load->info, load->staging.pixels, load->scratch);
+}
+
+// Cooked levels are already in the format the GPU samples, they only need packing together.
+static void copy_levels(const texture_stream *stream, u32 first_level, u8 *dest) {
+	const cooked_texture *cooked = &stream->cooked;
+	for (u32 i = first_level; i < cooked->header->level_count; ++i) {
+		scopy_memory(dest, cooked->data + cooked->levels[i].offset, cooked->levels[i].size);
+		dest += cooked->levels[i].size;
+	}
+}
+
+static b8 texture_copy_job(void *params) {
+	texture_load *load = *(texture_load **)params;
+	copy_levels(load->stream, load->first_level, load->staging.pixels);
+	return true;
+}
+
+static void texture_load_complete(b8 success, void *params) {
+	texture_load *load = *(texture_load **)params;
+
+	if (success) {
+		renderer_create_texture_from_staging(load->name,
+											 load->auto_release,
+											 load->width,
+											 load->height,
+											 4,
+											 load->format,
+											 load->level_count,
+											 &load->staging,
+											 load->has_transparency,
+											 load->out_texture);
+	} else {
+		SERROR("texture_load_async - Failed to decode '%s'.", load->name);
+	}
+
+	texture *out_texture           = load->out_texture;
+	PFN_on_texture_loaded callback = load->callback;
+	void *user_data                = load->user_data;
+	texture_load_destroy(load);
+	if (callback) { callback(success, out_texture, user_data); }
+}
+
+static texture_load *texture_load_create(const char *name,
+										 b8 auto_release,
+										 texture *out_texture,
+										 PFN_on_texture_loaded callback,
+										 void *user_data) {
+	texture_load *load = sallocate(sizeof(texture_load), MEMORY_TAG_TEXTURE);
+	string_format_n(load->name, TEXTURE_NAME_MAX_LENGTH, "%s", name);
+	load->auto_release = auto_release;
+	load->out_texture  = out_texture;
+	load->callback     = callback;
+	load->user_data    = user_data;
+	return load;
+}
+
+static void texture_load_use_stream(texture_load *load, const texture_stream *stream, u32 first_level) {
+	const cooked_texture_header *header = stream->cooked.header;
+	load->stream                        = stream;
+	load->first_level                   = first_level;
+	load->width                         = mip_level_dimension(header->width, first_level);
+	load->height                        = mip_level_dimension(header->height, first_level);
+	load->format                        = header->format;
+	load->level_count                   = header->level_count - first_level;
+	load->has_transparency              = header->has_transparency;
+}
+
+// Staging is allocated here and filled by job on a worker, it can't allocate itself.
+static b8 texture_load_submit(texture_load *load, u64 staging_size, PFN_job_start job) {
+	if (!renderer_create_texture_staging(staging_size, &load->staging)) {
+		SERROR("texture_load_async - Unable to create staging memory for '%s'.", load->name);
+		texture_load_destroy(load);
+		return false;
+	}
+
+	if (!job_submit(job, texture_load_complete, &load, sizeof(load))) {
+		texture_load_destroy(load);
+		return false;
+	}
+	return true;
+}
+
+b8 texture_load_async(const char *name,
+					  b8 auto_release,
+					  texture *out_texture,
+					  PFN_on_texture_loaded callback,
+					  void *user_data) {
+	texture_load *load = texture_load_create(name, auto_release, out_texture, callback, user_data);
+
+	// Cooked textures are copied into staging as they are, PNGs are decoded there.
+	if (texture_stream_open(name, &load->owned_stream)) {
+		texture_load_use_stream(load, &load->owned_stream, 0);
+		return texture_load_submit(load, texture_stream_size(&load->owned_stream, 0), texture_copy_job);
+	}
+
+	char path[TEXTURE_NAME_MAX_LENGTH + 16];
+	string_format_n(path, sizeof(path), "textures/%s.png", name);
+	if (!asset_map(path, &load->file)) {
+		SERROR("texture_load_async - Unable to open '%s'.", path);
+		sfree(load, sizeof(texture_load), MEMORY_TAG_TEXTURE);
+		return false;
+	}
+
+	if (!png_read_info(load->file.data, load->file.size, &load->info)) {
+		SERROR("texture_load_async - '%s' is not a supported PNG.", path);
+		texture_load_destroy(load);
+		return false;
+	}
+	load->scratch          = sallocate(load->info.scratch_size, MEMORY_TAG_TEXTURE);
+	load->width            = load->info.width;
+	load->height           = load->info.height;
+	load->format           = TEXTURE_FORMAT_RGBA8;
+	load->level_count      = 1;
+	load->has_transparency = load->info.has_transparency;
+	return texture_load_submit(load, (u64)load->width * load->height * 4, texture_decode_job);
+}
+
+b8 texture_stream_open(const char *name, texture_stream *out_stream) {
+	szero_memory(out_stream, sizeof(texture_stream));
+
+	char path[TEXTURE_NAME_MAX_LENGTH + 16];
+	string_format_n(path, sizeof(path), "textures/%s%s", name, COOKED_TEXTURE_EXTENSION);
+	if (!asset_map(path, &out_stream->file)) { return false; }
+
+	if (!cooked_texture_parse(out_stream->file.data, out_stream->file.size, &out_stream->cooked)) {
+		SWARN("texture_stream_open - '%s' is corrupt or from another version, loading the PNG instead.", path);
+	} else if (!renderer_texture_format_supported(out_stream->cooked.header->format)) {
+		SDEBUG("texture_stream_open - '%s' is in a format the device can't sample, loading the PNG instead.", path);
+	} else {
+		return true;
+	}
+
+	texture_stream_close(out_stream);
+	return false;
+}
+
+void texture_stream_close(texture_stream *stream) {
+	asset_unmap(&stream->file);
+	szero_memory(stream, sizeof(texture_stream));
+}
+
+u64 texture_stream_size(const texture_stream *stream, u32 first_level) {
+	u64 size = 0;
+	for (u32 i = first_level; i < stream->cooked.header->level_count; ++i) { size += stream->cooked.levels[i].size; }
+	return size;
+}
+
+u32 texture_stream_level_for_dimension(const texture_stream *stream, u32 max_dimension) {
+	const cooked_texture_header *header = stream->cooked.header;
+	u32 level                           = 0;
+	while (level + 1 < header->level_count
+		   && SMAX(mip_level_dimension(header->width, level), mip_level_dimension(header->height, level))
+				  > max_dimension) {
+		level++;
+	}
+	return level;
+}
+
+b8 texture_stream_load(const char *name,
+					   const texture_stream *stream,
+					   u32 first_level,
+					   b8 auto_release,
+					   texture *out_texture) {
+	const cooked_texture_header *header = stream->cooked.header;
+	texture_staging staging;
+	if (!renderer_create_texture_staging(texture_stream_size(stream, first_level), &staging)) {
+		SERROR("texture_stream_load - Unable to create staging memory for '%s'.", name);
+		return false;
+	}
+
+	copy_levels(stream, first_level, staging.pixels);
+	renderer_create_texture_from_staging(name,
+										 auto_release,
+										 mip_level_dimension(header->width, first_level),
+										 mip_level_dimension(header->height, first_level),
+										 4,
+										 header->format,
+										 header->level_count - first_level,
+										 &staging,
+										 header->has_transparency,
+										 out_texture);
+	renderer_destroy_texture_staging(&staging);
+	return true;
+}
+
+b8 texture_stream_load_async(const char *name,
+							 const texture_stream *stream,
+							 u32 first_level,
+							 b8 auto_release,
+							 texture *out_texture,
+							 PFN_on_texture_loaded callback,
+							 void *user_data) {
+	texture_load *load = texture_load_create(name, auto_release, out_texture, callback, user_data);
+	texture_load_use_stream(load, stream, first_level);
+	return texture_load_submit(load, texture_stream_size(stream, first_level), texture_copy_job);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/filesystem.h"
+#include "cooked_texture.h"
+#include "resource_types.h"
+
+// Called on the main thread once a texture has loaded. out_texture is only written on success.
+typedef void (*PFN_on_texture_loaded)(b8 success, texture *texture, void *user_data);
+
+/**
+ * Loads the texture asset textures/<name>.png without blocking. The header is read up front, a worker thread then
+ * decodes the pixels straight into the renderer's staging memory, and the texture is created from it on the main
+ * thread during job_system_update. out_texture must stay valid until then.
+ * A cooked textures/<name>.ctex is preferred when it opens with texture_stream_open, its levels are copied into
+ * staging as they are instead.
+ * NOTE: Main thread only.
+ * @param callback Optional.
+ * @returns False if the load couldn't be started, in which case the callback is never called.
+ */
+b8 texture_load_async(const char *name,
+					  b8 auto_release,
+					  texture *out_texture,
+					  PFN_on_texture_loaded callback,
+					  void *user_data);
+
+// A mapped cooked texture whose mip levels can be loaded a few at a time.
+typedef struct texture_stream {
+	file_view file;
+	cooked_texture cooked;
+} texture_stream;
+
+/**
+ * Maps textures/<name>.ctex until texture_stream_close.
+ * @returns False if there is none, it's corrupt or the device can't sample its format.
+ */
+b8 texture_stream_open(const char *name, texture_stream *out_stream);
+void texture_stream_close(texture_stream *stream);
+
+// GPU memory taken by the levels from first_level down to the smallest.
+u64 texture_stream_size(const texture_stream *stream, u32 first_level);
+// First level no larger than max_dimension on either side, or the smallest level.
+u32 texture_stream_level_for_dimension(const texture_stream *stream, u32 max_dimension);
+
+/**
+ * Creates a texture from the levels first_level onwards, as large as level first_level. Blocks while they're
+ * copied and uploaded, meant for the few small levels a texture needs to be drawn at all.
+ */
+b8 texture_stream_load(const char *name,
+					   const texture_stream *stream,
+					   u32 first_level,
+					   b8 auto_release,
+					   texture *out_texture);
+
+/**
+ * Like texture_stream_load, but the levels are copied on a worker and the texture is created during
+ * job_system_update as texture_load_async does. The stream must stay open until the callback.
+ * NOTE: Main thread only.
+ */
+b8 texture_stream_load_async(const char *name,
+							 const texture_stream *stream,
+							 u32 first_level,
+							 b8 auto_release,
+							 texture *out_texture,
+							 PFN_on_texture_loaded callback,
+							 void *user_data);
@@ -0,0 +1,281 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
+#include "geometry_system.h"
+
+#include "containers/hashtable.h"
+#include "core/event.h"
+#include "core/logger.h"
+#include "core/smemory.h"
+#include "core/sstring.h"
+#include "renderer/renderer_frontend.h"
+#include "resources/cooked_mesh.h"
+#include "resources/mesh_loader.h"
+#include "resources/pack.h"
+
+// Sources imported when a mesh hasn't been cooked, in the order they are looked for.
+static const char *source_extensions[] = {".glb", ".gltf", ".obj"};
+
+typedef struct geometry_reference {
+	u64 reference_count;
+	// Index into registered_geometries, also the geometry's id.
+	u32 handle;
+	b8 auto_release;
+} geometry_reference;
+
+typedef struct geometry_system_state {
+	geometry_system_config config;
+	geometry default_geometry;
+	// Free slots have an INVALID_ID id.
+	geometry *registered_geometries;
+	// geometry_references by name.
+	hashtable registered_geometry_table;
+} geometry_system_state;
+
+static geometry_system_state *state_ptr = 0;
+
+static b8 create_default_geometry() {
+	STRACE("Generating default geometry...");
+	const f32 f = 10.0f;
+	vertex_3d vertices[4];
+	szero_memory(vertices, sizeof(vertices));
+
+	vertices[0].position.x           = -0.5f * f;
+	vertices[0].position.y           = -0.5f * f;
+	vertices[0].texture_coordinate.x = 0.0f;
+	vertices[0].texture_coordinate.y = 0.0f;
+
+	vertices[1].position.x           = 0.5f * f;
+	vertices[1].position.y           = 0.5f * f;
+	vertices[1].texture_coordinate.x = 1.0f;
+	vertices[1].texture_coordinate.y = 1.0f;
+
+	vertices[2].position.x           = -0.5f * f;
+	vertices[2].position.y           = 0.5f * f;
+	vertices[2].texture_coordinate.x = 0.0f;
+	vertices[2].texture_coordinate.y = 1.0f;
+
+	vertices[3].position.x           = 0.5f * f;
+	vertices[3].position.y           = -0.5f * f;
+	vertices[3].texture_coordinate.x = 1.0f;
+	vertices[3].texture_coordinate.y = 0.0f;
+
+	u32 indices[6] = {0, 1, 2, 0, 3, 1};
+
+	if (!renderer_create_geometry(4, vertices, 6, indices, &state_ptr->default_geometry)) {
+		SERROR("create_default_geometry - Failed to upload the default geometry.");
+		return false;
+	}
+	state_ptr->default_geometry.id         = INVALID_ID;
+	state_ptr->default_geometry.generation = 0;
+	string_format_n(state_ptr->default_geometry.name, GEOMETRY_NAME_MAX_LENGTH, "%s", DEFAULT_GEOMETRY_NAME);
+	return true;
+}
+
+static b8 import_source(const char *path, const file_view *source, geometry *out_geometry) {
+	SWARN("Mesh '%s' hasn't been cooked, importing it. Run space_asset_cooker to load it faster.", path);
+	mesh_data mesh;
+	if (!mesh_import(path, source->data, source->size, &mesh)) { return false; }
+
+	mesh_optimize(&mesh);
+	b8 created =
+		renderer_create_geometry(mesh.vertex_count, mesh.vertices, mesh.index_count, mesh.indices, out_geometry);
+	mesh_data_destroy(&mesh);
+	return created;
+}
+
+// Uploads the cooked mesh called name, or else imports its source. @returns False if neither could be loaded.
+static b8 load_geometry(const char *name, geometry *out_geometry) {
+	char path[GEOMETRY_NAME_MAX_LENGTH + 16];
+	file_view file;
+	string_format_n(path, sizeof(path), "meshes/%s%s", name, COOKED_MESH_EXTENSION);
+	if (asset_map(path, &file)) {
+		cooked_mesh cooked;
+		if (cooked_mesh_parse(file.data, file.size, &cooked)) {
+			b8 created = renderer_create_geometry(cooked.header->vertex_count,
+												  cooked.vertices,
+												  cooked.header->index_count,
+												  cooked.indices,
+												  out_geometry);
+			asset_unmap(&file);
+			return created;
+		}
+		SWARN("load_geometry - '%s' is corrupt or from another version, importing the source instead.", path);
+		asset_unmap(&file);
+	}
+
+	for (u32 i = 0; i < sizeof(source_extensions) / sizeof(source_extensions[0]); ++i) {
+		string_format_n(path, sizeof(path), "meshes/%s%s", name, source_extensions[i]);
+		if (!asset_map(path, &file)) { continue; }
+
+		b8 imported = import_source(path, &file, out_geometry);
+		asset_unmap(&file);
+		return imported;
+	}
+
+	SERROR("load_geometry - No mesh called '%s' in meshes/.", name);
+	return false;
+}
+
+// Frees the slot.
+static void destroy_geometry(geometry *g) {
+	renderer_destroy_geometry(g);
+	szero_memory(g, sizeof(geometry));
+	g->id         = INVALID_ID;
+	g->generation = INVALID_ID;
+}
+
+static b8 is_mesh_file(const geometry *g, u64 name_hash) {
+	char path[GEOMETRY_NAME_MAX_LENGTH + 16];
+	string_format_n(path, sizeof(path), "meshes/%s%s", g->name, COOKED_MESH_EXTENSION);
+	if (string_hash(path) == name_hash) { return true; }
+	for (u32 i = 0; i < sizeof(source_extensions) / sizeof(source_extensions[0]); ++i) {
+		string_format_n(path, sizeof(path), "meshes/%s%s", g->name, source_extensions[i]);
+		if (string_hash(path) == name_hash) { return true; }
+	}
+	return false;
+}
+
+static b8 geometry_system_on_asset_changed(u16 code, void *sender, void *listener_instance, event_context context) {
+	(void)code;
+	(void)sender;
+	(void)listener_instance;
+
+	u64 name_hash = context.data.u64[0];
+	for (u32 i = 0; i < state_ptr->config.max_geometry_count; ++i) {
+		geometry *g = &state_ptr->registered_geometries[i];
+		if (g->id == INVALID_ID || !is_mesh_file(g, name_hash)) { continue; }
+
+		// Loaded beside the old geometry, which keeps drawing if the new file doesn't load.
+		SINFO("Reloading mesh '%s'.", g->name);
+		geometry loaded;
+		szero_memory(&loaded, sizeof(geometry));
+		if (!load_geometry(g->name, &loaded)) {
+			SERROR("Mesh '%s' failed to reload, the previous version stays in use.", g->name);
+			break;
+		}
+
+		u32 generation = g->generation;
+		loaded.id      = g->id;
+		scopy_memory(loaded.name, g->name, GEOMETRY_NAME_MAX_LENGTH);
+		renderer_destroy_geometry(g);
+		*g            = loaded;
+		g->generation = generation + 1;
+		break;
+	}
+	// Other systems may be watching the same asset.
+	return false;
+}
+
+b8 geometry_system_initialize(u64 *memory_requirement, void *state, geometry_system_config config) {
+	if (config.max_geometry_count == 0) {
+		SFATAL("geometry_system_initialize - config.max_geometry_count must be > 0.");
+		return false;
+	}
+
+	u64 struct_requirement = sizeof(geometry_system_state);
+	u64 array_requirement  = sizeof(geometry) * config.max_geometry_count;
+	u64 table_requirement  = hashtable_memory_requirement(sizeof(geometry_reference), config.max_geometry_count);
+	*memory_requirement    = struct_requirement + array_requirement + table_requirement;
+	if (state == 0) { return true; }
+
+	szero_memory(state, *memory_requirement);
+	state_ptr                        = state;
+	state_ptr->config                = config;
+	state_ptr->registered_geometries = (geometry *)((u8 *)state + struct_requirement);
+	hashtable_create(sizeof(geometry_reference),
+					 config.max_geometry_count,
+					 (u8 *)state_ptr->registered_geometries + array_requirement,
+					 &state_ptr->registered_geometry_table);
+
+	for (u32 i = 0; i < config.max_geometry_count; ++i) {
+		state_ptr->registered_geometries[i].id         = INVALID_ID;
+		state_ptr->registered_geometries[i].generation = INVALID_ID;
+	}
+
+	if (!create_default_geometry()) {
+		state_ptr = 0;
+		return false;
+	}
+	if (!event_register(EVENT_CODE_ASSET_CHANGED, state_ptr, geometry_system_on_asset_changed)) {
+		SWARN("geometry_system_initialize - Couldn't listen for asset changes, meshes won't be hot reloaded.");
+	}
+	return true;
+}
+
+void geometry_system_shutdown(void *state) {
+	(void)state;
+	if (!state_ptr) { return; }
+
+	event_unregister(EVENT_CODE_ASSET_CHANGED, state_ptr, geometry_system_on_asset_changed);
+	for (u32 i = 0; i < state_ptr->config.max_geometry_count; ++i) {
+		geometry *g = &state_ptr->registered_geometries[i];
+		if (g->id != INVALID_ID) { destroy_geometry(g); }
+	}
+	renderer_destroy_geometry(&state_ptr->default_geometry);
+	hashtable_destroy(&state_ptr->registered_geometry_table);
+	state_ptr = 0;
+}
+
+geometry *geometry_system_acquire(const char *name, b8 auto_release) {
+	if (!state_ptr) { return 0; }
+	if (string_equal(name, DEFAULT_GEOMETRY_NAME)) {
+		SWARN("geometry_system_acquire - Use geometry_system_get_default_geometry for the default geometry.");
+		return &state_ptr->default_geometry;
+	}
+	if (string_length(name) >= GEOMETRY_NAME_MAX_LENGTH) {
+		SERROR("geometry_system_acquire - Name '%s' is too long.", name);
+		return 0;
+	}
+
+	geometry_reference ref;
+	if (!hashtable_get(&state_ptr->registered_geometry_table, name, &ref)) {
+		ref.reference_count = 0;
+		ref.handle          = INVALID_ID;
+		ref.auto_release    = auto_release;
+		for (u32 i = 0; i < state_ptr->config.max_geometry_count; ++i) {
+			if (state_ptr->registered_geometries[i].id == INVALID_ID) {
+				ref.handle = i;
+				break;
+			}
+		}
+		if (ref.handle == INVALID_ID) {
+			SERROR("geometry_system_acquire - No room for '%s', raise max_geometry_count.", name);
+			return 0;
+		}
+
+		geometry *g = &state_ptr->registered_geometries[ref.handle];
+		szero_memory(g, sizeof(geometry));
+		if (!load_geometry(name, g)) {
+			g->id         = INVALID_ID;
+			g->generation = INVALID_ID;
+			return 0;
+		}
+		g->id         = ref.handle;
+		g->generation = 0;
+		string_format_n(g->name, GEOMETRY_NAME_MAX_LENGTH, "%s", name);
+	}
+
+	ref.reference_count++;
+	hashtable_set(&state_ptr->registered_geometry_table, name, &ref);
+	return &state_ptr->registered_geometries[ref.handle];
+}
+
+void geometry_system_release(const char *name) {
+	if (!state_ptr || string_equal(name, DEFAULT_GEOMETRY_NAME)) { return; }
+
+	geometry_reference ref;
+	if (!hashtable_get(&state_ptr->registered_geometry_table, name, &ref) || ref.reference_count == 0) {
+		SWARN("geometry_system_release - '%s' has no references to release.", name);
+		return;
+	}
+
+	ref.reference_count--;
+	if (ref.reference_count == 0 && ref.auto_release) {
+		hashtable_remove(&state_ptr->registered_geometry_table, name);
+		destroy_geometry(&state_ptr->registered_geometries[ref.handle]);
+		return;
+	}
+	hashtable_set(&state_ptr->registered_geometry_table, name, &ref);
+}
+
+geometry *geometry_system_get_default_geometry() { return state_ptr ? &state_ptr->default_geometry : 0; }
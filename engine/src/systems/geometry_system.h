@@ -0,0 +1,28 @@
+#pragma once
+
+#include "resources/resource_types.h"
+
+// Name of the generated quad drawn until real meshes are.
+#define DEFAULT_GEOMETRY_NAME "default"
+
+typedef struct geometry_system_config {
+	// Geometries that can be acquired at once, not counting the default geometry.
+	u32 max_geometry_count;
+} geometry_system_config;
+
+b8 geometry_system_initialize(u64 *memory_requirement, void *state, geometry_system_config config);
+void geometry_system_shutdown(void *state);
+
+/**
+ * Gets the mesh loaded from meshes/<name>.cmsh, shared by every caller acquiring the same name. Cooked meshes are
+ * uploaded as they are. Without one the source, meshes/<name>.glb, .gltf or .obj, is imported and optimized on
+ * the spot, which is far slower, so ship cooked meshes. Loading finishes before this returns. The generation
+ * changes each time the file is hot reloaded.
+ * @param auto_release Destroy the geometry when its last reference is released. Only the first acquire decides.
+ * @returns 0 if the name is too long, the mesh couldn't be loaded or every geometry is in use.
+ */
+SAPI geometry *geometry_system_acquire(const char *name, b8 auto_release);
+// Gives up a reference taken by geometry_system_acquire.
+SAPI void geometry_system_release(const char *name);
+
+SAPI geometry *geometry_system_get_default_geometry();
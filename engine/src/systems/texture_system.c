@@ -0,0 +1,459 @@
+#define LOG_CATEGORY LOG_CATEGORY_RENDERER
+
+#include "texture_system.h"
+
+#include "containers/hashtable.h"
+#include "core/event.h"
+#include "core/logger.h"
+#include "core/smemory.h"
+#include "core/sstring.h"
+#include "renderer/renderer_frontend.h"
+#include "resources/cooked_texture.h"
+#include "resources/texture_loader.h"
+
+// Cooked textures load their levels up to this size synchronously when acquired, so they can be drawn at once.
+#define STREAMING_BASE_DIMENSION 64
+// Frames a texture can go undrawn before its higher levels stop streaming in and may be evicted.
+#define STREAMING_IDLE_FRAMES 120
+// Loads of higher levels in flight at once, each holds staging memory for its levels until it lands.
+#define STREAMING_MAX_LOADS 4
+
+typedef struct texture_reference {
+	u64 reference_count;
+	// Index into registered_textures, also the texture's id.
+	u32 handle;
+	b8 auto_release;
+	// A load is in flight, the texture can't be destroyed until it has landed.
+	b8 loading;
+	// The file changed while loading, it's loaded again once the load in flight lands.
+	b8 reload_pending;
+} texture_reference;
+
+// Residency of a texture streamed from its cooked file, unused when stream isn't open.
+typedef struct texture_streaming {
+	texture_stream stream;
+	// Largest level on the GPU, 0 once the texture has fully streamed in.
+	u32 resident_level;
+	// Largest level loaded when acquired, what eviction drops back to.
+	u32 base_level;
+	// First level of the load in flight, INVALID_ID without one.
+	u32 loading_level;
+	u64 last_used_frame;
+} texture_streaming;
+
+typedef struct texture_system_state {
+	texture_system_config config;
+	texture default_texture;
+	// Free slots have an INVALID_ID id.
+	texture *registered_textures;
+	// texture_references by name.
+	hashtable registered_texture_table;
+	// Indexed like registered_textures.
+	texture_streaming *streams;
+	// Generation the next texture swapped into each slot gets. Kept when a slot is freed, descriptors cache
+	// (id, generation) and must not mistake a texture reusing the slot for the one before it.
+	u32 *slot_generations;
+	u64 frame_number;
+	// GPU memory the streamed textures' resident levels take, including those still loading.
+	u64 streamed_size;
+	u32 streaming_loads;
+} texture_system_state;
+
+static texture_system_state *state_ptr = 0;
+
+static void create_default_texture() {
+	STRACE("Generating default texture...");
+	const u32 texture_dimension = 256;
+	const u32 channels          = 4;
+	const u32 pixel_count       = texture_dimension * texture_dimension;
+	u8 pixels[pixel_count * channels];
+	sset_memory(pixels, 255, sizeof(u8) * pixel_count * channels);
+
+	for (u64 row = 0; row < texture_dimension; ++row) {
+		for (u64 col = 0; col < texture_dimension; ++col) {
+			u64 index          = (row * texture_dimension) + col;
+			u64 index_channels = index * channels;
+			if (row % 2) {
+				if (col % 2) {
+					pixels[index_channels + 0] = 0;
+					pixels[index_channels + 1] = 0;
+				}
+			} else {
+				if (!(col % 2)) {
+					pixels[index_channels + 0] = 0;
+					pixels[index_channels + 1] = 0;
+				}
+			}
+		}
+	}
+
+	renderer_create_texture(DEFAULT_TEXTURE_NAME,
+							false,
+							texture_dimension,
+							texture_dimension,
+							4,
+							pixels,
+							false,
+							&state_ptr->default_texture);
+	// Distinct from every registered texture's id, so descriptors notice the switch once a texture loads.
+	state_ptr->default_texture.id         = INVALID_ID;
+	state_ptr->default_texture.generation = 0;
+	string_format_n(state_ptr->default_texture.name, TEXTURE_NAME_MAX_LENGTH, "%s", DEFAULT_TEXTURE_NAME);
+}
+
+// Points t at the default texture's image until its own pixels land.
+static void alias_default_texture(texture *t) {
+	t->width            = state_ptr->default_texture.width;
+	t->height           = state_ptr->default_texture.height;
+	t->channel_count    = state_ptr->default_texture.channel_count;
+	t->has_transparency = state_ptr->default_texture.has_transparency;
+	t->generation       = INVALID_ID;
+	t->internal_data    = state_ptr->default_texture.internal_data;
+}
+
+static u64 stream_size(const texture_streaming *s, u32 first_level) {
+	return texture_stream_size(&s->stream, first_level);
+}
+
+static b8 is_streamed(const texture_streaming *s) { return s->stream.cooked.header != 0; }
+
+static b8 is_idle(const texture_streaming *s) {
+	return s->last_used_frame + STREAMING_IDLE_FRAMES < state_ptr->frame_number;
+}
+
+static void stop_streaming(texture_streaming *s) {
+	if (!is_streamed(s)) { return; }
+	state_ptr->streamed_size -= stream_size(s, s->resident_level);
+	texture_stream_close(&s->stream);
+}
+
+// Replaces what t draws with loaded. The old texture is only destroyed now, so it keeps drawing until then.
+static void swap_in_texture(texture *t, texture *loaded) {
+	texture old = *t;
+	if (old.generation != INVALID_ID) { renderer_destroy_texture(&old); }
+
+	u32 *generation    = &state_ptr->slot_generations[t->id];
+	loaded->id         = t->id;
+	loaded->generation = *generation;
+	// INVALID_ID marks a texture still aliasing the default texture.
+	*generation = *generation + 1 == INVALID_ID ? 0 : *generation + 1;
+	scopy_memory(loaded->name, t->name, TEXTURE_NAME_MAX_LENGTH);
+	*t = *loaded;
+}
+
+// Frees the slot. Textures still aliasing the default texture have nothing of their own to destroy.
+static void destroy_texture(texture *t) {
+	stop_streaming(&state_ptr->streams[t->id]);
+	if (t->generation != INVALID_ID) { renderer_destroy_texture(t); }
+	szero_memory(t, sizeof(texture));
+	t->id         = INVALID_ID;
+	t->generation = INVALID_ID;
+}
+
+static b8 load_texture(texture *t);
+static b8 start_streaming(texture *t, b8 auto_release);
+
+// Loads t again from its file. Only call without a load in flight.
+static void reload_texture(texture *t, texture_reference *ref) {
+	SINFO("Reloading texture '%s'.", t->name);
+	ref->reload_pending = false;
+	stop_streaming(&state_ptr->streams[t->id]);
+	if (!start_streaming(t, ref->auto_release)) { ref->loading = load_texture(t); }
+}
+
+static void texture_loaded(b8 success, texture *loaded, void *user_data) {
+	texture *t = user_data;
+	texture_reference ref;
+	hashtable_get(&state_ptr->registered_texture_table, t->name, &ref);
+	ref.loading = false;
+
+	// Streamed levels had their memory counted when they were requested.
+	texture_streaming *s = &state_ptr->streams[t->id];
+	if (is_streamed(s)) {
+		if (success) {
+			s->resident_level = s->loading_level;
+		} else {
+			state_ptr->streamed_size -= stream_size(s, s->loading_level) - stream_size(s, s->resident_level);
+		}
+		s->loading_level = INVALID_ID;
+		state_ptr->streaming_loads--;
+	}
+
+	if (success) { swap_in_texture(t, loaded); }
+	sfree(loaded, sizeof(texture), MEMORY_TAG_TEXTURE);
+
+	// Released while it was loading.
+	if (ref.reference_count == 0 && ref.auto_release) {
+		hashtable_remove(&state_ptr->registered_texture_table, t->name);
+		destroy_texture(t);
+		return;
+	}
+	if (ref.reload_pending) { reload_texture(t, &ref); }
+	hashtable_set(&state_ptr->registered_texture_table, t->name, &ref);
+}
+
+// @returns False if the load couldn't be started, t then keeps what it was drawing.
+static b8 load_texture(texture *t) {
+	texture_reference ref;
+	hashtable_get(&state_ptr->registered_texture_table, t->name, &ref);
+
+	// Loaded into a texture of its own, t is updated once it has landed.
+	texture *loading = sallocate(sizeof(texture), MEMORY_TAG_TEXTURE);
+	if (!texture_load_async(t->name, ref.auto_release, loading, texture_loaded, t)) {
+		sfree(loading, sizeof(texture), MEMORY_TAG_TEXTURE);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Opens t's cooked texture and loads its smallest levels right away, the rest stream in once it's drawn.
+ * @returns False if t has no cooked texture to stream, it has to be loaded whole.
+ */
+static b8 start_streaming(texture *t, b8 auto_release) {
+	texture_streaming *s = &state_ptr->streams[t->id];
+	if (!texture_stream_open(t->name, &s->stream)) { return false; }
+
+	u32 base_level = texture_stream_level_for_dimension(&s->stream, STREAMING_BASE_DIMENSION);
+	texture loaded;
+	szero_memory(&loaded, sizeof(texture));
+	if (!texture_stream_load(t->name, &s->stream, base_level, auto_release, &loaded)) {
+		texture_stream_close(&s->stream);
+		return false;
+	}
+
+	swap_in_texture(t, &loaded);
+	s->resident_level  = base_level;
+	s->base_level      = base_level;
+	s->loading_level   = INVALID_ID;
+	s->last_used_frame = state_ptr->frame_number;
+	state_ptr->streamed_size += stream_size(s, base_level);
+	return true;
+}
+
+// Drops the least recently drawn idle texture back to its base levels. @returns False if none has any to drop.
+static b8 evict_least_recently_used() {
+	u32 victim = INVALID_ID;
+	for (u32 i = 0; i < state_ptr->config.max_texture_count; ++i) {
+		const texture_streaming *s = &state_ptr->streams[i];
+		b8 evictable = is_streamed(s) && s->loading_level == INVALID_ID && s->resident_level < s->base_level
+					&& is_idle(s);
+		if (evictable && (victim == INVALID_ID || s->last_used_frame < state_ptr->streams[victim].last_used_frame)) {
+			victim = i;
+		}
+	}
+	if (victim == INVALID_ID) { return false; }
+
+	texture *t           = &state_ptr->registered_textures[victim];
+	texture_streaming *s = &state_ptr->streams[victim];
+	texture_reference ref;
+	hashtable_get(&state_ptr->registered_texture_table, t->name, &ref);
+
+	// The base levels are small, reloading them beats keeping a copy around.
+	texture loaded;
+	szero_memory(&loaded, sizeof(texture));
+	if (!texture_stream_load(t->name, &s->stream, s->base_level, ref.auto_release, &loaded)) { return false; }
+
+	STRACE("Evicting the higher levels of texture '%s'.", t->name);
+	state_ptr->streamed_size -= stream_size(s, s->resident_level) - stream_size(s, s->base_level);
+	swap_in_texture(t, &loaded);
+	s->resident_level = s->base_level;
+	return true;
+}
+
+/**
+ * Starts loading as many of a drawn texture's higher levels as the budget allows, after evicting idle textures
+ * to make room. The whole chain from the new first level is loaded again, the image is recreated at its new size.
+ */
+static void stream_in(texture *t, texture_streaming *s) {
+	u64 resident_size = stream_size(s, s->resident_level);
+	u64 full_size     = stream_size(s, 0);
+	u64 budget        = state_ptr->config.streaming_budget;
+	while (state_ptr->streamed_size - resident_size + full_size > budget && evict_least_recently_used()) {}
+
+	u64 others = state_ptr->streamed_size - resident_size;
+	u32 level  = 0;
+	while (level < s->resident_level && others + stream_size(s, level) > budget) { level++; }
+	if (level == s->resident_level) { return; }
+
+	texture_reference ref;
+	hashtable_get(&state_ptr->registered_texture_table, t->name, &ref);
+	texture *loading = sallocate(sizeof(texture), MEMORY_TAG_TEXTURE);
+	if (!texture_stream_load_async(t->name, &s->stream, level, ref.auto_release, loading, texture_loaded, t)) {
+		sfree(loading, sizeof(texture), MEMORY_TAG_TEXTURE);
+		return;
+	}
+
+	s->loading_level = level;
+	state_ptr->streamed_size += stream_size(s, level) - resident_size;
+	state_ptr->streaming_loads++;
+	ref.loading = true;
+	hashtable_set(&state_ptr->registered_texture_table, t->name, &ref);
+}
+
+static b8 texture_system_on_asset_changed(u16 code, void *sender, void *listener_instance, event_context context) {
+	(void)code;
+	(void)sender;
+	(void)listener_instance;
+
+	u64 name_hash = context.data.u64[0];
+	for (u32 i = 0; i < state_ptr->config.max_texture_count; ++i) {
+		texture *t = &state_ptr->registered_textures[i];
+		if (t->id == INVALID_ID) { continue; }
+
+		// Either the source or its cooked texture.
+		char path[TEXTURE_NAME_MAX_LENGTH + 16];
+		string_format_n(path, sizeof(path), "textures/%s.png", t->name);
+		u64 source_hash = string_hash(path);
+		string_format_n(path, sizeof(path), "textures/%s%s", t->name, COOKED_TEXTURE_EXTENSION);
+		if (source_hash != name_hash && string_hash(path) != name_hash) { continue; }
+
+		texture_reference ref;
+		hashtable_get(&state_ptr->registered_texture_table, t->name, &ref);
+		// A load already in flight may have read the old file, texture_loaded reloads it once that lands.
+		if (ref.loading) {
+			ref.reload_pending = true;
+		} else {
+			reload_texture(t, &ref);
+		}
+		hashtable_set(&state_ptr->registered_texture_table, t->name, &ref);
+		break;
+	}
+	// Other systems may be watching the same asset.
+	return false;
+}
+
+b8 texture_system_initialize(u64 *memory_requirement, void *state, texture_system_config config) {
+	if (config.max_texture_count == 0) {
+		SFATAL("texture_system_initialize - config.max_texture_count must be > 0.");
+		return false;
+	}
+
+	u64 struct_requirement      = sizeof(texture_system_state);
+	u64 array_requirement       = sizeof(texture) * config.max_texture_count;
+	u64 streams_requirement     = sizeof(texture_streaming) * config.max_texture_count;
+	u64 generations_requirement = sizeof(u32) * config.max_texture_count;
+	u64 table_requirement       = hashtable_memory_requirement(sizeof(texture_reference), config.max_texture_count);
+	*memory_requirement         = struct_requirement + array_requirement + streams_requirement + generations_requirement
+								+ table_requirement;
+	if (state == 0) { return true; }
+
+	szero_memory(state, *memory_requirement);
+	state_ptr                      = state;
+	state_ptr->config              = config;
+	state_ptr->registered_textures = (texture *)((u8 *)state + struct_requirement);
+	state_ptr->streams             = (texture_streaming *)((u8 *)state_ptr->registered_textures + array_requirement);
+	state_ptr->slot_generations    = (u32 *)((u8 *)state_ptr->streams + streams_requirement);
+	hashtable_create(sizeof(texture_reference),
+					 config.max_texture_count,
+					 (u8 *)state_ptr->slot_generations + generations_requirement,
+					 &state_ptr->registered_texture_table);
+
+	for (u32 i = 0; i < config.max_texture_count; ++i) {
+		state_ptr->registered_textures[i].id         = INVALID_ID;
+		state_ptr->registered_textures[i].generation = INVALID_ID;
+	}
+
+	create_default_texture();
+	if (!event_register(EVENT_CODE_ASSET_CHANGED, state_ptr, texture_system_on_asset_changed)) {
+		SWARN("texture_system_initialize - Couldn't listen for asset changes, textures won't be hot reloaded.");
+	}
+	return true;
+}
+
+void texture_system_shutdown(void *state) {
+	(void)state;
+	if (!state_ptr) { return; }
+
+	event_unregister(EVENT_CODE_ASSET_CHANGED, state_ptr, texture_system_on_asset_changed);
+	// The job system has drained by now, so no load is still in flight.
+	for (u32 i = 0; i < state_ptr->config.max_texture_count; ++i) {
+		texture *t = &state_ptr->registered_textures[i];
+		if (t->id != INVALID_ID) { destroy_texture(t); }
+	}
+	renderer_destroy_texture(&state_ptr->default_texture);
+	hashtable_destroy(&state_ptr->registered_texture_table);
+	state_ptr = 0;
+}
+
+texture *texture_system_acquire(const char *name, b8 auto_release) {
+	if (!state_ptr) { return 0; }
+	if (string_equal(name, DEFAULT_TEXTURE_NAME)) {
+		SWARN("texture_system_acquire - Use texture_system_get_default_texture for the default texture.");
+		return &state_ptr->default_texture;
+	}
+	if (string_length(name) >= TEXTURE_NAME_MAX_LENGTH) {
+		SERROR("texture_system_acquire - Name '%s' is too long.", name);
+		return 0;
+	}
+
+	texture_reference ref;
+	if (!hashtable_get(&state_ptr->registered_texture_table, name, &ref)) {
+		ref.reference_count = 0;
+		ref.handle          = INVALID_ID;
+		ref.auto_release    = auto_release;
+		ref.loading         = false;
+		ref.reload_pending  = false;
+		for (u32 i = 0; i < state_ptr->config.max_texture_count; ++i) {
+			if (state_ptr->registered_textures[i].id == INVALID_ID) {
+				ref.handle = i;
+				break;
+			}
+		}
+		if (ref.handle == INVALID_ID) {
+			SERROR("texture_system_acquire - No room for '%s', raise max_texture_count.", name);
+			return 0;
+		}
+
+		texture *t = &state_ptr->registered_textures[ref.handle];
+		alias_default_texture(t);
+		t->id = ref.handle;
+		string_format_n(t->name, TEXTURE_NAME_MAX_LENGTH, "%s", name);
+		hashtable_set(&state_ptr->registered_texture_table, name, &ref);
+
+		// Cooked textures can be drawn at low resolution right away. Others draw as the default texture until
+		// they've loaded, or for good if they fail to.
+		if (!start_streaming(t, auto_release)) { ref.loading = load_texture(t); }
+	}
+
+	ref.reference_count++;
+	hashtable_set(&state_ptr->registered_texture_table, name, &ref);
+	return &state_ptr->registered_textures[ref.handle];
+}
+
+void texture_system_release(const char *name) {
+	if (!state_ptr || string_equal(name, DEFAULT_TEXTURE_NAME)) { return; }
+
+	texture_reference ref;
+	if (!hashtable_get(&state_ptr->registered_texture_table, name, &ref) || ref.reference_count == 0) {
+		SWARN("texture_system_release - '%s' has no references to release.", name);
+		return;
+	}
+
+	ref.reference_count--;
+	// Loading textures are destroyed once they land instead.
+	if (ref.reference_count == 0 && ref.auto_release && !ref.loading) {
+		hashtable_remove(&state_ptr->registered_texture_table, name);
+		destroy_texture(&state_ptr->registered_textures[ref.handle]);
+		return;
+	}
+	hashtable_set(&state_ptr->registered_texture_table, name, &ref);
+}
+
+texture *texture_system_get_default_texture() { return state_ptr ? &state_ptr->default_texture : 0; }
+
+void texture_system_mark_used(const texture *t) {
+	if (!state_ptr || !t || t->id >= state_ptr->config.max_texture_count) { return; }
+	state_ptr->streams[t->id].last_used_frame = state_ptr->frame_number;
+}
+
+void texture_system_update() {
+	if (!state_ptr) { return; }
+	state_ptr->frame_number++;
+
+	for (u32 i = 0; i < state_ptr->config.max_texture_count && state_ptr->streaming_loads < STREAMING_MAX_LOADS; ++i) {
+		texture_streaming *s = &state_ptr->streams[i];
+		if (!is_streamed(s) || s->loading_level != INVALID_ID || s->resident_level == 0 || is_idle(s)) { continue; }
+		stream_in(&state_ptr->registered_textures[i], s);
+	}
+}
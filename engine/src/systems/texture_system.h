@@ -0,0 +1,37 @@
+#pragma once
+
+#include "resources/resource_types.h"
+
+// Name of the generated checkerboard that stands in for missing and still loading textures.
+#define DEFAULT_TEXTURE_NAME "default"
+
+typedef struct texture_system_config {
+	// Textures that can be acquired at once, not counting the default texture.
+	u32 max_texture_count;
+	// GPU memory streamed textures may take. Drawn textures stream in as far as it allows, evicting the higher
+	// levels of textures that haven't been drawn for a while when it runs out.
+	u64 streaming_budget;
+} texture_system_config;
+
+b8 texture_system_initialize(u64 *memory_requirement, void *state, texture_system_config config);
+void texture_system_shutdown(void *state);
+
+/**
+ * Gets the texture loaded from textures/<name>.png, shared by every caller acquiring the same name. The first acquire
+ * starts loading it in the background, until that finishes it draws as the default texture with an INVALID_ID
+ * generation. The generation changes each time new pixels land, including when the file is hot reloaded.
+ * Cooked textures are streamed instead: their smallest levels load before this returns and the rest follow in
+ * the background while the texture is drawn, see texture_system_mark_used.
+ * @param auto_release Destroy the texture when its last reference is released. Only the first acquire decides.
+ * @returns 0 if the name is too long or every texture is in use.
+ */
+SAPI texture *texture_system_acquire(const char *name, b8 auto_release);
+// Gives up a reference taken by texture_system_acquire.
+SAPI void texture_system_release(const char *name);
+
+SAPI texture *texture_system_get_default_texture();
+
+// Keeps a streamed texture's higher levels loading and resident. Call for every texture drawn in a frame.
+SAPI void texture_system_mark_used(const texture *t);
+// Streams in the higher levels of textures drawn recently. Call once per frame, after drawing.
+void texture_system_update();
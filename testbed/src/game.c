@@ -1,3 +1,5 @@
+#define LOG_CATEGORY LOG_CATEGORY_GAME
+
 #include "game.h"
 
 #include <core/input.h>
@@ -7,6 +9,7 @@
 #include <math/smath.h>
 
 #include <renderer/renderer_frontend.h>
+#include <systems/texture_system.h>
 
 void recalculate_viem_matrix(game_state *state) {
 	if (!state->camera_view_dirty) return;
@@ -43,6 +46,8 @@ b8 game_initialize(game *game_instance) {
 	state->camera_view_dirty = true;
 
 	renderer_set_view(state->view);
+	// Draws as the default texture until it has loaded.
+	renderer_set_diffuse(texture_system_acquire("cobblestone", false));
 
 	SDEBUG("Initializing game.");
 	return true;
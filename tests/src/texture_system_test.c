@@ -0,0 +1,185 @@
+// Checks that a texture acquired into a slot freed by another gets a different generation, descriptors cache
+// (id, generation) and would otherwise keep drawing the texture that was there before.
+
+#include <core/smemory.h>
+#include <defines.h>
+#include <renderer/renderer_frontend.h>
+#include <resources/texture_loader.h>
+#include <systems/texture_system.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(condition)                                                                                           \
+	do {                                                                                                           \
+		if (!(condition)) {                                                                                        \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);                                  \
+			return false;                                                                                          \
+		}                                                                                                          \
+	} while (0)
+
+// Stands in for the renderer's image, textures only need a non-null internal_data.
+static u8 fake_image;
+static cooked_texture_header fake_header;
+
+// Whether texture_stream_open finds a cooked texture.
+static b8 cooked_available;
+
+// The png load texture_load_async started, completed by complete_load.
+static texture *pending_texture;
+static PFN_on_texture_loaded pending_callback;
+static void *pending_user_data;
+
+static void fill_texture(texture *t) {
+	t->width         = 4;
+	t->height        = 4;
+	t->channel_count = 4;
+	t->internal_data = &fake_image;
+}
+
+void renderer_create_texture(const char *name,
+							 b8 auto_release,
+							 u32 width,
+							 u32 height,
+							 i32 channel_count,
+							 const u8 *pixels,
+							 b8 has_transparency,
+							 texture *out_texture) {
+	(void)name;
+	(void)auto_release;
+	(void)pixels;
+	out_texture->width            = width;
+	out_texture->height           = height;
+	out_texture->channel_count    = (u8)channel_count;
+	out_texture->has_transparency = has_transparency;
+	out_texture->internal_data    = &fake_image;
+}
+
+void renderer_destroy_texture(texture *texture) { texture->internal_data = 0; }
+
+b8 texture_load_async(const char *name,
+					  b8 auto_release,
+					  texture *out_texture,
+					  PFN_on_texture_loaded callback,
+					  void *user_data) {
+	(void)name;
+	(void)auto_release;
+	pending_texture   = out_texture;
+	pending_callback  = callback;
+	pending_user_data = user_data;
+	return true;
+}
+
+b8 texture_stream_open(const char *name, texture_stream *out_stream) {
+	(void)name;
+	if (!cooked_available) { return false; }
+	szero_memory(out_stream, sizeof(texture_stream));
+	out_stream->cooked.header = &fake_header;
+	return true;
+}
+
+void texture_stream_close(texture_stream *stream) { szero_memory(stream, sizeof(texture_stream)); }
+
+u64 texture_stream_size(const texture_stream *stream, u32 first_level) {
+	(void)stream;
+	(void)first_level;
+	return 64;
+}
+
+u32 texture_stream_level_for_dimension(const texture_stream *stream, u32 max_dimension) {
+	(void)stream;
+	(void)max_dimension;
+	return 0;
+}
+
+b8 texture_stream_load(const char *name,
+					   const texture_stream *stream,
+					   u32 first_level,
+					   b8 auto_release,
+					   texture *out_texture) {
+	(void)name;
+	(void)stream;
+	(void)first_level;
+	(void)auto_release;
+	fill_texture(out_texture);
+	return true;
+}
+
+b8 texture_stream_load_async(const char *name,
+							 const texture_stream *stream,
+							 u32 first_level,
+							 b8 auto_release,
+							 texture *out_texture,
+							 PFN_on_texture_loaded callback,
+							 void *user_data) {
+	(void)name;
+	(void)stream;
+	(void)first_level;
+	(void)auto_release;
+	(void)out_texture;
+	(void)callback;
+	(void)user_data;
+	return false;
+}
+
+static void complete_load() {
+	fill_texture(pending_texture);
+	pending_callback(true, pending_texture, pending_user_data);
+	pending_texture = 0;
+}
+
+static b8 acquire_loaded(const char *name, u32 *out_id, u32 *out_generation) {
+	texture *t = texture_system_acquire(name, true);
+	CHECK(t != 0);
+	if (!cooked_available) {
+		CHECK(t->generation == INVALID_ID);
+		CHECK(pending_texture != 0);
+		complete_load();
+	}
+	CHECK(t->generation != INVALID_ID);
+	*out_id         = t->id;
+	*out_generation = t->generation;
+	return true;
+}
+
+static b8 reused_slot_changes_generation() {
+	u32 first_id, first_generation;
+	CHECK(acquire_loaded("first", &first_id, &first_generation));
+	texture_system_release("first");
+
+	u32 second_id, second_generation;
+	CHECK(acquire_loaded("second", &second_id, &second_generation));
+	texture_system_release("second");
+
+	CHECK(second_id == first_id);
+	CHECK(second_generation != first_generation);
+	return true;
+}
+
+int main() {
+	texture_system_config config = {.max_texture_count = 4, .streaming_budget = MEBIBYTES(1)};
+	u64 memory_requirement       = 0;
+	texture_system_initialize(&memory_requirement, 0, config);
+	void *state = malloc(memory_requirement);
+	if (!texture_system_initialize(&memory_requirement, state, config)) {
+		printf("texture_system_initialize failed\n");
+		return 1;
+	}
+
+	int failures = 0;
+	cooked_available = false;
+	if (!reused_slot_changes_generation()) {
+		printf("FAILED: loaded textures reusing a slot\n");
+		failures++;
+	}
+	cooked_available = true;
+	if (!reused_slot_changes_generation()) {
+		printf("FAILED: streamed textures reusing a slot\n");
+		failures++;
+	}
+
+	texture_system_shutdown(state);
+	free(state);
+	if (failures == 0) { printf("texture_system_test passed\n"); }
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,365 @@
+// Cooks the source assets under a directory into GPU-ready binaries under another, keeping their relative paths.
+// Usage: space_asset_cooker [-m manifest] <source directory> <output directory>
+// textures/x.png becomes textures/x.ctex, see resources/cooked_texture.h: a full mip chain filtered with the
+// Kaiser filter, block compressed to BC1 when opaque and to BC7 with transparency. meshes/x.obj, .gltf and .glb
+// become meshes/x.cmsh, see resources/cooked_mesh.h: welded and reordered for the vertex cache and overdraw.
+// The manifest records a hash of every source's content and the format and encoder versions it was cooked with.
+// Sources that match it and whose output still exists are skipped, so only changed assets are cooked again.
+
+#include <containers/darray.h>
+#include <core/filesystem.h>
+#include <core/smemory.h>
+#include <core/sstring.h>
+#include <defines.h>
+#include <resources/cooked_mesh.h>
+#include <resources/cooked_texture.h>
+#include <resources/png.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if SPACE_PLATFORM_LINUX
+	#include <dirent.h>
+	#include <sys/stat.h>
+#elif SPACE_PLATFORM_WINDOWS
+	#include <windows.h>
+#endif
+
+#define MAX_PATH_LENGTH 1024
+#define DEFAULT_MANIFEST_NAME "cook.manifest"
+
+// Writes output from the source file's content. @returns False with an error printed if it couldn't.
+typedef b8 (*PFN_cook)(const char *name, const file_view *source, const char *output);
+
+typedef struct asset_cooker {
+	const char *source_extension;
+	const char *cooked_extension;
+	// Part of every content hash, so cooked files from an older format or encoder are cooked again.
+	u32 version;
+	u32 encoder_version;
+	PFN_cook cook;
+} asset_cooker;
+
+typedef struct cook_entry {
+	// Relative to the source directory, '/' separated.
+	char *name;
+	char *path;
+	char *output;
+	const asset_cooker *cooker;
+	u64 content_hash;
+} cook_entry;
+
+typedef struct manifest_entry {
+	u64 name_hash;
+	u64 content_hash;
+} manifest_entry;
+
+typedef struct cooker_state {
+	const char *source_root;
+	const char *output_root;
+	const char *manifest_path;
+	cook_entry *entries;
+	manifest_entry *manifest;
+} cooker_state;
+
+static b8 write_file(const char *path, const void *data, u64 size) {
+	file_handle handle;
+	if (!filesystem_open(path, FILE_MODE_WRITE, true, &handle)) { return false; }
+	u64 written = 0;
+	b8 success  = filesystem_write(&handle, size, data, &written);
+	filesystem_close(&handle);
+	return success;
+}
+
+static b8 cook_texture(const char *name, const file_view *source, const char *output) {
+	png_info info;
+	if (!png_read_info(source->data, source->size, &info)) {
+		fprintf(stderr, "%s is not a supported PNG\n", name);
+		return false;
+	}
+
+	u64 pixels_size = (u64)info.width * info.height * 4;
+	u8 *pixels      = sallocate(pixels_size, MEMORY_TAG_TEXTURE);
+	void *scratch   = sallocate(info.scratch_size, MEMORY_TAG_TEXTURE);
+	b8 decoded      = png_decode(source->data, source->size, &info, pixels, scratch);
+	sfree(scratch, info.scratch_size, MEMORY_TAG_TEXTURE);
+	if (!decoded) {
+		fprintf(stderr, "Failed decoding %s\n", name);
+		sfree(pixels, pixels_size, MEMORY_TAG_TEXTURE);
+		return false;
+	}
+
+	// BC7 keeps full alpha with colour at least as good as BC1's for twice the size, BC1 alone only has 1-bit alpha.
+	texture_format format = info.has_transparency ? TEXTURE_FORMAT_BC7 : TEXTURE_FORMAT_BC1;
+	u8 *data;
+	u64 size;
+	b8 success = cooked_texture_cook(
+		pixels, info.width, info.height, info.has_transparency, format, MIP_FILTER_KAISER, 0, &data, &size);
+	sfree(pixels, pixels_size, MEMORY_TAG_TEXTURE);
+	if (!success) {
+		fprintf(stderr, "Failed cooking %s\n", name);
+		return false;
+	}
+
+	success = write_file(output, data, size);
+	if (!success) { fprintf(stderr, "Failed writing %s\n", output); }
+	sfree(data, size, MEMORY_TAG_RESOURCE);
+	return success;
+}
+
+static b8 cook_mesh(const char *name, const file_view *source, const char *output) {
+	u8 *data;
+	u64 size;
+	if (!cooked_mesh_cook(name, source->data, source->size, &data, &size)) {
+		fprintf(stderr, "Failed cooking %s\n", name);
+		return false;
+	}
+
+	b8 success = write_file(output, data, size);
+	if (!success) { fprintf(stderr, "Failed writing %s\n", output); }
+	sfree(data, size, MEMORY_TAG_RESOURCE);
+	return success;
+}
+
+static const asset_cooker cookers[] = {
+	{".png", COOKED_TEXTURE_EXTENSION, COOKED_TEXTURE_VERSION, COOKED_TEXTURE_ENCODER_VERSION, cook_texture},
+	{".obj", COOKED_MESH_EXTENSION, COOKED_MESH_VERSION, COOKED_MESH_ENCODER_VERSION, cook_mesh},
+	{".gltf", COOKED_MESH_EXTENSION, COOKED_MESH_VERSION, COOKED_MESH_ENCODER_VERSION, cook_mesh},
+	{".glb", COOKED_MESH_EXTENSION, COOKED_MESH_VERSION, COOKED_MESH_ENCODER_VERSION, cook_mesh},
+};
+
+static const asset_cooker *find_cooker(const char *name) {
+	u64 length = strlen(name);
+	for (u32 i = 0; i < sizeof(cookers) / sizeof(cookers[0]); ++i) {
+		u64 extension_length = strlen(cookers[i].source_extension);
+		if (extension_length <= length && strcmp(name + length - extension_length, cookers[i].source_extension) == 0) {
+			return &cookers[i];
+		}
+	}
+	return 0;
+}
+
+static void add_entry(cooker_state *state, const char *path, const char *name) {
+	const asset_cooker *cooker = find_cooker(name);
+	if (!cooker) { return; }
+
+	// The source's extension swapped for the cooked one.
+	char output[MAX_PATH_LENGTH];
+	i32 stem_length = (i32)(strlen(name) - strlen(cooker->source_extension));
+	snprintf(output, sizeof(output), "%s/%.*s%s", state->output_root, stem_length, name, cooker->cooked_extension);
+
+	cook_entry entry;
+	szero_memory(&entry, sizeof(entry));
+	entry.name   = string_duplicate(name);
+	entry.path   = string_duplicate(path);
+	entry.output = string_duplicate(output);
+	entry.cooker = cooker;
+	darray_push(state->entries, entry);
+}
+
+// prefix is the relative name of directory, empty for the root.
+static b8 collect_sources(cooker_state *state, const char *directory, const char *prefix) {
+	char path[MAX_PATH_LENGTH];
+	char name[MAX_PATH_LENGTH];
+
+#if SPACE_PLATFORM_LINUX
+	DIR *dir = opendir(directory);
+	if (!dir) {
+		fprintf(stderr, "Unable to open directory %s\n", directory);
+		return false;
+	}
+
+	struct dirent *item;
+	while ((item = readdir(dir))) {
+		if (strcmp(item->d_name, ".") == 0 || strcmp(item->d_name, "..") == 0) { continue; }
+		snprintf(path, sizeof(path), "%s/%s", directory, item->d_name);
+		snprintf(name, sizeof(name), "%s%s", prefix, item->d_name);
+
+		struct stat info;
+		if (stat(path, &info) != 0) { continue; }
+		if (S_ISDIR(info.st_mode)) {
+			strncat(name, "/", sizeof(name) - strlen(name) - 1);
+			if (!collect_sources(state, path, name)) {
+				closedir(dir);
+				return false;
+			}
+		} else if (S_ISREG(info.st_mode)) {
+			add_entry(state, path, name);
+		}
+	}
+	closedir(dir);
+#elif SPACE_PLATFORM_WINDOWS
+	snprintf(path, sizeof(path), "%s/*", directory);
+	WIN32_FIND_DATAA item;
+	HANDLE find = FindFirstFileA(path, &item);
+	if (find == INVALID_HANDLE_VALUE) {
+		fprintf(stderr, "Unable to open directory %s\n", directory);
+		return false;
+	}
+
+	do {
+		if (strcmp(item.cFileName, ".") == 0 || strcmp(item.cFileName, "..") == 0) { continue; }
+		snprintf(path, sizeof(path), "%s/%s", directory, item.cFileName);
+		snprintf(name, sizeof(name), "%s%s", prefix, item.cFileName);
+
+		if (item.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			strncat(name, "/", sizeof(name) - strlen(name) - 1);
+			if (!collect_sources(state, path, name)) {
+				FindClose(find);
+				return false;
+			}
+		} else {
+			add_entry(state, path, name);
+		}
+	} while (FindNextFileA(find, &item));
+	FindClose(find);
+#endif
+
+	return true;
+}
+
+// Creates every directory leading up to the file at path.
+static void create_parent_directories(const char *path) {
+	char directory[MAX_PATH_LENGTH];
+	snprintf(directory, sizeof(directory), "%s", path);
+	for (char *c = directory + 1; *c; ++c) {
+		if (*c != '/') { continue; }
+		*c = '\0';
+#if SPACE_PLATFORM_LINUX
+		mkdir(directory, 0755);
+#elif SPACE_PLATFORM_WINDOWS
+		CreateDirectoryA(directory, 0);
+#endif
+		*c = '/';
+	}
+}
+
+// Lines are "<content hash in hex> <name>".
+static b8 read_manifest_line(string_view line, u64 line_number, void *user_data) {
+	(void)line_number;
+	cooker_state *state = user_data;
+
+	u64 separator = 0;
+	while (separator < line.length && line.data[separator] != ' ') { separator++; }
+	if (separator == 0 || separator + 1 >= line.length) { return true; }
+
+	char hash[17];
+	snprintf(hash, sizeof(hash), "%.*s", (i32)separator, line.data);
+	manifest_entry entry;
+	entry.content_hash = strtoull(hash, 0, 16);
+	entry.name_hash    = string_hash_n(line.data + separator + 1, line.length - separator - 1);
+	darray_push(state->manifest, entry);
+	return true;
+}
+
+static b8 is_up_to_date(const cooker_state *state, const cook_entry *entry) {
+	u64 name_hash = string_hash(entry->name);
+	for (u64 i = 0; i < darray_length(state->manifest); ++i) {
+		if (state->manifest[i].name_hash == name_hash) {
+			return state->manifest[i].content_hash == entry->content_hash && filesystem_exists(entry->output);
+		}
+	}
+	return false;
+}
+
+// Entries that failed to cook are left out, so they're tried again next time.
+static b8 write_manifest(const cooker_state *state, const b8 *cooked) {
+	file_handle handle;
+	if (!filesystem_open(state->manifest_path, FILE_MODE_WRITE, false, &handle)) { return false; }
+
+	b8 success = true;
+	for (u64 i = 0; i < darray_length(state->entries) && success; ++i) {
+		if (!cooked[i]) { continue; }
+		char line[MAX_PATH_LENGTH + 32];
+		snprintf(line, sizeof(line), "%016llx %s", state->entries[i].content_hash, state->entries[i].name);
+		success = filesystem_write_line(&handle, line);
+	}
+	filesystem_close(&handle);
+	return success;
+}
+
+static b8 cook_all(cooker_state *state) {
+	u64 count     = darray_length(state->entries);
+	b8 *cooked    = sallocate(count ? count : 1, MEMORY_TAG_ARRAY);
+	u32 built     = 0;
+	u32 skipped   = 0;
+	b8 all_cooked = true;
+
+	for (u64 i = 0; i < count; ++i) {
+		cook_entry *entry = &state->entries[i];
+		file_view source;
+		if (!filesystem_map(entry->path, &source)) {
+			fprintf(stderr, "Unable to read %s\n", entry->path);
+			all_cooked = false;
+			continue;
+		}
+
+		u64 source_hash     = string_hash_n(source.data, source.size);
+		u64 key[3]          = {source_hash, entry->cooker->version, entry->cooker->encoder_version};
+		entry->content_hash = string_hash_n(key, sizeof(key));
+		if (is_up_to_date(state, entry)) {
+			cooked[i] = true;
+			skipped++;
+		} else {
+			create_parent_directories(entry->output);
+			cooked[i] = entry->cooker->cook(entry->name, &source, entry->output);
+			built += cooked[i];
+			all_cooked = all_cooked && cooked[i];
+		}
+		filesystem_unmap(&source);
+	}
+
+	if (!write_manifest(state, cooked)) {
+		fprintf(stderr, "Failed writing %s\n", state->manifest_path);
+		all_cooked = false;
+	}
+	printf("Cooked %u assets into %s, %u up to date\n", built, state->output_root, skipped);
+	sfree(cooked, count ? count : 1, MEMORY_TAG_ARRAY);
+	return all_cooked;
+}
+
+int main(int argc, char **argv) {
+	cooker_state state;
+	szero_memory(&state, sizeof(state));
+
+	i32 positional = 0;
+	for (i32 i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+			state.manifest_path = argv[++i];
+		} else if (positional == 0) {
+			state.source_root = argv[i];
+			positional++;
+		} else if (positional == 1) {
+			state.output_root = argv[i];
+			positional++;
+		}
+	}
+	if (!state.source_root || !state.output_root) {
+		fprintf(stderr, "Usage: space_asset_cooker [-m manifest] <source directory> <output directory>\n");
+		return 1;
+	}
+
+	char manifest_path[MAX_PATH_LENGTH];
+	if (!state.manifest_path) {
+		snprintf(manifest_path, sizeof(manifest_path), "%s/%s", state.output_root, DEFAULT_MANIFEST_NAME);
+		state.manifest_path = manifest_path;
+	}
+
+	state.entries  = darray_create(cook_entry);
+	state.manifest = darray_create(manifest_entry);
+	// A missing manifest cooks everything.
+	filesystem_for_each_line(state.manifest_path, read_manifest_line, &state);
+
+	b8 success = collect_sources(&state, state.source_root, "") && cook_all(&state);
+
+	for (u64 i = 0; i < darray_length(state.entries); ++i) {
+		sfree(state.entries[i].name, strlen(state.entries[i].name) + 1, MEMORY_TAG_STRING);
+		sfree(state.entries[i].path, strlen(state.entries[i].path) + 1, MEMORY_TAG_STRING);
+		sfree(state.entries[i].output, strlen(state.entries[i].output) + 1, MEMORY_TAG_STRING);
+	}
+	darray_destroy(state.entries);
+	darray_destroy(state.manifest);
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+// Packs every file under an assets directory into one pack file, see resources/pack.h for the layout.
+// Usage: asset_packer [-x suffix]... <output.pack> <assets directory>
+// Files whose names end in one of the -x suffixes are left out, e.g. -x .vert -x CMakeLists.txt
+
+#include <containers/darray.h>
+#include <core/filesystem.h>
+#include <core/lz.h>
+#include <core/smemory.h>
+#include <core/sstring.h>
+#include <defines.h>
+#include <resources/pack.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if SPACE_PLATFORM_LINUX
+	#include <dirent.h>
+	#include <sys/stat.h>
+#elif SPACE_PLATFORM_WINDOWS
+	#include <windows.h>
+#endif
+
+#define MAX_PATH_LENGTH 1024
+#define MAX_EXCLUDES 32
+
+typedef struct packed_file {
+	// Relative to the assets directory, '/' separated.
+	char *name;
+	char *path;
+	u64 name_hash;
+	// Set when compression saved enough to be worth decoding at load time.
+	u8 *compressed;
+	u64 compressed_capacity;
+	pack_entry entry;
+} packed_file;
+
+typedef struct packer {
+	const char *root;
+	const char *output;
+	const char *excludes[MAX_EXCLUDES];
+	u32 exclude_count;
+	packed_file *files;
+} packer;
+
+static b8 is_excluded(const packer *packer, const char *name) {
+	u64 length = strlen(name);
+	for (u32 i = 0; i < packer->exclude_count; ++i) {
+		u64 suffix_length = strlen(packer->excludes[i]);
+		if (suffix_length <= length && strcmp(name + length - suffix_length, packer->excludes[i]) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void add_file(packer *packer, const char *path, const char *name) {
+	if (is_excluded(packer, name)) { return; }
+
+	packed_file file;
+	szero_memory(&file, sizeof(file));
+	file.name      = string_duplicate(name);
+	file.path      = string_duplicate(path);
+	file.name_hash = string_hash(name);
+	darray_push(packer->files, file);
+}
+
+// prefix is the relative name of directory, empty for the root.
+static b8 collect_files(packer *packer, const char *directory, const char *prefix) {
+	char path[MAX_PATH_LENGTH];
+	char name[MAX_PATH_LENGTH];
+
+#if SPACE_PLATFORM_LINUX
+	DIR *dir = opendir(directory);
+	if (!dir) {
+		fprintf(stderr, "Unable to open directory %s\n", directory);
+		return false;
+	}
+
+	struct dirent *item;
+	while ((item = readdir(dir))) {
+		if (strcmp(item->d_name, ".") == 0 || strcmp(item->d_name, "..") == 0) { continue; }
+		snprintf(path, sizeof(path), "%s/%s", directory, item->d_name);
+		snprintf(name, sizeof(name), "%s%s", prefix, item->d_name);
+
+		struct stat info;
+		if (stat(path, &info) != 0) { continue; }
+		if (S_ISDIR(info.st_mode)) {
+			strncat(name, "/", sizeof(name) - strlen(name) - 1);
+			if (!collect_files(packer, path, name)) {
+				closedir(dir);
+				return false;
+			}
+		} else if (S_ISREG(info.st_mode)) {
+			add_file(packer, path, name);
+		}
+	}
+	closedir(dir);
+#elif SPACE_PLATFORM_WINDOWS
+	snprintf(path, sizeof(path), "%s/*", directory);
+	WIN32_FIND_DATAA item;
+	HANDLE find = FindFirstFileA(path, &item);
+	if (find == INVALID_HANDLE_VALUE) {
+		fprintf(stderr, "Unable to open directory %s\n", directory);
+		return false;
+	}
+
+	do {
+		if (strcmp(item.cFileName, ".") == 0 || strcmp(item.cFileName, "..") == 0) { continue; }
+		snprintf(path, sizeof(path), "%s/%s", directory, item.cFileName);
+		snprintf(name, sizeof(name), "%s%s", prefix, item.cFileName);
+
+		if (item.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			strncat(name, "/", sizeof(name) - strlen(name) - 1);
+			if (!collect_files(packer, path, name)) {
+				FindClose(find);
+				return false;
+			}
+		} else {
+			add_file(packer, path, name);
+		}
+	} while (FindNextFileA(find, &item));
+	FindClose(find);
+#endif
+
+	return true;
+}
+
+// Compressed data is kept if it is at least an eighth smaller, already compressed formats like PNG aren't.
+static void compress_file(packed_file *file, const file_view *view) {
+	if (view->size == 0) { return; }
+
+	u64 capacity = lz_compress_bound(view->size);
+	u8 *buffer   = sallocate(capacity, MEMORY_TAG_RESOURCE);
+	u64 size     = lz_compress(view->data, view->size, buffer, capacity);
+	if (size == 0 || size > view->size - view->size / 8) {
+		sfree(buffer, capacity, MEMORY_TAG_RESOURCE);
+		return;
+	}
+
+	file->compressed          = buffer;
+	file->compressed_capacity = capacity;
+	file->entry.size          = size;
+	file->entry.compression   = PACK_COMPRESSION_LZ;
+}
+
+// Sorted by hash for the runtime's binary search, names break ties so the output is reproducible.
+static int compare_files(const void *a, const void *b) {
+	const packed_file *file_a = a;
+	const packed_file *file_b = b;
+	if (file_a->name_hash != file_b->name_hash) { return file_a->name_hash < file_b->name_hash ? -1 : 1; }
+	return strcmp(file_a->name, file_b->name);
+}
+
+static b8 write_bytes(file_handle *handle, const void *data, u64 size) {
+	u64 written = 0;
+	return size == 0 || filesystem_write(handle, size, data, &written);
+}
+
+static b8 write_padding(file_handle *handle, u64 *offset, u64 alignment) {
+	static const u8 zeros[PACK_ALIGNMENT] = {0};
+	u64 padding                           = (alignment - (*offset % alignment)) % alignment;
+	*offset += padding;
+	return write_bytes(handle, zeros, padding);
+}
+
+static b8 write_pack(packer *packer) {
+	u32 count = (u32)darray_length(packer->files);
+	qsort(packer->files, count, sizeof(packed_file), compare_files);
+
+	pack_header header;
+	szero_memory(&header, sizeof(header));
+	header.magic        = PACK_MAGIC;
+	header.version      = PACK_VERSION;
+	header.entry_count  = count;
+	header.names_offset = sizeof(pack_header) + count * sizeof(pack_entry);
+
+	// Lay out the names, then the payloads after them.
+	for (u32 i = 0; i < count; ++i) {
+		pack_entry *entry  = &packer->files[i].entry;
+		entry->name_hash   = packer->files[i].name_hash;
+		entry->name_offset = (u32)header.names_size;
+		entry->name_length = (u16)strlen(packer->files[i].name);
+		header.names_size += entry->name_length + 1ULL;
+	}
+
+	u64 offset = header.names_offset + header.names_size;
+	for (u32 i = 0; i < count; ++i) {
+		file_view view;
+		if (!filesystem_map(packer->files[i].path, &view)) {
+			fprintf(stderr, "Unable to read %s\n", packer->files[i].path);
+			return false;
+		}
+		pack_entry *entry        = &packer->files[i].entry;
+		entry->size              = view.size;
+		entry->uncompressed_size = view.size;
+		entry->compression       = PACK_COMPRESSION_NONE;
+		compress_file(&packer->files[i], &view);
+		filesystem_unmap(&view);
+
+		offset        = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+		entry->offset = offset;
+		offset += entry->size;
+	}
+
+	file_handle handle;
+	if (!filesystem_open(packer->output, FILE_MODE_WRITE, true, &handle)) {
+		fprintf(stderr, "Unable to create %s\n", packer->output);
+		return false;
+	}
+
+	b8 success = write_bytes(&handle, &header, sizeof(header));
+	for (u32 i = 0; i < count && success; ++i) {
+		success = write_bytes(&handle, &packer->files[i].entry, sizeof(pack_entry));
+	}
+	for (u32 i = 0; i < count && success; ++i) {
+		success = write_bytes(&handle, packer->files[i].name, packer->files[i].entry.name_length + 1ULL);
+	}
+
+	offset = header.names_offset + header.names_size;
+	for (u32 i = 0; i < count && success; ++i) {
+		packed_file *file = &packer->files[i];
+		success           = write_padding(&handle, &offset, PACK_ALIGNMENT);
+		if (success && file->compressed) {
+			success = write_bytes(&handle, file->compressed, file->entry.size);
+		} else if (success) {
+			file_view view;
+			success = filesystem_map(file->path, &view) && write_bytes(&handle, view.data, view.size);
+			filesystem_unmap(&view);
+		}
+		offset += file->entry.size;
+	}
+
+	filesystem_close(&handle);
+	if (!success) { fprintf(stderr, "Failed writing %s\n", packer->output); }
+	return success;
+}
+
+int main(int argc, char **argv) {
+	packer packer;
+	szero_memory(&packer, sizeof(packer));
+
+	i32 positional = 0;
+	for (i32 i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-x") == 0 && i + 1 < argc && packer.exclude_count < MAX_EXCLUDES) {
+			packer.excludes[packer.exclude_count++] = argv[++i];
+		} else if (positional == 0) {
+			packer.output = argv[i];
+			positional++;
+		} else if (positional == 1) {
+			packer.root = argv[i];
+			positional++;
+		}
+	}
+	if (!packer.output || !packer.root) {
+		fprintf(stderr, "Usage: asset_packer [-x suffix]... <output.pack> <assets directory>\n");
+		return 1;
+	}
+
+	packer.files = darray_create(packed_file);
+	b8 success   = collect_files(&packer, packer.root, "") && write_pack(&packer);
+	if (success) {
+		u64 compressed = 0;
+		for (u64 i = 0; i < darray_length(packer.files); ++i) { compressed += packer.files[i].compressed != 0; }
+		printf("Packed %llu files into %s, %llu compressed\n", darray_length(packer.files), packer.output, compressed);
+	}
+
+	for (u64 i = 0; i < darray_length(packer.files); ++i) {
+		if (packer.files[i].compressed) {
+			sfree(packer.files[i].compressed, packer.files[i].compressed_capacity, MEMORY_TAG_RESOURCE);
+		}
+		sfree(packer.files[i].name, strlen(packer.files[i].name) + 1, MEMORY_TAG_STRING);
+		sfree(packer.files[i].path, strlen(packer.files[i].path) + 1, MEMORY_TAG_STRING);
+	}
+	darray_destroy(packer.files);
+
+	return success ? 0 : 1;
+}
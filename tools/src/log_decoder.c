@@ -0,0 +1,117 @@
+// Turns a binary log (console.slog) written by log_output_binary back into text.
+// Usage: log_decoder [console.slog]
+
+#include <containers/darray.h>
+#include <core/filesystem.h>
+#include <core/logger.h>
+#include <core/smemory.h>
+#include <defines.h>
+
+#include <stdio.h>
+
+#define MESSAGE_LENGTH 4096
+
+typedef struct format_entry {
+	u64 id;
+	char *text;
+} format_entry;
+
+static const char *level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
+
+// Reads size bytes at *offset, false if the file ends first.
+static b8 read_bytes(const u8 *bytes, u64 bytes_size, u64 *offset, void *out, u64 size) {
+	if (*offset + size > bytes_size) { return false; }
+	scopy_memory(out, bytes + *offset, size);
+	*offset += size;
+	return true;
+}
+
+static const char *find_format(format_entry *formats, u64 id) {
+	// Newest first, a format id is written again if the logger's table filled up.
+	for (u64 i = darray_length(formats); i > 0; --i) {
+		if (formats[i - 1].id == id) { return formats[i - 1].text; }
+	}
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	const char *path = argc > 1 ? argv[1] : "console.slog";
+
+	file_handle handle;
+	if (!filesystem_open(path, FILE_MODE_READ, true, &handle)) {
+		fprintf(stderr, "Unable to open %s\n", path);
+		return 1;
+	}
+
+	u8 *bytes  = 0;
+	u64 size   = 0;
+	b8 success = filesystem_read_all_bytes(&handle, &bytes, &size);
+	filesystem_close(&handle);
+	if (!success) {
+		fprintf(stderr, "Unable to read %s\n", path);
+		return 1;
+	}
+
+	u64 offset = 0;
+	log_binary_header header;
+	if (!read_bytes(bytes, size, &offset, &header, sizeof(header)) || header.magic != LOG_BINARY_MAGIC
+		|| header.version != LOG_BINARY_VERSION) {
+		fprintf(stderr, "%s is not a binary log, or was written by a different version\n", path);
+		return 1;
+	}
+
+	format_entry *formats = darray_create(format_entry);
+	f64 start_time        = -1.0;
+	char message[MESSAGE_LENGTH];
+
+	u8 type;
+	while (read_bytes(bytes, size, &offset, &type, sizeof(type))) {
+		if (type == LOG_BINARY_RECORD_FORMAT) {
+			format_entry entry;
+			u16 length;
+			if (!read_bytes(bytes, size, &offset, &entry.id, sizeof(entry.id))
+				|| !read_bytes(bytes, size, &offset, &length, sizeof(length)) || offset + length > size) {
+				break;
+			}
+			entry.text = sallocate(length + 1ULL, MEMORY_TAG_STRING);
+			read_bytes(bytes, size, &offset, entry.text, length);
+			darray_push(formats, entry);
+		} else if (type == LOG_BINARY_RECORD_MESSAGE) {
+			u8 level;
+			u64 id;
+			f64 timestamp;
+			u16 args_size;
+			if (!read_bytes(bytes, size, &offset, &level, sizeof(level))
+				|| !read_bytes(bytes, size, &offset, &id, sizeof(id))
+				|| !read_bytes(bytes, size, &offset, &timestamp, sizeof(timestamp))
+				|| !read_bytes(bytes, size, &offset, &args_size, sizeof(args_size)) || offset + args_size > size) {
+				break;
+			}
+
+			const char *format = find_format(formats, id);
+			if (start_time < 0.0) { start_time = timestamp; }
+			if (format) {
+				log_format_binary(format, bytes + offset, args_size, message, MESSAGE_LENGTH);
+			} else {
+				snprintf(message, MESSAGE_LENGTH, "<unknown format %llx>", (unsigned long long)id);
+			}
+			printf("[%12.6f] %s%s\n", timestamp - start_time, level_strings[SMIN(level, 5)], message);
+			offset += args_size;
+		} else {
+			fprintf(stderr, "Unknown record type %u at offset %llu\n", type, (unsigned long long)offset - 1);
+			break;
+		}
+	}
+
+	if (offset < size) { fprintf(stderr, "%s ends with a truncated or corrupt record\n", path); }
+
+	for (u64 i = 0; i < darray_length(formats); ++i) {
+		u64 length = 0;
+		while (formats[i].text[length]) { length++; }
+		sfree(formats[i].text, length + 1, MEMORY_TAG_STRING);
+	}
+	darray_destroy(formats);
+	sfree(bytes, size, MEMORY_TAG_STRING);
+
+	return 0;
+}